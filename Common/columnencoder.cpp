@@ -16,7 +16,7 @@
 //
 
 #include "columnencoder.h"
-#include <regex>
+#include <algorithm>
 #ifdef BUILDING_JASP
 #include "log.h"
 #define LOGGER Log::log()
@@ -33,6 +33,8 @@ bool							ColumnEncoder::_encodingMapInvalidated		= true;
 bool							ColumnEncoder::_decodingMapInvalidated		= true;
 bool							ColumnEncoder::_originalNamesInvalidated	= true;
 bool							ColumnEncoder::_encodedNamesInvalidated		= true;
+bool							ColumnEncoder::_originalMatcherInvalidated	= true;
+bool							ColumnEncoder::_encodedMatcherInvalidated	= true;
 
 
 ColumnEncoder * ColumnEncoder::columnEncoder()
@@ -49,6 +51,8 @@ void ColumnEncoder::invalidateAll()
 	_decodingMapInvalidated		= true;
 	_originalNamesInvalidated	= true;
 	_encodedNamesInvalidated	= true;
+	_originalMatcherInvalidated	= true;
+	_encodedMatcherInvalidated	= true;
 }
 
 ColumnEncoder::ColumnEncoder(std::string prefix, std::string postfix)
@@ -206,11 +210,11 @@ const ColumnEncoder::colVec	&	ColumnEncoder::originalNames()
 				for(const std::string & name : other->_originalNames)
 					vec.push_back(name);
 
+		sortVectorBigToSmall(vec);
+
 		_originalNamesInvalidated = false;
 	}
 
-	sortVectorBigToSmall(vec);
-
 	return vec;
 }
 
@@ -227,14 +231,40 @@ const ColumnEncoder::colVec	&	ColumnEncoder::encodedNames()
 				for(const std::string & name : other->_encodedNames)
 					vec.push_back(name);
 
+		sortVectorBigToSmall(vec);
+
 		_encodedNamesInvalidated = false;
 	}
 
-	sortVectorBigToSmall(vec);
-
 	return vec;
 }
 
+const ColumnEncoder::NameMatcher & ColumnEncoder::originalNamesMatcher()
+{
+	static ColumnEncoder::NameMatcher matcher;
+
+	if(_originalMatcherInvalidated)
+	{
+		matcher = NameMatcher(originalNames());
+		_originalMatcherInvalidated = false;
+	}
+
+	return matcher;
+}
+
+const ColumnEncoder::NameMatcher & ColumnEncoder::encodedNamesMatcher()
+{
+	static ColumnEncoder::NameMatcher matcher;
+
+	if(_encodedMatcherInvalidated)
+	{
+		matcher = NameMatcher(encodedNames());
+		_encodedMatcherInvalidated = false;
+	}
+
+	return matcher;
+}
+
 bool ColumnEncoder::shouldEncode(const std::string & in)
 {
 	return _encodingMap.count(in) > 0;
@@ -253,139 +283,307 @@ std::string	ColumnEncoder::replaceAllStrict(const std::string & text, const std:
 		return text;
 }
 
-std::string	ColumnEncoder::replaceAll(std::string text, const std::map<std::string, std::string> & map, const std::vector<std::string> & names)
+std::string	ColumnEncoder::replaceAll(const std::string & text, const std::map<std::string, std::string> & map, const NameMatcher & matcher)
 {
-	size_t foundPos = 0;
+	NameMatcher::Match	match;
+	size_t				copiedUntil = 0;
+	std::string			replaced;
 
-	while(foundPos < std::string::npos)
+	//Each time we replace the first occurence of anything replaceable, the longest if several start there, and continue from after it
+	while(matcher.findFirst(text, copiedUntil, match))
 	{
-		size_t firstFoundPos	= std::string::npos;
-
-		std::string replaceThis;
+		replaced.append(text, copiedUntil, match.start - copiedUntil);
+		replaced.append(map.at(matcher.name(match.name)));
+		copiedUntil = match.start + match.length;
+	}
 
-		//First we find the first occurence of a replaceable text.
-		for(const std::string & replaceMe : names) //We follow names instead of keyvals from map because they ought to be sorted from largest to smallest string (_originalNames) to not make sub-replacements
-		{
-			size_t pos = text.find(replaceMe, foundPos);
-			if(pos < firstFoundPos)
-			{
-				firstFoundPos = pos;
-				replaceThis = replaceMe;
-			}
-		}
+	if(copiedUntil == 0)
+		return text;
 
-		//We found something to replace and this will be the first occurence of anything like that. Replace it!
-		if(firstFoundPos != std::string::npos)
-		{
-			foundPos = firstFoundPos;
-			const std::string & replacement = map.at(replaceThis);
-			text.replace(foundPos, replaceThis.length(), replacement);
-			foundPos += replacement.length(); //Let's make sure we start replacing from after where we just replaced
-		}
-		else
-			foundPos = std::string::npos;
-	}
+	replaced.append(text, copiedUntil, std::string::npos);
 
-	return text;
+	return replaced;
 }
 
 std::string ColumnEncoder::encodeRScript(std::string text, std::set<std::string> * columnNamesFound)
 {
-	return encodeRScript(text, encodingMap(), originalNames(), columnNamesFound);
+	return encodeRScript(text, encodingMap(), originalNamesMatcher(), columnNamesFound);
 }
 
-std::string ColumnEncoder::encodeRScript(std::string text, const std::map<std::string, std::string> & map, const std::vector<std::string> & names, std::set<std::string> * columnNamesFound)
+std::string ColumnEncoder::encodeRScript(const std::string & text, const std::map<std::string, std::string> & map, const NameMatcher & matcher, std::set<std::string> * columnNamesFound)
 {
 	if(columnNamesFound)
 		columnNamesFound->clear();
 
-	static std::regex nonNameChar("[^\\.A-Za-z0-9_]");
+	auto isNameChar = [](char c) { return c == '.' || c == '_' || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'); };
 
-	//for now we simply replace any found columnname by its Base64 variant if found
-	for(const std::string & oldCol : names)
+	const std::vector<NameMatcher::Match> matches = matcher.findAll(text);
+
+	if(matches.empty())
+		return text;
+
+	//Whether a position is inside a string literal is decided from left to right, as R would read it.
+	std::vector<bool>	inString(text.size(), false);
+	bool				inside	= false;
+	char				delim	= '?';
+
+	for (size_t pos = 0; pos < text.size(); ++pos)
+	{
+		inString[pos] = inside;
+
+		if (text[pos] == '"' || text[pos] == '\'') //string starts or ends. This does not take into account escape characters though...
+		{
+			if (!inside)
+			{
+				delim	= text[pos];
+				inside	= true;
+			}
+			else if(text[pos] == delim)
+				inside = false;
+		}
+	}
+
+	//The columnnames to replace are chosen from right to left, so that whether the end of one is free is judged on what follows it after encoding.
+	//Where several start at the same position they are tried from long to short and the first one that is free is used.
+	std::vector<const NameMatcher::Match *>	chosen;
+	size_t									nextChosen	= text.size(); //Start of the closest chosen columnname to the right
+
+	for(size_t groupEnd = matches.size(), groupBegin; groupEnd > 0; groupEnd = groupBegin)
 	{
-		std::string	newCol	= map.at(oldCol);
+		const size_t foundPos = matches[groupEnd - 1].start;
 
-		std::vector<size_t> foundColPositions = getPositionsColumnNameMatches(text, oldCol);
-		std::reverse(foundColPositions.begin(), foundColPositions.end());
+		for(groupBegin = groupEnd - 1; groupBegin > 0 && matches[groupBegin - 1].start == foundPos; groupBegin--);
 
-		for (size_t foundPos : foundColPositions)
+		if(inString[foundPos])
+			continue;
+
+		for(size_t m = groupBegin; m < groupEnd; m++)
 		{
-			size_t foundPosEnd = foundPos + oldCol.length();
+			const size_t foundPosEnd = foundPos + matches[m].length;
+
+			if(foundPosEnd > nextChosen)
+				continue;
+
+			auto charAt = [&](size_t pos) { return pos < nextChosen ? text[pos] : map.at(matcher.name(chosen.back()->name))[0]; };
 
 			//First check if it is a "free columnname" aka is there some space or a kind in front of it. We would not want to replace a part of another term (Imagine what happens when you use a columname such as "E" and a filter that includes the term TRUE, it does not end well..)
-			bool startIsFree	= foundPos == 0					|| std::regex_match(text.substr(foundPos - 1, 1),	nonNameChar);
-			bool endIsFree		= foundPosEnd == text.length()	|| std::regex_match(text.substr(foundPosEnd, 1),	nonNameChar);
+			bool startIsFree	= foundPos == 0					|| !isNameChar(text[foundPos - 1]);
+			bool endIsFree		= foundPosEnd == text.length()	|| !isNameChar(charAt(foundPosEnd));
 
 			//Check for "(" as well because maybe someone has a columnname such as rep or if or something weird like that. This might however have some whitespace in between...
 			bool keepGoing = true;
 
 			for(size_t bracePos = foundPosEnd; bracePos < text.size() && endIsFree && keepGoing; bracePos++)
-				if(text[bracePos] == '(')
+				if(charAt(bracePos) == '(')
 					endIsFree = false;
-				else if(text[bracePos] != '\t' && text[bracePos] != ' ')
+				else if(charAt(bracePos) != '\t' && charAt(bracePos) != ' ')
 					keepGoing = false; //Aka something else than whitespace or a brace and that means that we can replace it!
 
 			if(startIsFree && endIsFree)
 			{
-				text.replace(foundPos, oldCol.length(), newCol);
+				chosen.push_back(&matches[m]);
+				nextChosen = foundPos;
+				break;
+			}
+		}
+	}
+
+	std::string	encoded;
+	size_t		copiedUntil = 0;
+
+	encoded.reserve(text.size());
+
+	for(auto match = chosen.rbegin(); match != chosen.rend(); match++)
+	{
+		const std::string & oldCol = matcher.name((*match)->name);
+
+		encoded.append(text, copiedUntil, (*match)->start - copiedUntil);
+		encoded.append(map.at(oldCol));
+		copiedUntil = (*match)->start + (*match)->length;
+
+		if(columnNamesFound)
+			columnNamesFound->insert(oldCol);
+	}
+
+	encoded.append(text, copiedUntil, std::string::npos);
 
-				if(columnNamesFound)
-					columnNamesFound->insert(oldCol);
+	return encoded;
+}
+
+ColumnEncoder::NameMatcher::NameMatcher(const colVec & names)
+	: _names(names)
+{
+	//First a plain trie of all names, with the children of each node in a map so they come out sorted
+	std::vector<std::map<unsigned char, int>> children(1);
+	_nodes.resize(1);
+
+	for(size_t n = 0; n < _names.size(); n++)
+	{
+		int node = 0;
+
+		for(unsigned char c : _names[n])
+		{
+			auto child = children[node].find(c);
+
+			if(child == children[node].end())
+			{
+				children[node][c] = _nodes.size();
+				children.emplace_back();
+				_nodes.emplace_back();
+				_nodes.back().depth = _nodes[node].depth + 1;
+				node = _nodes.size() - 1;
 			}
+			else
+				node = child->second;
 		}
+
+		if(node != 0 && _nodes[node].name == -1) //Empty names would match everywhere and a name might be given twice, the first one wins
+			_nodes[node].name = n;
 	}
 
-	return text;
+	_edgesBegin.reserve(_nodes.size() + 1);
+
+	for(const auto & nodeChildren : children)
+	{
+		_edgesBegin.push_back(_edgeChars.size());
+
+		for(const auto & charNode : nodeChildren)
+		{
+			_edgeChars	.push_back(charNode.first);
+			_edgeTargets.push_back(charNode.second);
+		}
+	}
+
+	_edgesBegin.push_back(_edgeChars.size());
+
+	//Then the fail and dictionary links, breadth first because they always point to a shallower node
+	std::vector<int> queue;
+	queue.reserve(_nodes.size());
+
+	for(int edge = _edgesBegin[0]; edge < _edgesBegin[1]; edge++)
+		queue.push_back(_edgeTargets[edge]);
+
+	for(size_t q = 0; q < queue.size(); q++)
+	{
+		const int	node	= queue[q];
+		Node	&	cur		= _nodes[node];
+
+		const Node & fail	= _nodes[cur.fail];
+		cur.dictionary		= fail.name != -1 ? cur.fail : fail.dictionary;
+		cur.longest			= cur.name != -1  ? cur.name : fail.longest;
+
+		for(int edge = _edgesBegin[node]; edge < _edgesBegin[node + 1]; edge++)
+		{
+			const int	child		= _edgeTargets[edge];
+			int			fallback	= cur.fail;
+
+			while(fallback != 0 && _child(fallback, _edgeChars[edge]) == -1)
+				fallback = _nodes[fallback].fail;
+
+			const int failTo		= _child(fallback, _edgeChars[edge]);
+			_nodes[child].fail		= failTo != -1 && failTo != child ? failTo : 0;
+
+			queue.push_back(child);
+		}
+	}
 }
 
-std::vector<size_t> ColumnEncoder::getPositionsColumnNameMatches(const std::string & text, const std::string & columnName)
+int ColumnEncoder::NameMatcher::_child(int node, unsigned char c) const
 {
-	std::vector<size_t> positions;
+	const auto	begin	= _edgeChars.begin() + _edgesBegin[node],
+				end		= _edgeChars.begin() + _edgesBegin[node + 1],
+				found	= std::lower_bound(begin, end, c);
 
-	bool inString	= false;
-	char delim		= '?';
+	return found != end && *found == c ? _edgeTargets[found - _edgeChars.begin()] : -1;
+}
+
+int ColumnEncoder::NameMatcher::_next(int node, unsigned char c) const
+{
+	for(;; node = _nodes[node].fail)
+	{
+		const int child = _child(node, c);
+
+		if(child != -1)	return child;
+		if(node == 0)	return 0;
+	}
+}
 
-	for (std::string::size_type pos = 0; pos < text.length(); ++pos)
-		if (!inString && text.substr(pos, columnName.length()) == columnName)
-			positions.push_back(int(pos));
-		else if (text[pos] == '"' || text[pos] == '\'') //string starts or ends. This does not take into account escape characters though...
+bool ColumnEncoder::NameMatcher::findFirst(const std::string & text, size_t from, Match & match) const
+{
+	bool	found	= false;
+	int		node	= 0;
+
+	for(size_t pos = from; pos < text.size(); pos++)
+	{
+		node = _next(node, text[pos]);
+
+		const Node & cur = _nodes[node];
+
+		if(cur.longest != -1)
 		{
-			if (!inString)
+			const size_t length = _names[cur.longest].size(),
+						 start	= pos + 1 - length;
+
+			if(!found || start <= match.start) //Same start as before means it ends later and is thus longer
 			{
-				delim		= text[pos];
-				inString	= true;
+				match = { start, length, size_t(cur.longest) };
+				found = true;
 			}
-			else if(text[pos] == delim)
-				inString = false;
 		}
 
-	return positions;
+		//Anything still to be found starts after pos + 1 - depth, once that is past our match nothing can start earlier anymore
+		if(found && pos + 1 - cur.depth > match.start)
+			return true;
+	}
+
+	return found;
+}
+
+std::vector<ColumnEncoder::NameMatcher::Match> ColumnEncoder::NameMatcher::findAll(const std::string & text) const
+{
+	std::vector<Match> matches;
+
+	int node = 0;
+
+	for(size_t pos = 0; pos < text.size(); pos++)
+	{
+		node = _next(node, text[pos]);
+
+		for(int out = _nodes[node].name != -1 ? node : _nodes[node].dictionary; out != -1; out = _nodes[out].dictionary)
+		{
+			const size_t length = _names[_nodes[out].name].size();
+			matches.push_back({ pos + 1 - length, length, size_t(_nodes[out].name) });
+		}
+	}
+
+	std::sort(matches.begin(), matches.end(), [](const Match & a, const Match & b) { return a.start != b.start ? a.start < b.start : a.length > b.length; });
+
+	return matches;
 }
 
 
 void ColumnEncoder::encodeJson(Json::Value & json, bool replaceNames, bool replaceStrict)
 {
 	//std::cout << "Json before encoding:\n" << json.toStyledString();
-	replaceAll(json, encodingMap(), originalNames(), replaceNames, replaceStrict);
+	replaceAll(json, encodingMap(), originalNamesMatcher(), replaceNames, replaceStrict);
 	//std::cout << "Json after encoding:\n" << json.toStyledString() << std::endl;
 }
 
 void ColumnEncoder::decodeJson(Json::Value & json, bool replaceNames)
 {
 	//std::cout << "Json before encoding:\n" << json.toStyledString();
-	replaceAll(json, decodingMap(), encodedNames(), replaceNames, false);
+	replaceAll(json, decodingMap(), encodedNamesMatcher(), replaceNames, false);
 	//std::cout << "Json after encoding:\n" << json.toStyledString() << std::endl;
 }
 
 
-void ColumnEncoder::replaceAll(Json::Value & json, const std::map<std::string, std::string> & map, const std::vector<std::string> & names, bool replaceNames, bool replaceStrict)
+void ColumnEncoder::replaceAll(Json::Value & json, const std::map<std::string, std::string> & map, const NameMatcher & matcher, bool replaceNames, bool replaceStrict)
 {
 	switch(json.type())
 	{
 	case Json::arrayValue:
 		for(Json::Value & option : json)
-			replaceAll(option, map, names, replaceNames, replaceStrict);
+			replaceAll(option, map, matcher, replaceNames, replaceStrict);
 		return;
 
 	case Json::objectValue:
@@ -394,11 +592,11 @@ void ColumnEncoder::replaceAll(Json::Value & json, const std::map<std::string, s
 
 		for(const std::string & optionName : json.getMemberNames())
 		{
-			replaceAll(json[optionName], map, names, replaceNames, replaceStrict);
+			replaceAll(json[optionName], map, matcher, replaceNames, replaceStrict);
 
 			if(replaceNames)
 			{
-				std::string replacedName = replaceStrict ? replaceAllStrict(optionName, map) : replaceAll(optionName, map, names);
+				std::string replacedName = replaceStrict ? replaceAllStrict(optionName, map) : replaceAll(optionName, map, matcher);
 
 				if(replacedName != optionName)
 					changedMembers[optionName] = replacedName;
@@ -415,7 +613,7 @@ void ColumnEncoder::replaceAll(Json::Value & json, const std::map<std::string, s
 	}
 
 	case Json::stringValue:
-		json = replaceStrict ? replaceAllStrict(json.asString(), map) : replaceAll(json.asString(), map, names);
+		json = replaceStrict ? replaceAllStrict(json.asString(), map) : replaceAll(json.asString(), map, matcher);
 		return;
 
 	default:
@@ -477,14 +675,14 @@ std::string ColumnEncoder::replaceColumnNamesInRScript(const std::string & rCode
 	ColumnEncoder tempEncoder(changedNames);
 
 	return
-		tempEncoder.replaceAll(
-			tempEncoder.encodeRScript(
+		replaceAll(
+			encodeRScript(
 				rCode,
 				tempEncoder._encodingMap,
-				tempEncoder._originalNames
+				NameMatcher(tempEncoder._originalNames)
 			),
 			tempEncoder._decodingMap,
-			tempEncoder._encodedNames
+			NameMatcher(tempEncoder._encodedNames)
 		);
 }
 
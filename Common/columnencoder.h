@@ -67,13 +67,12 @@ public:
 
 			///Replace all occurences of columnNames in a string by their encoded versions, taking into account the presence of word boundaries and parentheses.
 			std::string			encodeRScript(std::string text, std::set<std::string> * columnNamesFound = nullptr);
-			std::string			encodeRScript(std::string text, const std::map<std::string, std::string> & map, const std::vector<std::string> & names, std::set<std::string> * columnNamesFound = nullptr);
 
 			///Replace all occurences of columnNames in a string by their encoded versions, regardless of word boundaries or parentheses.
-	static	std::string			encodeAll(const std::string & text) { return replaceAll(text, encodingMap(), originalNames()); }
+	static	std::string			encodeAll(const std::string & text) { return replaceAll(text, encodingMap(), originalNamesMatcher()); }
 
 			///Replace all occurences of encoded columnNames in a string by their decoded versions, regardless of word boundaries or parentheses.
-	static	std::string			decodeAll(const std::string & text) { return replaceAll(text, decodingMap(), encodedNames());  }
+	static	std::string			decodeAll(const std::string & text) { return replaceAll(text, decodingMap(), encodedNamesMatcher());  }
 
 			///Replace all occurences of columnNames in a string by their encoded versions in all json-names and string-values, regardless of word boundaries or parentheses.
 	static	void				encodeJson(Json::Value & json, bool replaceNames = false, bool replaceStrict = false);
@@ -87,23 +86,69 @@ private:
 	static	void 				_encodeColumnNamesinOptions(Json::Value & options, Json::Value & meta);
 
 private:
-	static	std::string			replaceAll(std::string text, const std::map<std::string, std::string> & map, const std::vector<std::string> & names);
+	/// Aho-Corasick automaton over a set of names, so that all of them can be found in a single pass over a text instead of searching the text once per name.
+	/// It is built once per set of names, names are referred to by their index in the vector it was built from. Empty names are never matched.
+	class NameMatcher
+	{
+	public:
+		struct Match
+		{
+			size_t	start	= 0,
+					length	= 0,
+					name	= 0;
+		};
+
+									NameMatcher(const colVec & names = colVec());
+
+		const std::string		&	name(size_t index) const { return _names[index]; }
+
+		///Leftmost occurence of any name at or after from, the longest name if several start there. That is the order replaceAll always replaced them in.
+		bool						findFirst(const std::string & text, size_t from, Match & match) const;
+
+		///All occurences of all names, also the overlapping ones, sorted by start and from long to short.
+		std::vector<Match>			findAll(const std::string & text) const;
+
+	private:
+		struct Node
+		{
+			int						fail		= 0,	///< Node of the longest proper suffix that is also in the trie
+									depth		= 0,
+									name		= -1,	///< Name ending exactly here
+									dictionary	= -1,	///< Closest node along the fail links that has a name
+									longest		= -1;	///< Longest name ending here, either its own or that of dictionary
+		};
+
+		int							_child(int node, unsigned char c)	const;
+		int							_next(int node, unsigned char c)	const;
+
+		colVec						_names;
+		std::vector<Node>			_nodes;
+		std::vector<int>			_edgesBegin,	///< Edges of node n are _edgesBegin[n] until _edgesBegin[n+1], sorted on their character
+									_edgeTargets;
+		std::vector<unsigned char>	_edgeChars;
+	};
+
+	static	std::string			replaceAll(const std::string & text, const std::map<std::string, std::string> & map, const NameMatcher & matcher);
 	static  std::string			replaceAllStrict(const std::string & text, const std::map<std::string, std::string> & map);
+	static	std::string			encodeRScript(const std::string & text, const std::map<std::string, std::string> & map, const NameMatcher & matcher, std::set<std::string> * columnNamesFound = nullptr);
 
-	static	void				replaceAll(Json::Value & json, const std::map<std::string, std::string> & map, const std::vector<std::string> & names, bool replaceNames, bool replaceStrict);
-	static	std::vector<size_t>	getPositionsColumnNameMatches(const std::string & text, const std::string & columnName);
+	static	void				replaceAll(Json::Value & json, const std::map<std::string, std::string> & map, const NameMatcher & matcher, bool replaceNames, bool replaceStrict);
 			void				collectExtraEncodingsFromMetaJson(const Json::Value & in, std::vector<std::string> & namesCollected) const;
 	static	void				sortVectorBigToSmall(std::vector<std::string> & vec);
 	static	const colMap	&	encodingMap();
 	static	const colMap	&	decodingMap();
 	static	const colVec	&	originalNames();
 	static	const colVec	&	encodedNames();
+	static	const NameMatcher &	originalNamesMatcher();
+	static	const NameMatcher &	encodedNamesMatcher();
 	static	void				invalidateAll();
 
 	static	bool				_encodingMapInvalidated,
 								_decodingMapInvalidated,
 								_originalNamesInvalidated,
-								_encodedNamesInvalidated;
+								_encodedNamesInvalidated,
+								_originalMatcherInvalidated,
+								_encodedMatcherInvalidated;
 
 	static ColumnEncoder	*	_columnEncoder;
 	static ColumnEncoders	*	_otherEncoders;
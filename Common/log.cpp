@@ -102,6 +102,9 @@ void Log::redirectStdOut()
 		//_currentFile = freopen(_logFilePath.c_str(), "a", stdout);
 		//if(!_currentFile)
 
+		if(_logFile.is_open()) //For instance when an engine forked from the zygote switches to its own logfile
+			_logFile.close();
+
 		_logFile.open(_logFilePath.c_str(), std::ios_base::app | std::ios_base::out);
 
 		if(_logFile.fail())
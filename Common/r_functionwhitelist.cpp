@@ -1,5 +1,9 @@
 #include "r_functionwhitelist.h"
-#include "stringutils.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <cstdint>
+#include <cctype>
 
 	//The following functions (and keywords that can be followed by a '(') will be allowed in user-entered R-code, such as filters or computed columns. This is for security because otherwise JASP-files could become a vector of attack and that doesn't refer to an R-datatype.
 const std::set<std::string> R_FunctionWhiteList::functionWhiteList {
@@ -272,78 +276,310 @@ std::string R_FunctionWhiteList::returnOrderedWhiteList()
 	return out.str();
 }
 
-const std::string	R_FunctionWhiteList::functionStartDelimit("(?:[;\\s\\(\"\\[\\+\\-\\=\\*\\%\\/\\{\\|&!]|^)"); //These should be all possible non-funtion-name-characters that could be right in front of any function-name in R.
-const std::string	R_FunctionWhiteList::functionNameStart("(?:\\.?[[:alpha:]])");
-const std::string	R_FunctionWhiteList::functionNameBody("(?:\\w|\\.|::)+");
-const std::regex	R_FunctionWhiteList::functionNameMatcher(functionStartDelimit + "(" + functionNameStart + functionNameBody + ")(?=[\\t \\r]*\\()");
-
-std::set<std::string> R_FunctionWhiteList::findIllegalFunctions(std::string const & script)
+///A perfect hash (hash and displace) of a fixed set of names, so a lookup costs two hashes and at most one comparison.
+///Names are first spread over buckets, then each bucket gets the displacement that puts all of its names in free slots.
+class NamePerfectHash
 {
-	std::set<std::string> blackListedFunctionsFound;
+public:
+	NamePerfectHash(const std::set<std::string> & names) : _names(names.begin(), names.end())
+	{
+		_bucketCount = std::max(size_t(1), _names.size() / 2);
+
+		size_t slotCount = 1;
+		while(slotCount < 2 * _names.size())
+			slotCount <<= 1;
+
+		_slotMask = slotCount - 1;
+		_slots.assign(slotCount, -1);
+		_displacements.assign(_bucketCount, 0);
+
+		std::vector<std::vector<int>> buckets(_bucketCount);
+		for(size_t name=0; name<_names.size(); name++)
+			buckets[hash(_names[name], 0) % _bucketCount].push_back(name);
+
+		//The fullest buckets are the hardest to place so they go first
+		std::vector<size_t> order(_bucketCount);
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&buckets](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+		std::vector<size_t> slots;
+
+		for(size_t bucket : order)
+			for(uint32_t displacement = 1; !buckets[bucket].empty(); displacement++)
+			{
+				slots.clear();
+
+				for(int name : buckets[bucket])
+				{
+					size_t slot = hash(_names[name], displacement) & _slotMask;
 
-	auto foundFunctionsBegin	= std::sregex_iterator(script.begin(), script.end(), functionNameMatcher);
-	auto foundFunctionsEnd		= std::sregex_iterator();
+					if(_slots[slot] != -1 || std::find(slots.begin(), slots.end(), slot) != slots.end())
+						break;
 
-	for(auto foundFunctionIter = foundFunctionsBegin; foundFunctionIter != foundFunctionsEnd; foundFunctionIter++ )
+					slots.push_back(slot);
+				}
+
+				if(slots.size() == buckets[bucket].size())
+				{
+					for(size_t i=0; i<slots.size(); i++)
+						_slots[slots[i]] = buckets[bucket][i];
+
+					_displacements[bucket] = displacement;
+					break;
+				}
+			}
+	}
+
+	bool contains(std::string_view name) const
 	{
-		std::string foundFunction((*foundFunctionIter)[1].str());
-		bool whiteListed = functionWhiteList.count(foundFunction) > 0;
+		int slot = _slots[hash(name, _displacements[hash(name, 0) % _bucketCount]) & _slotMask];
 
-		if(!whiteListed && blackListedFunctionsFound.count(foundFunction) == 0)
-			blackListedFunctionsFound.insert(foundFunction);
+		return slot != -1 && _names[slot] == name;
 	}
 
+private:
+	///FNV-1a seeded with the displacement, followed by the finalizer of murmurhash3 because the table only looks at the lowest bits
+	static uint64_t hash(std::string_view name, uint32_t seed)
+	{
+		uint64_t h = 14695981039346656037ull ^ (uint64_t(seed) * 0x9E3779B97F4A7C15ull);
+
+		for(unsigned char c : name)
+		{
+			h ^= c;
+			h *= 1099511628211ull;
+		}
 
-	return blackListedFunctionsFound;
+		h ^= h >> 33;	h *= 0xff51afd7ed558ccdull;
+		h ^= h >> 33;	h *= 0xc4ceb9fe1a85ec53ull;
+		h ^= h >> 33;
+
+		return h;
+	}
+
+	std::vector<std::string>	_names;
+	std::vector<int>			_slots;				///< Index in _names or -1
+	std::vector<uint32_t>		_displacements;		///< Per bucket
+	size_t						_bucketCount	= 1,
+								_slotMask		= 0;
+};
+
+bool R_FunctionWhiteList::isWhiteListed(std::string_view name)
+{
+	static const NamePerfectHash whiteList(functionWhiteList);
+
+	return whiteList.contains(name);
 }
 
-const std::string	R_FunctionWhiteList::operatorsR("`(?:\\+|-|\\*|/|%(?:/|\\*|in)?%|\\^|<=?|>=?|==?|!=?|<?<-|->>?|\\|\\|?|&&?|:|\\$)`");
+static bool isDigitR(		char c)	{ return c >= '0' && c <= '9'; }
+static bool isNameStartR(	char c)	{ return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '.' || c == '_' || static_cast<unsigned char>(c) >= 0x80; } //Anything non-ascii might be a letter in the locale of R
+static bool isNameCharR(	char c)	{ return isNameStartR(c) || isDigitR(c); }
 
-const std::regex	R_FunctionWhiteList::assignmentWhiteListedRightMatcher(	"(" +				functionNameStart + functionNameBody +	")\\s*(?:<?<-|=)");
-const std::regex	R_FunctionWhiteList::assignmentWhiteListedLeftMatcher(	"(?:->>?)\\s*(" +	functionNameStart + functionNameBody +	")");
-const std::regex	R_FunctionWhiteList::assignmentOperatorRightMatcher(	"(" +				operatorsR +							")\\s*(?:<?<-|=)");
-const std::regex	R_FunctionWhiteList::assignmentOperatorLeftMatcher(		"(?:->>?)\\s*(" +	operatorsR +							")");
+///Whether a name between backticks is one of the operators or syntax of R, those may be called like `+`(1, 2) but never assigned to
+static bool isOperatorR(std::string_view name)
+{
+	static const std::set<std::string_view> operators = { "+", "-", "*", "/", "^", "<", "<=", ">", ">=", "==", "!=", "!", "&", "&&", "|", "||", "|>", ":", "::", ":::", "$", "@", "~", "?", "=", "<-", "<<-", "->", "->>", "(", "[", "[[", "{" };
 
-std::set<std::string> R_FunctionWhiteList::findIllegalFunctionsAliases(std::string const & script)
+	return operators.count(name) || (name.size() >= 2 && name.front() == '%' && name.back() == '%');
+}
+
+std::set<std::string> R_FunctionWhiteList::findIllegalFunctions(std::string const & script)
 {
-	//Log::log() << "findIllegalFunctionsAliases with " << script << std::endl;
+	std::set<std::string> blackListedFunctionsFound;
+	scanScript(script, &blackListedFunctionsFound, nullptr);
 
+	return blackListedFunctionsFound;
+}
+
+std::set<std::string> R_FunctionWhiteList::findIllegalFunctionsAliases(std::string const & script)
+{
 	std::set<std::string> illegalAliasesFound;
+	scanScript(script, nullptr, &illegalAliasesFound);
 
-	auto aliasSearcher = [&illegalAliasesFound, &script](std::regex aliasAssignmentMatcher, bool (*lambdaMatchChecker)(std::string) )
+	return illegalAliasesFound;
+}
+
+void R_FunctionWhiteList::scanScript(std::string const & script, std::set<std::string> * illegalFunctions, std::set<std::string> * illegalAliases)
+{
+	//A "name" is anything R can call or assign to: a symbol, a `quoted symbol` or a "string"
+	enum class token { none, name, closer, other };
+
+	const char			*	code			= script.data();
+	const size_t			length			= script.size();
+	std::vector<char>		brackets;							//'a' for the arguments of a call or index, 'g' for grouping parentheses and '{' for braces
+	token					previous		= token::none;
+	std::string_view		previousName;
+	bool					previousIsOp	= false,
+							assignsRight	= false;			//The previous token was -> or ->>
+
+	auto at = [&](size_t pos) { return pos < length ? code[pos] : '\0'; };
+
+	auto assignedTo = [&](std::string_view name, bool isOperator)
+	{
+		if(!illegalAliases)				return;
+		if(isOperator)					illegalAliases->insert("`" + std::string(name) + "`"); //operators are never allowed
+		else if(isWhiteListed(name))	illegalAliases->insert(std::string(name)); //only allowed when the token being assigned to is not in whitelist
+	};
+
+	auto nameFound = [&](std::string_view name, bool isOperator)
+	{
+		if(assignsRight)
+			assignedTo(name, isOperator);
+
+		assignsRight	= false;
+		previous		= token::name;
+		previousName	= name;
+		previousIsOp	= isOperator;
+	};
+
+	auto otherFound = [&](token kind, size_t tokenLength)
 	{
-		auto foundAliasesBegin	= std::sregex_iterator(script.begin(), script.end(), aliasAssignmentMatcher);
-		auto foundAliasesEnd	= std::sregex_iterator();
+		assignsRight	= false;
+		previous		= kind;
+		return tokenLength;
+	};
+
+	auto leftAssignment = [&](size_t tokenLength)
+	{
+		if(previous == token::name)
+			assignedTo(previousName, previousIsOp);
+
+		return otherFound(token::other, tokenLength);
+	};
 
-		for(auto foundAliasesIter = foundAliasesBegin; foundAliasesIter != foundAliasesEnd; foundAliasesIter++ )
+	for(size_t i=0; i<length;)
+	{
+		const char c = code[i];
+
+		if(c == '\n')
+		{
+			//Outside of parentheses and brackets a newline ends the expression, so a name at the end of a line isn't called by a "(" on the next
+			if(brackets.empty() || brackets.back() == '{')
+				previous = token::none;
+			i++;
+		}
+		else if(std::isspace(static_cast<unsigned char>(c)))
+			i++;
+		else if(c == '#')
+		{
+			while(i < length && code[i] != '\n')
+				i++;
+		}
+		else if(c == '"' || c == '\'' || c == '`')
 		{
-			std::string foundAlias((*foundAliasesIter)[1].str());
-			bool allowed = (*lambdaMatchChecker)(foundAlias);
+			const size_t start = ++i;
 
-			//Log::log() << "I found alias assignment: " << foundAlias << " which is " << (allowed ? "allowed" : "not allowed") << ".." << std::endl;
+			while(i < length && code[i] != c)
+				i += code[i] == '\\' ? 2 : 1;
 
-			if(!allowed)
-				illegalAliasesFound.insert(foundAlias);
+			i = std::min(i, length);
+			nameFound(std::string_view(code + start, i - start), c == '`' && isOperatorR(std::string_view(code + start, i - start)));
+			i++;
 		}
-	};
+		else if(isNameStartR(c) && !(c == '.' && isDigitR(at(i + 1))))
+		{
+			const size_t start = i;
+
+			for(;;)
+			{
+				while(i < length && isNameCharR(code[i]))
+					i++;
+
+				//Namespaced names such as stats::sd are checked as a whole
+				size_t colons = 0;
+				while(colons < 3 && at(i + colons) == ':')
+					colons++;
+
+				if(colons < 2 || !isNameStartR(at(i + colons)))
+					break;
+
+				i += colons;
+			}
+
+			std::string_view	name(code + start, i - start);
+			const char			quote	= at(i);
+			size_t				dashes	= 0;
+
+			while(at(i + 1 + dashes) == '-')
+				dashes++;
+
+			const char			open	= at(i + 1 + dashes),
+								close	= open == '(' ? ')' : open == '[' ? ']' : '}';
+
+			//A raw string like r"(...)" or R'---[...]---'
+			if((name == "r" || name == "R") && (quote == '"' || quote == '\'') && (open == '(' || open == '[' || open == '{'))
+			{
+				const std::string	ending		= close + std::string(dashes, '-') + quote;
+				const size_t		contents	= i + 2 + dashes,
+									end			= std::min(script.find(ending, contents), length);
+
+				nameFound(std::string_view(code + contents, end - contents), false);
+				i = std::min(end + ending.size(), length);
+			}
+			else
+				nameFound(name, false);
+		}
+		else if(isDigitR(c) || c == '.')
+		{
+			while(i < length && isNameCharR(code[i]))
+				i++;
 
-	aliasSearcher(assignmentOperatorLeftMatcher,		[](std::string alias) { return false; }); //operators are never allowed
-	aliasSearcher(assignmentOperatorRightMatcher,		[](std::string alias) { return false; });
-	aliasSearcher(assignmentWhiteListedLeftMatcher,		[](std::string alias) { return functionWhiteList.count(alias) == 0; }); //only allowed when the token being assigned to is not in whitelist
-	aliasSearcher(assignmentWhiteListedRightMatcher,	[](std::string alias) { return functionWhiteList.count(alias) == 0; });
+			otherFound(token::other, 0);
+		}
+		else if(c == '(')
+		{
+			if(previous == token::name && !previousIsOp && illegalFunctions && !isWhiteListed(previousName))
+				illegalFunctions->insert(std::string(previousName));
 
-	//Log::log() << std::flush;
+			//Only the arguments of a named function are sure not to be an expression, anything else is checked for assignments with "="
+			brackets.push_back(previous == token::name ? 'a' : 'g');
+			i += otherFound(token::other, 1);
+		}
+		else if(c == '[' || c == '{')
+		{
+			brackets.push_back(c == '[' ? 'a' : '{');
+			i += otherFound(token::other, 1);
+		}
+		else if(c == ')' || c == ']' || c == '}')
+		{
+			if(!brackets.empty())
+				brackets.pop_back();
 
-	return illegalAliasesFound;
+			i += otherFound(token::closer, 1);
+		}
+		else if(c == '<' && at(i + 1) == '<' && at(i + 2) == '-')		i += leftAssignment(3);
+		else if(c == '<' && at(i + 1) == '-')							i += leftAssignment(2);
+		else if(c == '=' && at(i + 1) != '=')							i += brackets.empty() || brackets.back() != 'a' ? leftAssignment(1) : otherFound(token::other, 1);
+		else if(c == '-' && at(i + 1) == '>')
+		{
+			i += otherFound(token::other, at(i + 2) == '>' ? 3 : 2);
+			assignsRight = true;
+		}
+		else if((c == '=' || c == '!' || c == '<' || c == '>') && at(i + 1) == '=')
+			i += otherFound(token::other, 2);
+		else if(c == '%')
+		{
+			//An unmatched % is just a single character, the rest of the script still needs to be checked
+			const size_t end = script.find_first_of("%\n", i + 1);
+
+			if(end == std::string::npos || code[end] != '%')
+				i += otherFound(token::other, 1);
+			else
+			{
+				i = end + 1;
+				otherFound(token::other, 0);
+			}
+		}
+		else
+			i += otherFound(token::other, 1);
+	}
 }
 
 void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
 {
-    std::string commentFree = stringUtils::stripRComments(script);
-
 	static std::string errorMsg;
 
-	std::set<std::string> blackListedFunctions = findIllegalFunctions(commentFree);
+	std::set<std::string> blackListedFunctions, illegalAliasesFound;
+	scanScript(script, &blackListedFunctions, &illegalAliasesFound);
 
 	if(blackListedFunctions.size() > 0)
 	{
@@ -357,8 +593,6 @@ void R_FunctionWhiteList::scriptIsSafe(const std::string &script)
 		throw filterException(errorMsg);
 	}
 
-	std::set<std::string> illegalAliasesFound = findIllegalFunctionsAliases(commentFree);
-
 	if(illegalAliasesFound.size() > 0)
 	{
 		bool moreThanOne = illegalAliasesFound.size() > 1;
@@ -2,7 +2,8 @@
 #define R_FUNCTIONWHITELIST_H
 
 #include <set>
-#include <regex>
+#include <string>
+#include <string_view>
 #include <sstream>
 
 ///New exception to give feedback about possibly failing filters and such
@@ -19,13 +20,19 @@ public:
 /// This class attempts to restrict those scripts to use only whitelisted functions (in R_FunctionWhiteList::functionWhiteList)
 /// Of course, R is very flexible and there might be ways around it that we haven't thought of but this is much better than nothing.
 ///
+/// The script is checked by a small R lexer in a single pass (see scanScript), it skips comments and strings and keeps track of brackets,
+/// so that a call or an assignment is recognized the way R would parse it. Whitelist lookups go through a perfect hash of functionWhiteList.
+///
 class R_FunctionWhiteList
 {
 private:
 	///The following functions (and keywords that can be followed by a '(') will be allowed in user-entered R-code, such as filters or computed columns. This is for security because otherwise JASP-files could become a attack-vector (which doesn't refer to an R-datatype).
 	static const std::set<std::string> functionWhiteList;
-	static const std::string functionPrecedingCharacter, functionStartDelimit, functionNameStart, functionNameBody, operatorsR;
-	static const std::regex functionNameMatcher, functionNamePrecederMatcher, assignmentWhiteListedRightMatcher, assignmentWhiteListedLeftMatcher, assignmentOperatorRightMatcher, assignmentOperatorLeftMatcher;
+
+	static bool isWhiteListed(std::string_view name);
+
+	///Finds calls to functions that are not whitelisted and assignments to operators or whitelisted functions, either set may be nullptr if not interested
+	static void scanScript(std::string const & script, std::set<std::string> * illegalFunctions, std::set<std::string> * illegalAliases);
 
 public:
 	///throws a filterexception if the script is not legal for some reason
@@ -276,11 +276,9 @@ std::string TempFiles::createTmpFolder()
 		std::string tmpFolder	= _sessionDirName + "/tmp" + std::to_string(_nextTmpFolderId++) + "/";
 		std::filesystem::path path	= Utils::osPath(tmpFolder);
 
-		if (!std::filesystem::exists(path, error) || error)
-		{
-			std::filesystem::create_directories(path, error);
+		//Only return a folder we actually created ourselves, engines forked from the zygote all start counting at the same _nextTmpFolderId
+		if (std::filesystem::create_directories(path, error) || error)
 			return tmpFolder;
-		}
 	}
 }
 
@@ -2,10 +2,13 @@
 
 #ifdef PROFILE_JASP
 #include  <iostream>
+#include  <mutex>
 
 static std::map<std::string, boost::timer::cpu_timer *> * timers = nullptr;
+static std::mutex timersLock; ///< Importers and the like use timers from their worker threads as well
 
-boost::timer::cpu_timer * _getTimer(std::string timerName)
+///Expects timersLock to be held
+static boost::timer::cpu_timer * _getTimer(const std::string & timerName)
 {
 
 	//Log::log() << "getTimer! "<< timerName << std::endl;
@@ -22,8 +25,34 @@ boost::timer::cpu_timer * _getTimer(std::string timerName)
 	return (*timers)[timerName];
 }
 
+void _startTimer(const std::string & timerName)
+{
+	std::lock_guard<std::mutex> lock(timersLock);
+	_getTimer(timerName)->start();
+}
+
+void _resumeTimer(const std::string & timerName)
+{
+	std::lock_guard<std::mutex> lock(timersLock);
+	_getTimer(timerName)->resume();
+}
+
+void _stopTimer(const std::string & timerName)
+{
+	std::lock_guard<std::mutex> lock(timersLock);
+	_getTimer(timerName)->stop();
+}
+
+std::string _formatTimer(const std::string & timerName)
+{
+	std::lock_guard<std::mutex> lock(timersLock);
+	return _getTimer(timerName)->format();
+}
+
 void _printAllTimers()
 {
+	std::lock_guard<std::mutex> lock(timersLock);
+
 	if(timers == nullptr)
 		return;
 
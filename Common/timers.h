@@ -7,26 +7,30 @@
 /// This file contains some simple timers that can be added to a variety of locations in JASP to be able to profile easily
 /// To do so PROFILE_JASP can be defined in the build-environment and then rebuilt.
 /// If it isn't used it just compiles into some comments and thus thrown out entirely by the preprocessor.
+/// The timers may be used from several threads at once, every access goes through a single mutex. A timer that runs in several threads at the same time only measures from the first start to the first stop though.
 
 #include <boost/timer/timer.hpp>
 #include <string>
 #include <map>
 
 
-boost::timer::cpu_timer * _getTimer(std::string timerName);
-void _printAllTimers();
+void		_startTimer(	const std::string & timerName);
+void		_resumeTimer(	const std::string & timerName);
+void		_stopTimer(		const std::string & timerName);
+std::string	_formatTimer(	const std::string & timerName);
+void		_printAllTimers();
 
-#define JASPTIMER_START(  TIMERNAME ) _getTimer( #TIMERNAME )->start()
-#define JASPTIMER_RESUME( TIMERNAME ) _getTimer( #TIMERNAME )->resume()
-#define JASPTIMER_STOP(   TIMERNAME ) _getTimer( #TIMERNAME )->stop()
-#define JASPTIMER_PRINT(  TIMERNAME ) Log::log() << #TIMERNAME << " ran for " << _getTimer( #TIMERNAME )->format() << std::endl
+#define JASPTIMER_START(  TIMERNAME ) _startTimer( #TIMERNAME )
+#define JASPTIMER_RESUME( TIMERNAME ) _resumeTimer( #TIMERNAME )
+#define JASPTIMER_STOP(   TIMERNAME ) _stopTimer( #TIMERNAME )
+#define JASPTIMER_PRINT(  TIMERNAME ) Log::log() << #TIMERNAME << " ran for " << _formatTimer( #TIMERNAME ) << std::endl
 #define JASPTIMER_FINISH( TIMERNAME ) JASPTIMER_STOP(TIMERNAME); JASPTIMER_PRINT(TIMERNAME)
 #define JASPTIMER_PRINTALL() _printAllTimers()
 
 struct _JaspTimerScopeMeasure
 {
-	_JaspTimerScopeMeasure(const char * name) : _name(name) { _getTimer(_name)->resume(); }
-	~_JaspTimerScopeMeasure()								{ _getTimer(_name)->stop(); }
+	_JaspTimerScopeMeasure(const char * name) : _name(name) { _resumeTimer(_name); }
+	~_JaspTimerScopeMeasure()								{ _stopTimer(_name); }
 
 	const char * _name;
 };
@@ -24,6 +24,7 @@
 #include <filesystem>
 #include <set>
 #include <map>
+#include <span>
 #include "timers.h"
 
 enum class FileTypeBase;
@@ -42,6 +43,8 @@ typedef std::map<int, int>						intintmap;
 typedef std::set<std::string>					stringset;
 typedef std::vector<std::string>				stringvec;
 typedef std::vector<stringvec>					stringvecvec;
+typedef std::span<const int>					intspan;
+typedef std::span<const double>					doublespan;
 
 /// One of the utility classes
 /// This is for the sort of functions that you might want to use in either Desktop or Engine. Should not be used in R-Interface or jaspResults.
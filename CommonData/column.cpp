@@ -5,9 +5,42 @@
 #include "databaseinterface.h"
 
 Column::Column(DataSet * data, int id) 
-	: DataSetBaseNode(dataSetBaseNodeType::column, data->dataNode()), _data(data), _id(id)
+	: DataSetBaseNode(dataSetBaseNodeType::column, data->dataNode()), _data(data), _id(id), _batchedDirty(data->writeBatchedToDB())
 {}
 
+Column::~Column()
+{
+	_unmapValues(false);
+}
+
+void Column::_setMappedValues(MappedColumnStore::Mapping * mapping)
+{
+	_unmapValues(false);
+
+	_mappedValues = mapping;
+	_ints.clear();
+	_dbls.clear();
+
+	//Cells edited after the file was written are not in the mapped pages, so this column needs its own copy after all
+	if(_mappedValues->edited())
+		_unmapValues();
+}
+
+void Column::_unmapValues(bool keepValues)
+{
+	if(!_mappedValues)
+		return;
+
+	if(keepValues)
+	{
+		if(_type == columnType::scale)	_mappedValues->copyTo(_dbls);
+		else							_mappedValues->copyTo(_ints);
+	}
+
+	delete _mappedValues;
+	_mappedValues = nullptr;
+}
+
 void Column::dbCreate(int index)
 {
 	JASPTIMER_SCOPE(Column::dbCreate);
@@ -25,14 +58,17 @@ void Column::dbLoad(int id, bool getValues)
 	if(id != -1)
 		_id = id;
 
+	if(getValues)
+		_unmapValues(false);
+
 	db().transactionReadBegin();
 	
-					db().columnGetBasicInfo(	_id, _name, _title, _description, _type, _revision);
+					db().columnGetBasicInfo(	_id, _name, _title, _description, _type, _revision, _fingerprint);
 	_isComputed =   db().columnGetComputedInfo(	_id, _analysisId, _invalidated, _codeType, _rCode, _error, _constructorJson);
 
 	db().labelsLoad(this);
 	
-	if(getValues)
+	if(getValues && !db().columnMapValues(this))
 	{
 		if(type() == columnType::scale)	db().columnGetValuesDbls(_id, _dbls);
 		else							db().columnGetValuesInts(_id, _ints);
@@ -194,6 +230,15 @@ void Column::setInvalidated(bool invalidated)
 	incRevision();
 }
 
+void Column::setFingerprint(uint64_t fingerprint)
+{
+	if(_fingerprint == fingerprint)
+		return;
+
+	_fingerprint = fingerprint;
+	db().columnSetFingerprint(_id, _fingerprint);
+}
+
 void Column::setCodeType(computedColumnType codeType)
 {
 	JASPTIMER_SCOPE(Column::setCodeType);
@@ -390,8 +435,8 @@ bool Column::_resetMissingDataForNominal(intstrmap &missingDataMap)
 
 	if(hasChanged)
 	{
-		if(!_data->writeBatchedToDB())
-			db().columnSetValues(_id, _ints);
+		if(!_data->writeBatchedToDB())	db().columnSetValues(_id, _ints);
+		else							_batchedDirty = true;
 		incRevision();
 	}
 
@@ -666,6 +711,8 @@ bool Column::resetMissingData(intstrmap &missingDataMap)
 {
 	JASPTIMER_SCOPE(Column::resetEmptyValues);
 
+	_unmapValues();
+
 	switch(_type)
 	{
 	case columnType::ordinal:
@@ -824,6 +871,8 @@ columnTypeChangeResult Column::_changeColumnToScale()
 columnTypeChangeResult Column::changeType(columnType colType)
 {
 	JASPTIMER_SCOPE(Column::changeType);
+
+	_unmapValues();
 	
 	if(!isComputed())
 	{
@@ -912,6 +961,8 @@ bool Column::setAsScale(const doublevec & values)
 {
 	JASPTIMER_SCOPE(Column::setAsScale);
 
+	_unmapValues();
+
 	bool changedSomething = type() != columnType::scale;
 
 	if(values.size() != _dbls.size())
@@ -944,10 +995,13 @@ bool Column::setAsScale(const doublevec & values)
 			_dbls[i] = NAN;
 	}
 
+	if(changedSomething)
+		setFingerprint(0);
+
 	setType(columnType::scale);
 	labelsClear(); //delete now unused labels so they can not be erroneously reused when returning to non-scalar type
-	if(!_data->writeBatchedToDB())
-		db().columnSetValues(_id, _dbls);
+	if(!_data->writeBatchedToDB())	db().columnSetValues(_id, _dbls);
+	else							_batchedDirty = true;
 	incRevision();
 
 	_ints.clear(); //We can load these from the DB later if wanted
@@ -1088,6 +1142,8 @@ bool Column::_setAsNominalOrOrdinal(const intvec &values, bool is_ordinal)
 {
 	JASPTIMER_SCOPE(Column::_setAsNominalOrOrdinal);
 
+	_unmapValues();
+
 	bool changedSomething = type() != (is_ordinal ? columnType::ordinal : columnType::nominal);
 
 	if(values.size() != _ints.size())
@@ -1116,9 +1172,12 @@ bool Column::_setAsNominalOrOrdinal(const intvec &values, bool is_ordinal)
 
 	_dbls.clear(); //We can load them later if needed
 
+	if(changedSomething)
+		setFingerprint(0);
+
 	setType(is_ordinal ? columnType::ordinal : columnType::nominal);
-	if(!_data->writeBatchedToDB())
-		db().columnSetValues(_id, _ints);
+	if(!_data->writeBatchedToDB())	db().columnSetValues(_id, _ints);
+	else							_batchedDirty = true;
 	
 	if(changedSomething)
 		incRevision();
@@ -1152,6 +1211,9 @@ intstrmap Column::setAsNominalText(const stringvec &values, const strstrmap & la
 {
 	JASPTIMER_SCOPE(Column::setAsNominalText);
 
+	_unmapValues();
+	setFingerprint(0); //Whoever imported these values sets it again afterwards
+
 	if(changedSomething != nullptr)
 		*changedSomething = type() != columnType::nominalText;
 	
@@ -1215,8 +1277,8 @@ intstrmap Column::setAsNominalText(const stringvec &values, const strstrmap & la
 	_dbls.clear(); //We can load them later if needed
 
 	setType(columnType::nominalText);
-	if(!_data->writeBatchedToDB())
-		db().columnSetValues(_id, _ints);
+	if(!_data->writeBatchedToDB())	db().columnSetValues(_id, _ints);
+	else							_batchedDirty = true;
 	incRevision();
 
 	return emptyValuesMap;
@@ -1228,6 +1290,7 @@ void Column::labelsClear()
 	db().labelsClear(_id);
 	_labels.clear();
 	_labelByValueMap.clear();
+	_labelsMaxDisplayLength = 0;
 
 	incRevision();
 }
@@ -1289,6 +1352,9 @@ int Column::labelsAdd(int value, const std::string & display, bool filterAllows,
 
 	_labelByValueMap[label->value()] = label;
 
+	if(_labelsMaxDisplayLength != -1)
+		_labelsMaxDisplayLength = std::max(_labelsMaxDisplayLength, int(label->label(true).size()));
+
 	_dbUpdateLabelOrder();
 	return label->value();
 }
@@ -1315,6 +1381,8 @@ void Column::labelsRemoveValues(std::set<int> valuesToRemove)
 			}),
 			_labels.end());
 
+	_labelsMaxDisplayLength = -1;
+
 	_dbUpdateLabelOrder();
 }
 
@@ -1358,9 +1426,33 @@ void Column::labelsRemoveBeyond(size_t indexToStartRemoving)
 	
 	_labels.resize(indexToStartRemoving);
 
+	_labelsMaxDisplayLength = -1;
+
 	_resetLabelValueMap();
 }
 
+size_t Column::labelsMaxDisplayLength() const
+{
+	if(_labelsMaxDisplayLength == -1)
+	{
+		_labelsMaxDisplayLength = 0;
+
+		for(const Label * label : _labels)
+			_labelsMaxDisplayLength = std::max(_labelsMaxDisplayLength, int(label->label(true).size()));
+	}
+
+	return _labelsMaxDisplayLength;
+}
+
+void Column::labelDisplayLengthChanged(size_t oldLength, size_t newLength)
+{
+	if(_labelsMaxDisplayLength == -1)
+		return;
+
+	if(int(newLength) >= _labelsMaxDisplayLength)		_labelsMaxDisplayLength = newLength;
+	else if(int(oldLength) == _labelsMaxDisplayLength)	_labelsMaxDisplayLength = -1; //The longest one might have gotten shorter, so we have to look again
+}
+
 void Column::_resetLabelValueMap()
 {
 	_labelByValueMap.clear();
@@ -1517,9 +1609,9 @@ bool Column::isValueEqual(size_t row, double value) const
 
 	//isEmptyVal handles nan
 	if (isEmptyValue(value))
-		return isEmptyValue(_dbls[row]);
+		return isEmptyValue(dbls()[row]);
 	else
-		return _dbls[row] == value;
+		return dbls()[row] == value;
 
 }
 
@@ -1531,9 +1623,9 @@ bool Column::isValueEqual(size_t row, int value) const
 		return false;
 
 	if (_type == columnType::scale)
-		return _dbls[row] == value;
+		return dbls()[row] == value;
 
-	int intValue = _ints[row];
+	int intValue = ints()[row];
 
 	if (_type == columnType::nominal || _type == columnType::ordinal)
 		return (intValue == value);
@@ -1562,11 +1654,11 @@ bool Column::isValueEqual(size_t row, const std::string &value) const
 
 	switch (_type)
 	{
-		case columnType::scale:		return std::to_string(_dbls[row]) == value;
+		case columnType::scale:		return std::to_string(dbls()[row]) == value;
 		case columnType::nominal:
-		case columnType::ordinal:	return std::to_string(_ints[row]) == value;
+		case columnType::ordinal:	return std::to_string(ints()[row]) == value;
 		default:
-			return	_ints[row] == std::numeric_limits<int>::lowest()
+			return	ints()[row] == std::numeric_limits<int>::lowest()
 					? isEmptyValue(value)
 					: value == getValue(row);
 	}
@@ -1587,11 +1679,11 @@ std::string Column::getValue(size_t row, bool fancyEmptyValue) const
 	if (row < rowCount())
 	{
 		if (_type == columnType::scale)
-			return doubleToDisplayString(_dbls[row], fancyEmptyValue);
+			return doubleToDisplayString(dbls()[row], fancyEmptyValue);
 
-		else if (_ints[row] != std::numeric_limits<int>::lowest())
+		else if (ints()[row] != std::numeric_limits<int>::lowest())
 		{
-			Label * label = labelByValue(_ints[row]);
+			Label * label = labelByValue(ints()[row]);
 
 			if(label)
 				return label->originalValueAsString();
@@ -1603,8 +1695,8 @@ std::string Column::getValue(size_t row, bool fancyEmptyValue) const
 
 Label * Column::labelByRow(int row) const
 {
-	if (row < rowCount() && _type != columnType::scale && _ints[row] != std::numeric_limits<int>::lowest())
-			return labelByValue(_ints[row]);
+	if (row < rowCount() && _type != columnType::scale && ints()[row] != std::numeric_limits<int>::lowest())
+			return labelByValue(ints()[row]);
 
 	return nullptr;
 }
@@ -1613,34 +1705,35 @@ bool Column::convertValueToIntForImport(const std::string &strValue, int &intVal
 {
 	JASPTIMER_SCOPE(Column::convertValueToIntForImport);
 
-	if(isEmptyValue(strValue))
+	double doubleValue;
+
+	switch(ColumnUtils::classifyValue(strValue, emptyValues(), intValue, doubleValue))
 	{
-			intValue = std::numeric_limits<int>::lowest();
-			return true;
+	case ColumnUtils::valueKind::empty:		intValue = std::numeric_limits<int>::lowest();	return true;
+	case ColumnUtils::valueKind::integer:													return true;
+	default:																				return false;
 	}
-
-	return ColumnUtils::getIntValue(strValue, intValue);
 }
 
 bool Column::convertValueToDoubleForImport(const std::string & strValue, double & doubleValue) const
 {
-	std::string v = strValue;
-	ColumnUtils::deEuropeaniseForImport(v);
+	int intValue;
 
-	if(isEmptyValue(v))
+	switch(ColumnUtils::classifyValue(strValue, emptyValues(), intValue, doubleValue))
 	{
-			doubleValue = NAN;
-			return true;
+	case ColumnUtils::valueKind::empty:		doubleValue = NAN;	return true;
+	case ColumnUtils::valueKind::text:							return false;
+	default:													return true;
 	}
-
-	return ColumnUtils::getDoubleValue(strValue, doubleValue);
 }
 
 
 bool Column::setStringValueToRowIfItFits(size_t row, const std::string & value, bool & changed, bool & typeChanged)
 {
     JASPTIMER_SCOPE(Column::setStringValueToRowIfItFits);
-    
+
+	_unmapValues();
+
 	typeChanged = changed = false;
 
 	bool convertedSuccesfully = value == "";
@@ -1724,6 +1817,7 @@ bool Column::setStringValueToRowIfItFits(size_t row, const std::string & value,
 						if(_labels[i] == oldLabel)
 						{
 							_labels.erase(_labels.begin() + i);
+							_labelsMaxDisplayLength = -1;
 							oldLabel->dbDelete();
 							break;
 						}
@@ -1796,18 +1890,25 @@ bool Column::setValue(size_t row, int value, bool writeToDB)
 {
 	JASPTIMER_SCOPE(Column::setValue int);
 
+	_unmapValues();
+
 	if(row >= _ints.size())
 		return false;
 	
 	bool changed = _ints[row] != value;
 
 	_ints[row] = value;
+
+	if(changed)
+		setFingerprint(0);
 	
 	if(writeToDB)
 	{
 		db().columnSetValue(_id, row, value);
 		incRevision();
 	}
+	else if(changed && _data->writeBatchedToDB())
+		_batchedDirty = true;
 
 	return changed;
 }
@@ -1816,6 +1917,8 @@ bool Column::setValue(size_t row, double value, bool writeToDB)
 {
 	JASPTIMER_SCOPE(Column::setValue double);
 
+	_unmapValues();
+
 	if(row >= _dbls.size())
 		return false;
 	
@@ -1823,47 +1926,214 @@ bool Column::setValue(size_t row, double value, bool writeToDB)
 
 	_dbls[row] = value;
 
+	if(changed)
+		setFingerprint(0);
+
 	if(writeToDB)
 	{
 		db().columnSetValue(_id, row, value);
 		incRevision();
 	}
+	else if(changed && _data->writeBatchedToDB())
+		_batchedDirty = true;
 
 	return changed;
 }
 
 void Column::setValues(const intvec & values)
 {
+	_unmapValues(false);
 	_ints = values;
+	setFingerprint(0); //Whoever imported these values sets it again afterwards
 
-	if(!_data->writeBatchedToDB())
-		db().columnSetValues(_id, _ints);
+	if(!_data->writeBatchedToDB())	db().columnSetValues(_id, _ints);
+	else							_batchedDirty = true;
 }
 
 void Column::setValues(const doublevec & values)
 {
+	_unmapValues(false);
 	_dbls = values;
+	setFingerprint(0);
 
-	if(!_data->writeBatchedToDB())
-		db().columnSetValues(_id, _dbls);
+	if(!_data->writeBatchedToDB())	db().columnSetValues(_id, _dbls);
+	else							_batchedDirty = true;
+}
+
+void Column::appendEmptyRows(size_t count)
+{
+	JASPTIMER_SCOPE(Column::appendEmptyRows);
+
+	_unmapValues();
+
+	if(type() == columnType::scale)	_dbls.resize(_dbls.size() + count, NAN);
+	else							_ints.resize(_ints.size() + count, std::numeric_limits<int>::lowest());
+
+	//The new rows in DataSet_# are NULL and thus already empty, but a mapped file has to grow along
+	if(db().valuesMapped())
+	{
+		if(type() == columnType::scale)	db().columnSetValues(_id, _dbls);
+		else							db().columnSetValues(_id, _ints);
+	}
+
+	incRevision();
+}
+
+bool Column::stringValuesFitType(const stringvec & values) const
+{
+	JASPTIMER_SCOPE(Column::stringValuesFitType);
+
+	int		intValue;
+	double	doubleValue;
+
+	for(const std::string & value : values)
+		switch(_type)
+		{
+		case columnType::scale:
+			if(!convertValueToDoubleForImport(value, doubleValue))
+				return false;
+			break;
+
+		case columnType::nominal:
+		case columnType::ordinal:
+			if(!convertValueToIntForImport(value, intValue))
+				return false;
+			break;
+
+		default: //nominalText takes anything
+			break;
+		}
+
+	return true;
+}
+
+void Column::setStringValuesFrom(size_t firstRow, const stringvec & values, intstrmap & emptyValues)
+{
+	JASPTIMER_SCOPE(Column::setStringValuesFrom);
+
+	_unmapValues();
+
+	//Keep the fingerprint up to date as long as it is known, that way the next sync does not need to look at these rows again
+	uint64_t fingerprint = _fingerprint;
+
+	if(fingerprint)
+		for(size_t i=0; i<values.size(); i++)
+			fingerprint += ColumnUtils::fingerprintCell(firstRow + i, values[i].data(), values[i].size());
+
+	switch(_type)
+	{
+	case columnType::scale:
+	{
+		if(_dbls.size() < firstRow + values.size())
+			_dbls.resize(firstRow + values.size(), NAN);
+
+		for(size_t i=0; i<values.size(); i++)
+		{
+			double doubleValue = NAN;
+			convertValueToDoubleForImport(values[i], doubleValue);
+
+			if (std::isnan(doubleValue) && values[i] != ColumnUtils::emptyValue)
+				emptyValues[firstRow + i] = values[i];
+
+			_dbls[firstRow + i] = doubleValue;
+		}
+
+		db().columnSetValuesFrom(_id, firstRow, _dbls);
+		break;
+	}
+
+	case columnType::nominal:
+	case columnType::ordinal:
+	case columnType::nominalText:
+	{
+		if(_ints.size() < firstRow + values.size())
+			_ints.resize(firstRow + values.size(), std::numeric_limits<int>::lowest());
+
+		strintmap labelValueByOriginal;
+		if(_type == columnType::nominalText)
+			for(const Label * label : _labels)
+				labelValueByOriginal[label->originalValueAsString()] = label->value();
+
+		for(size_t i=0; i<values.size(); i++)
+		{
+			const std::string	&	value		= values[i];
+			int						intValue	= std::numeric_limits<int>::lowest();
+
+			if(_type != columnType::nominalText)
+			{
+				convertValueToIntForImport(value, intValue);
+
+				if(intValue != std::numeric_limits<int>::lowest() && !labelByValue(intValue))
+					labelsAdd(intValue);
+			}
+			else if(!isEmptyValue(value))
+			{
+				if(!labelValueByOriginal.count(value))
+					labelValueByOriginal[value] = labelsAdd(value);
+
+				intValue = labelValueByOriginal[value];
+			}
+
+			if(intValue == std::numeric_limits<int>::lowest() && !value.empty())
+				emptyValues[firstRow + i] = value;
+
+			_ints[firstRow + i] = intValue;
+		}
+
+		db().columnSetValuesFrom(_id, firstRow, _ints);
+		break;
+	}
+
+	default:
+		break;
+	}
+
+	setFingerprint(fingerprint == 0 && _fingerprint ? 1 : fingerprint); //Same as ColumnUtils::fingerprint
+	incRevision();
 }
 
 void Column::rowInsertEmptyVal(size_t row)
 {
+	_unmapValues();
+
 	if(type() == columnType::scale)	_dbls.insert(_dbls.begin() + row, NAN);
 	else							_ints.insert(_ints.begin() + row, std::numeric_limits<int>::lowest());
+
+	setFingerprint(0);
+
+	_batchedDirty = _batchedDirty || _data->writeBatchedToDB();
 }
 
 void Column::rowDelete(size_t row)
 {
+	_unmapValues();
+
 	if(type() == columnType::scale)	_dbls.erase(_dbls.begin() + row);
 	else							_ints.erase(_ints.begin() + row);
+
+	setFingerprint(0);
+
+	_batchedDirty = _batchedDirty || _data->writeBatchedToDB();
 }
 
 void Column::setRowCount(size_t rows)
 {
+	_unmapValues();
+
+	if(rows != rowCount())
+		setFingerprint(0);
+
+	_resizeValues(rows);
+}
+
+void Column::_resizeValues(size_t rows)
+{
+	_unmapValues();
+
 	if(type() == columnType::scale)		{ _dbls.resize(rows); _ints.resize(0); }
 	else								{ _ints.resize(rows); _dbls.resize(0); }
+
+	_batchedDirty = _batchedDirty || _data->writeBatchedToDB();
 }
 
 Label *Column::labelByValue(int value) const
@@ -1935,9 +2205,9 @@ std::string Column::operator[](size_t row)
 	if (row < rowCount())
 	{
 		if (_type == columnType::scale)
-			return doubleToDisplayString(_dbls[row], true);
+			return doubleToDisplayString(dbls()[row], true);
 		else
-			return _getLabelDisplayStringByValue(_ints[row]);
+			return _getLabelDisplayStringByValue(ints()[row]);
 	}
 
 	return result;
@@ -2003,12 +2273,49 @@ void Column::incRevision()
 
 bool Column::checkForUpdates()
 {
+	JASPTIMER_SCOPE(Column::checkForUpdates);
+
 	assert(_id != -1);
 
 	if(_revision == db().columnGetRevision(_id))
 		return false;
 
-	dbLoad();
+	//Usually just some cells were edited, in that case we only apply those instead of reloading all values
+	std::vector<std::pair<size_t, double>> changes;
+	const columnType knownType = _type;
+
+	db().transactionReadBegin();
+
+	const bool onlyCellsChanged = db().columnGetValueChanges(_id, _revision, changes);
+
+	dbLoad(-1, false);
+
+	if(!onlyCellsChanged || _type != knownType)
+		dbLoad();
+
+	else if(_mappedValues) //Desktop wrote the edited cells into the overlay of the store, mapping the column again picks them up
+	{
+		if(!db().columnMapValues(this))
+			dbLoad();
+	}
+	else
+	{
+		if(rowCount() < size_t(_data->rowCount())) //Rows were appended by a synch, their values (if any) are in changes
+		{
+			if(_type == columnType::scale)	_dbls.resize(_data->rowCount(), NAN);
+			else							_ints.resize(_data->rowCount(), std::numeric_limits<int>::lowest());
+		}
+
+		for(const auto & rowValue : changes)
+			if(rowValue.first < rowCount())
+			{
+				if(_type == columnType::scale)	_dbls[rowValue.first] = rowValue.second;
+				else							_ints[rowValue.first] = int(rowValue.second);
+			}
+	}
+
+	db().transactionReadEnd();
+
 	return true;
 }
 
@@ -2133,11 +2440,11 @@ Json::Value Column::serialize() const
 		jsonLabels.append(label->serialize());
 
 	Json::Value jsonDbls(Json::arrayValue);
-	for (double dbl : _dbls)
+	for (double dbl : dbls())
 		jsonDbls.append(dbl);
 
 	Json::Value jsonInts(Json::arrayValue);
-	for (int i : _ints)
+	for (int i : ints())
 		jsonInts.append(i);
 
 	if (_data->hasCustomEmptyValues(_name))
@@ -2207,6 +2514,7 @@ void Column::deserialize(const Json::Value &json)
 	}
 	_labelByValueMap.clear();
 	_labels.clear();
+	_labelsMaxDisplayLength = 0;
 
 	const Json::Value& labels = json["labels"];
 	if (labels.isArray())
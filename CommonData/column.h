@@ -5,6 +5,7 @@
 #include "label.h"
 #include "columntype.h"
 #include "utils.h"
+#include "mappedcolumnstore.h"
 #include <list>
 
 class DataSet;
@@ -21,10 +22,14 @@ typedef std::vector<Label*> Labels;
 /// As well as UI support functions for modifying the labels and such.
 /// 
 /// It also handles storing the information of computed columns (those used to be split off)
+///
+/// When the values are kept in MappedColumnStore an engine maps them read-only instead of copying them into _ints/_dbls, see ints() and dbls().
+/// Anything that modifies the values first copies them into the vectors through _unmapValues().
 class Column : public DataSetBaseNode
 {
 public:
 									Column(DataSet * data, int id = -1);
+									~Column();
 									
 				DatabaseInterface & db();
 		const	DatabaseInterface & db() const;
@@ -47,6 +52,7 @@ public:
 			bool					setConstructorJson(	const Json::Value & constructorJson	);
 			bool					setConstructorJson(	const std::string & constructorJson	);
 			void					setAnalysisId(		int					analysisId		);
+			void					setFingerprint(		uint64_t				fingerprint		);
 			void					setInvalidated(		bool				invalidated		);
 			void					setCompColStuff(bool   invalidated, computedColumnType   codeType, const	std::string & rCode, const	std::string & error, const	Json::Value & constructorJson);
 			void					setDefaultValues(enum columnType columnType = columnType::unknown);
@@ -84,6 +90,7 @@ public:
 			int						analysisId()			const	{ return _analysisId;		}
 			bool					isComputed()			const	{ return _isComputed;		}
 			bool					invalidated()			const	{ return _invalidated;		}
+			uint64_t				fingerprint()			const	{ return _fingerprint;		} ///< ColumnUtils::fingerprint of the strings this column was last imported from, or 0 if unknown or edited since
 			computedColumnType		codeType()				const	{ return _codeType;			}
 			const std::string	&	name()					const	{ return _name;				}
 			const std::string	&	title()					const	{ return _title;			}
@@ -93,9 +100,10 @@ public:
 				  std::string		rCodeStripped()			const	{ return stringUtils::stripRComments(_rCode);	}
 				  std::string		constructorJsonStr()	const	{ return _constructorJson.toStyledString();	}
 			const Json::Value	&	constructorJson()		const	{ return _constructorJson;	}
-			size_t					rowCount()				const	{ return _type == columnType::scale ? _dbls.size() : _ints.size(); }
-			const intvec		&	ints()					const	{ return _ints; }
-			const doublevec		&	dbls()					const	{ return _dbls; }
+			size_t					rowCount()				const	{ return _mappedValues ? _mappedValues->rowCount() : _type == columnType::scale ? _dbls.size() : _ints.size(); }
+			intspan					ints()					const	{ return _mappedValues && _type != columnType::scale ? intspan(		_mappedValues->ints(), _mappedValues->rowCount()) : intspan(_ints); }
+			doublespan				dbls()					const	{ return _mappedValues && _type == columnType::scale ? doublespan(	_mappedValues->dbls(), _mappedValues->rowCount()) : doublespan(_dbls); }
+			bool					valuesMapped()			const	{ return _mappedValues; }
 
 			void					labelsClear();
 			int						labelsAdd(			int display);
@@ -120,9 +128,12 @@ public:
 			bool					setValue(					size_t row, double				value, bool writeToDB = true);
 			void					setValues(								const intvec	&	values);
 			void					setValues(								const doublevec	&	values);
+			void					appendEmptyRows(size_t count);																	///< Used by DataSet::appendEmptyRows
+			bool					stringValuesFitType(const stringvec & values) const;											///< Whether values could be stored in this column without changing its type
+			void					setStringValuesFrom(size_t firstRow, const stringvec & values, intstrmap & emptyValues);		///< Sets the rows from firstRow onwards as an import would, adding labels where needed. Assumes stringValuesFitType and adds the missing values that are not "" to emptyValues
 			void					rowInsertEmptyVal(size_t row);
 			void					rowDelete(size_t row);
-			void					setRowCount(size_t row);
+			void					setRowCount(size_t row);																		///< Forgets the fingerprint when that changes the number of rows
 
 			Labels				&	labels()												{ return _labels; }
 			const Labels		&	labels()										const	{ return _labels; }
@@ -130,6 +141,8 @@ public:
 			Label				*	labelByDisplay(	const std::string & display)	const; ///< Might be nullptr for missing display
 			Label				*	labelByRow(		int					row)		const; ///< Might be nullptr for missing
 			int						labelIndex(		const Label * label)			const;
+			size_t					labelsMaxDisplayLength()						const; ///< Length of the longest Label::label(true), kept up to date as labels change so views do not need to go through all labels to size a column
+			void					labelDisplayLengthChanged(size_t oldLength, size_t newLength); ///< Called by Label when its label changes
 
 
 
@@ -143,6 +156,8 @@ public:
 			void					beginBatchedLabelsDB();
 			void					endBatchedLabelsDB(bool wasWritingBatch = true);
 			bool					batchedLabel()	{ return _batchedLabel; }
+			bool					batchedDirty()							const	{ return _batchedDirty;		} ///< Whether the values changed since DataSet::beginBatchedToDB, so dataSetBatchedValuesUpdate knows what to write
+			void					setBatchedDirty(bool dirty)						{ _batchedDirty = dirty;	}
 
 			void					rememberOriginalColumnType();
 			
@@ -190,6 +205,9 @@ protected:
 			bool					_resetMissingDataForNominalText(intstrmap & missingDataMap, bool tryToConvert = true);
 			
 			void					_resetLabelValueMap();
+			void					_setMappedValues(MappedColumnStore::Mapping * mapping);	///< Takes ownership of mapping and clears _ints and _dbls
+			void					_unmapValues(bool keepValues = true);					///< Copies the mapped values into _ints or _dbls (unless !keepValues) and releases the mapping
+			void					_resizeValues(size_t rows);								///< Like setRowCount but leaves the fingerprint alone, for DatabaseInterface to make room before it loads the values
 
 private:
 			DataSet		*			_data				= nullptr;
@@ -198,9 +216,11 @@ private:
 									_preEditType		= columnType::unknown;
 			int						_id					= -1,
 									_analysisId			= -1;		// Actually initialized in DatabaseInterface::columnInsert
+	mutable	int						_labelsMaxDisplayLength	= -1;	///< -1 when it needs to be determined again by labelsMaxDisplayLength()
 			bool					_isComputed			= false,	// Actually initialized in DatabaseInterface::columnInsert
 									_invalidated		= false,
-									_batchedLabel		= false;
+									_batchedLabel		= false,
+									_batchedDirty		= false;
 			computedColumnType		_codeType			= computedColumnType::notComputed;
 			std::string				_name,
 									_title,
@@ -208,10 +228,14 @@ private:
 									_error,
 									_rCode;
 			Json::Value				_constructorJson	= Json::objectValue;
+			uint64_t				_fingerprint		= 0;
 			doublevec				_dbls;
 			intvec					_ints;
+			MappedColumnStore::Mapping * _mappedValues		= nullptr;
 			stringset				_dependsOnColumns;
 			std::map<int, Label*>	_labelByValueMap;			
+
+	friend class DatabaseInterface; ///< So that DatabaseInterface::dataSetBatchedValuesLoad can fill _dbls and _ints directly
 };
 
 #endif // COLUMN_H
@@ -8,6 +8,18 @@
 #endif
 #include <codecvt>
 #include <regex>
+#include <charconv>
+#include <sstream>
+#include <cmath>
+#include <cerrno>
+#include <cstring>
+#ifndef __cpp_lib_to_chars
+#ifdef __APPLE__
+#include <xlocale.h>
+#else
+#include <locale.h>
+#endif
+#endif
 
 using namespace std;
 using namespace boost::posix_time;
@@ -18,26 +30,13 @@ string					ColumnUtils::emptyValue							= "";
 
 bool ColumnUtils::getIntValue(const string &value, int &intValue)
 {
-	try
-	{
-		intValue = boost::lexical_cast<int>(value);
-		return true;
-	}
-	catch (...)	{}
-
-	return false;
+	return parseInt(value, intValue);
 }
 
 bool ColumnUtils::isIntValue(const string &value)
 {
-	try
-	{
-		boost::lexical_cast<int>(value);
-		return true;
-	}
-	catch (...)	{}
-
-	return false;
+	int intValue;
+	return parseInt(value, intValue);
 }
 
 bool ColumnUtils::getIntValue(const double &value, int &intValue)
@@ -64,27 +63,164 @@ bool ColumnUtils::getIntValue(const double &value, int &intValue)
 
 bool ColumnUtils::getDoubleValue(const string &value, double &doubleValue)
 {
-	try
+	return parseDouble(value, doubleValue);
+}
+
+
+bool ColumnUtils::isDoubleValue(const string &value)
+{
+	double doubleValue;
+	return parseDouble(value, doubleValue);
+}
+
+bool ColumnUtils::parseInt(std::string_view value, int & intValue)
+{
+	//from_chars doesn't take a leading '+' but lexical_cast, which was used before, did
+	if(value.size() > 1 && value[0] == '+' && value[1] != '-')
+		value.remove_prefix(1);
+
+	const char * end = value.data() + value.size();
+	auto result = std::from_chars(value.data(), end, intValue);
+
+	return result.ec == std::errc() && result.ptr == end;
+}
+
+bool ColumnUtils::parseDouble(std::string_view value, double & doubleValue)
+{
+	if(value.size() > 1 && value[0] == '+' && value[1] != '-')
+		value.remove_prefix(1);
+
+#ifdef __cpp_lib_to_chars
+	const char * end = value.data() + value.size();
+	auto result = std::from_chars(value.data(), end, doubleValue);
+
+	return result.ec == std::errc() && result.ptr == end;
+#else
+	//No floating point from_chars in this standard library (libc++ before macOS 13.3) so fall back on strtod_l in the "C" locale.
+	//It takes what from_chars takes, including inf, infinity and nan in any case, but also leading whitespace, a sign after the '+' dropped above and hexadecimals, so those are refused first.
+	static locale_t cLocale = newlocale(LC_ALL_MASK, "C", nullptr);
+
+	if(value.empty() || std::isspace(static_cast<unsigned char>(value[0])) || value[0] == '+' || value.find_first_of("xX") != std::string_view::npos)
+		return false;
+
+	//strtod_l needs a terminating zero, numbers fit on the stack
+	char			onStack[64];
+	std::string		onHeap;
+	char		*	terminated	= onStack;
+
+	if(value.size() >= sizeof(onStack))
 	{
-		doubleValue = boost::lexical_cast<double>(value);
-		return true;
+		onHeap.resize(value.size());
+		terminated = onHeap.data();
 	}
-	catch (...) {}
 
-	return false;
+	std::memcpy(terminated, value.data(), value.size());
+	terminated[value.size()] = '\0';
+
+	char * end;
+	errno		= 0;
+	doubleValue	= strtod_l(terminated, &end, cLocale);
+
+	return end == terminated + value.size() && errno != ERANGE;
+#endif
 }
 
+bool ColumnUtils::parseEuropeanDouble(std::string_view value, double & doubleValue)
+{
+	if(value.find(',') == std::string_view::npos)
+		return parseDouble(value, doubleValue);
 
-bool ColumnUtils::isDoubleValue(const string &value)
+	//Same as deEuropeaniseForImport: drop the dots and turn the first comma into a dot, numbers fit on the stack
+	char			onStack[64];
+	std::string		onHeap;
+	char		*	out		= onStack;
+
+	if(value.size() > sizeof(onStack))
+	{
+		onHeap.resize(value.size());
+		out = onHeap.data();
+	}
+
+	size_t	length		= 0;
+	bool	firstComma	= true;
+
+	for(char k : value)
+		if		(k == '.')					continue;
+		else if	(k == ',' && firstComma)	{ out[length++] = '.'; firstComma = false; }
+		else								out[length++] = k;
+
+	return parseDouble(std::string_view(out, length), doubleValue);
+}
+
+ColumnUtils::valueKind ColumnUtils::classifyValue(const std::string & value, const stringset & emptyValues, int & intValue, double & doubleValue)
 {
-	try
+	if(isEmptyValue(value, emptyValues))
+		return valueKind::empty;
+
+	//lowest() marks a missing value in the ints of a column, so it can't be an integer itself
+	if(parseInt(value, intValue) && intValue != std::numeric_limits<int>::lowest())
 	{
-		boost::lexical_cast<double>(value);
-		return true;
+		doubleValue = intValue;
+		return valueKind::integer;
 	}
-	catch (...)	{}
 
-	return false;
+	return parseEuropeanDouble(value, doubleValue) ? valueKind::decimal : valueKind::text;
+}
+
+void ColumnUtils::inferColumnType(const stringvec & values, const stringset & emptyValues, ColumnInference & inference)
+{
+	JASPTIMER_SCOPE(ColumnUtils::inferColumnType);
+
+	inference = ColumnInference();
+	inference.ints.reserve(values.size());
+	inference.dbls.reserve(values.size());
+
+	for(size_t row=0; row<values.size(); row++)
+	{
+		int		intValue	= std::numeric_limits<int>::lowest();
+		double	doubleValue	= NAN;
+
+		switch(classifyValue(values[row], emptyValues, intValue, doubleValue))
+		{
+		case valueKind::empty:
+			inference.empties++;
+
+			if(!values[row].empty())
+				inference.emptyValues[row] = values[row];
+			break;
+
+		case valueKind::integer:
+			inference.integers++;
+
+			if(inference.allIntegers())
+				inference.uniqueInts.insert(intValue);
+			break;
+
+		case valueKind::decimal:
+			if(inference.decimals++ == 0)
+			{
+				intvec().swap(inference.ints);
+				intset().swap(inference.uniqueInts);
+			}
+
+			if(std::isnan(doubleValue))
+				inference.emptyValues[row] = values[row];
+			break;
+
+		case valueKind::text:
+			//Once a single value is text the whole column is, so there is no point in looking further
+			inference.texts++;
+			intvec().swap(inference.ints);
+			doublevec().swap(inference.dbls);
+			intset().swap(inference.uniqueInts);
+			return;
+		}
+
+		if(inference.allIntegers())
+			inference.ints.push_back(intValue);
+
+		inference.dbls.push_back(doubleValue);
+	}
 }
 
 
@@ -138,30 +274,27 @@ void ColumnUtils::deEuropeaniseForImport(std::string & value)
 bool ColumnUtils::convertValueToIntForImport(const std::string &strValue, int &intValue)
 {
 	JASPTIMER_SCOPE(ColumnUtils::convertValueToIntForImport);
-	
-	if(isEmptyValue(strValue, EmptyValues::singleton()->workspaceEmptyValues()))
-		intValue = std::numeric_limits<int>::lowest();
-	else
+
+	double doubleValue;
+
+	switch(classifyValue(strValue, EmptyValues::singleton()->workspaceEmptyValues(), intValue, doubleValue))
 	{
-		if (!ColumnUtils::getIntValue(strValue, intValue))
-			return false;
+	case valueKind::empty:		intValue = std::numeric_limits<int>::lowest();	return true;
+	case valueKind::integer:													return true;
+	default:																	return false;
 	}
-
-	return true;
 }
 
 bool ColumnUtils::convertValueToDoubleForImport(const std::string & strValue, double & doubleValue)
 {
-	std::string v = strValue;
-	deEuropeaniseForImport(v);
+	int intValue;
 
-	if(isEmptyValue(v, EmptyValues::singleton()->workspaceEmptyValues()))
-		doubleValue = NAN;
-	
-	else if (!ColumnUtils::getDoubleValue(v, doubleValue))
-		return false;
-	
-	return true;
+	switch(classifyValue(strValue, EmptyValues::singleton()->workspaceEmptyValues(), intValue, doubleValue))
+	{
+	case valueKind::empty:		doubleValue = NAN;	return true;
+	case valueKind::text:							return false;
+	default:										return true;
+	}
 }
 
 bool ColumnUtils::isEmptyValue(const std::string & val, const stringset & emptyValues)
@@ -194,6 +327,33 @@ std::string ColumnUtils::doubleToString(double dbl, int precision)
 
 
 // hex should be 4 hexadecimals characters
+uint64_t ColumnUtils::fingerprintCell(size_t row, const char * value, size_t length)
+{
+	//FNV-1a over the bytes, then mixed with the row through splitmix64 to get well distributed bits for the sum
+	uint64_t hash = 14695981039346656037ULL;
+
+	for(size_t i=0; i<length; i++)
+		hash = (hash ^ uint8_t(value[i])) * 1099511628211ULL;
+
+	hash ^= uint64_t(row) * 0x9E3779B97F4A7C15ULL;
+	hash  = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash  = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+
+	return hash ^ (hash >> 31);
+}
+
+uint64_t ColumnUtils::fingerprint(const stringvec & values)
+{
+	JASPTIMER_SCOPE(ColumnUtils::fingerprint);
+
+	uint64_t sum = 0;
+
+	for(size_t row=0; row<values.size(); row++)
+		sum += fingerprintCell(row, values[row].data(), values[row].size());
+
+	return sum == 0 ? 1 : sum;
+}
+
 std::string ColumnUtils::_convertEscapedUnicodeToUTF8(std::string hex)
 {
 	JASPTIMER_SCOPE(ColumnUtils::_convertEscapedUnicodeToUTF8);
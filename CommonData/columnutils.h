@@ -5,6 +5,8 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <cstdint>
+#include <string_view>
 #include "utils.h"
 
 class ColumnUtils
@@ -13,6 +15,28 @@ public:
 	friend class PreferencesModel;
 
 	static       std::string emptyValue;
+
+	///What a single imported value can be converted to, see classifyValue
+	enum class valueKind { empty, integer, decimal, text };
+
+	///The running counts of the kinds of values in a column together with the conversions so far, filled by inferColumnType
+	struct ColumnInference
+	{
+		size_t		empties		= 0,
+					integers	= 0,
+					decimals	= 0,
+					texts		= 0;
+		intvec		ints;			///< Per row with lowest() for empty, released as soon as a decimal shows up
+		doublevec	dbls;			///< Per row with NaN for empty, released as soon as a text shows up
+		intset		uniqueInts;		///< Only while allIntegers()
+		intstrmap	emptyValues;	///< Rows with an empty value other than "", such as "NA"
+
+		bool		allIntegers()	const { return decimals == 0 && texts == 0;	}
+		bool		allNumbers()	const { return texts == 0;					}
+	};
+
+	static valueKind	classifyValue(		const std::string & value,	const stringset & emptyValues, int & intValue, double & doubleValue);	///< Without exceptions, sets intValue for an integer and doubleValue for an integer or decimal. A decimal may be written the European way
+	static void			inferColumnType(	const stringvec & values,	const stringset & emptyValues, ColumnInference & inference);			///< Classifies all values in a single pass and stops as soon as one of them is text
 	
 	static bool getIntValue(	const std::string	& value, int	& intValue);
 	static bool getIntValue(	const double		& value, int	& intValue);
@@ -30,8 +54,15 @@ public:
 
 	static std::string	doubleToString(			double dbl, int precision = 10);
 
+	static uint64_t		fingerprintCell(size_t row, const char * value, size_t length);	///< Hash of a single cell, depends on the row so that moving values around also changes the fingerprint
+	static uint64_t		fingerprint(	const stringvec & values);							///< Wrapping sum of fingerprintCell over all values, so it can be extended when rows are appended. 0 is reserved for "unknown"
+
 private:
 	static std::string _convertEscapedUnicodeToUTF8(	std::string hex);
+
+	static bool	parseInt(				std::string_view value, int		& intValue);
+	static bool	parseDouble(			std::string_view value, double	& doubleValue);
+	static bool	parseEuropeanDouble(	std::string_view value, double	& doubleValue);	///< As parseDouble after deEuropeaniseForImport, without copying the value
 };
 
 #endif // COLUMNUTILS_H
@@ -4,9 +4,13 @@
 #include "log.h"
 #include "dataset.h"
 #include "columntype.h"
+#include "mappedcolumnstore.h"
 #include "version"
 
 DatabaseInterface * DatabaseInterface::_singleton = nullptr;
+const size_t		DatabaseInterface::_columnarLoadGroupSize = 256;
+const int			DatabaseInterface::_valueChangesKept = 1000;
+const size_t		DatabaseInterface::_preparedStatementsKept = 64;
 
 //#define SIR_LOG_A_LOT
 
@@ -17,9 +21,13 @@ const std::string DatabaseInterface::_dbConstructionSql =
 							", revision INT DEFAULT 0, FOREIGN KEY(dataSet) REFERENCES DataSets(id));\n"
 "CREATE TABLE Columns		( id INTEGER PRIMARY KEY, dataSet INT, name TEXT, title TEXT, description TEXT, columnType TEXT, colIdx INT, isComputed INT, invalidated INT NULL, "
 							"codeType TEXT NULL, rCode TEXT NULL, error TEXT NULL, constructorJson TEXT NULL, "
-							"analysisId INT NULL, revision INT DEFAULT 0, FOREIGN KEY(dataSet) REFERENCES DataSets(id));\n"
+							"analysisId INT NULL, revision INT DEFAULT 0, fingerprint INT DEFAULT 0, FOREIGN KEY(dataSet) REFERENCES DataSets(id));\n"
 "CREATE TABLE Labels		( id INTEGER PRIMARY KEY, columnId INT, value INT, ordering INT, filterAllows INT, label TEXT, originalValueJson TEXT, description TEXT, FOREIGN KEY(columnId) REFERENCES Columns(id));\n";
 
+const std::string DatabaseInterface::_dbValueChangesSql =
+"CREATE TABLE IF NOT EXISTS ColumnValueChanges	( id INTEGER PRIMARY KEY, columnId INT, revision INT, row INT, value REAL, FOREIGN KEY(columnId) REFERENCES Columns(id));\n"
+"CREATE INDEX IF NOT EXISTS ColumnValueChangesIdx	ON ColumnValueChanges(columnId, revision);\n";
+
 void DatabaseInterface::upgradeDBFromVersion(Version originalVersion)
 {
 	   transactionWriteBegin();
@@ -29,13 +37,25 @@ void DatabaseInterface::upgradeDBFromVersion(Version originalVersion)
 
 	   //Later versions can add new originalVersion < blabla blocks at the end of this "list"
 
+	   //The fingerprint of columns was added without a version bump, so just check whether it is there
+	   bool hasFingerprint = false;
+	   runStatements("PRAGMA table_info(Columns);", [](sqlite3_stmt *){}, [&](size_t, sqlite3_stmt * stmt)
+	   {
+			   if(_wrap_sqlite3_column_text(stmt, 1) == "fingerprint")
+					   hasFingerprint = true;
+	   });
+
+	   if(!hasFingerprint)
+			   runStatements("ALTER TABLE Columns ADD COLUMN fingerprint INT DEFAULT 0;" "\n");
+
 		transactionWriteEnd();
 }
 
 DatabaseInterface::DatabaseInterface(bool createDb)
 {
 	assert(!_singleton);
-	_singleton = this;
+	_singleton	= this;
+	_isEngine	= !createDb;
 	
 	if(createDb)	create();
 	else			load();
@@ -165,6 +185,8 @@ void DatabaseInterface::filterDelete(int filterIndex)
 	JASPTIMER_SCOPE(DatabaseInterface::filterDelete);
 	transactionWriteBegin();
 
+	_preparedStatementsClear();
+
 	int dataSetId = filterGetDataSetId(filterIndex);
 
 	if(dataSetId != -1)
@@ -474,68 +496,160 @@ void DatabaseInterface::dataSetBatchedValuesUpdate(DataSet * data, std::function
 
 	transactionWriteBegin();
 
+	const bool	mapped		= valuesMapped(),
+				sameRows	= dataSetRowCount(data->id()) == data->rowCount();
+
+	//If the rows stayed the same we only need to touch what was modified during the batch, otherwise DataSet_# needs to be rebuilt from scratch
+	if(sameRows)	_dataSetBatchedValuesDirty(  data, progressCallback);
+	else			_dataSetBatchedValuesRewrite(data, progressCallback, !mapped);
+
+	//This is also where the cells written one by one since the last batch end up in a new generation, instead of in the overlay of the store
+	if(mapped)
+		for(Column * col : data->columns())
+			if(!sameRows || col->batchedDirty() || MappedColumnStore::hasEdits(col->id(), col->type() == columnType::scale))
+			{
+				if(col->type() == columnType::scale)	MappedColumnStore::write(col->id(), col->dbls());
+				else									MappedColumnStore::write(col->id(), col->ints());
+			}
+
+	transactionWriteEnd();
+}
+
+void DatabaseInterface::_dataSetBatchedValuesRewrite(DataSet * data, std::function<void(float)> progressCallback, bool withValues)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::_dataSetBatchedValuesRewrite);
+
 	//Clear the entire dataset, then insert each row, including filter.
 	//Bear in mind that this will also erase any scalar values that a column mightve converted from earlier.
 	//As this data isnt synced anyway this shouldnt be a problem because it'd be invalidated after a single edit anyway
 	runStatements("DELETE FROM " + dataSetName(data->id()));
 
-	std::stringstream statement;
+	const Columns		columns			= withValues ? data->columns() : Columns();
+	const size_t		rowCount		= data->rowCount(),
+						paramsPerRow	= columns.size() + 2, //filter and rowNumber
+						rowsPerInsert	= std::max(size_t(1), size_t(sqlite3_limit(_db, SQLITE_LIMIT_VARIABLE_NUMBER, -1)) / paramsPerRow);
+
+	std::stringstream prefix;
 
-	statement << "INSERT INTO " << dataSetName(data->id()) << " (";
+	prefix << "INSERT INTO " << dataSetName(data->id()) << " (";
 
 	//Add columnnames for data we want to insert
-	for(Column * col : data->columns())
-		statement << "Column_" << col->id() << (col->type() == columnType::scale ? "_DBL" : "_INT") << ", ";
+	for(Column * col : columns)
+		prefix << columnBaseName(col->id()) << (col->type() == columnType::scale ? "_DBL" : "_INT") << ", ";
 
 	//And the filtername and rowNumber
-	statement << filterName(data->filter()->id()) << ", " << "rowNumber) VALUES (";
+	prefix << filterName(data->filter()->id()) << ", " << "rowNumber) VALUES ";
 
-	for(size_t i=0; i<data->columns().size(); i++)
-		statement << "?, ";
-	statement << "?, ?);"; //filter and rowNumber
+	std::string rowPlaceholders = "(";
+	for(size_t i=0; i<paramsPerRow; i++)
+		rowPlaceholders += i == 0 ? "?" : ", ?";
+	rowPlaceholders += ")";
 
-	//We put a size_t outside the bindParamStore lambda to set it without having to change the signature
-	size_t rowOutside=0;
-	bindParametersType bindParamStore = [&](sqlite3_stmt * stmt)
+	auto insertStatement = [&](size_t rows)
 	{
-		size_t i=1;
-		for(Column * col : data->columns())
-			if(col->type() == columnType::scale)	_doubleTroubleBinder(stmt,	i++, col->dbls()[rowOutside]);
-			else									sqlite3_bind_int(	stmt,	i++, col->ints()[rowOutside]);
+		std::string statement = prefix.str();
+
+		for(size_t r=0; r<rows; r++)
+			statement += (r == 0 ? "" : ", ") + rowPlaceholders;
 
-		sqlite3_bind_int(stmt,	i++, data->filter()->filtered()[rowOutside]);
-		sqlite3_bind_int(stmt,	i++, rowOutside+1);
+		return statement + ";";
 	};
 
-	const float rowsInverse		= 1.0 / float(data->rowCount());
-	const int	updateInterval	= std::max(1, data->rowCount() / 100);
+	const std::string	fullInsert	= insertStatement(rowsPerInsert);
+	const boolvec	&	filtered	= data->filter()->filtered();
 
-	_runStatementsRepeatedly(
-		statement.str(),
-		[&](bindParametersType ** bindParameters, size_t row)
+	for(size_t rowStart=0; rowStart<rowCount; rowStart+=rowsPerInsert)
+	{
+		const size_t		rows		= std::min(rowsPerInsert, rowCount - rowStart);
+		const std::string	statement	= rows == rowsPerInsert ? fullInsert : insertStatement(rows);
+		sqlite3_stmt	*	stmt		= _preparedStatement(statement);
+		int					param		= 1;
+
+		for(size_t row=rowStart; row<rowStart+rows; row++)
 		{
-			if(row >= data->rowCount())
-			{
-				progressCallback(1);
-				return false;
-			}
+			for(Column * col : columns)
+				if(col->type() == columnType::scale)	_doubleTroubleBinder(stmt,	param++, col->dbls()[row]);
+				else									sqlite3_bind_int(	stmt,	param++, col->ints()[row]);
 
-			rowOutside = row;
+			sqlite3_bind_int(stmt,	param++, filtered[row]);
+			sqlite3_bind_int(stmt,	param++, row+1);
+		}
 
-			static int prevUpdate = 0;
+		_preparedStatementRun(stmt, statement);
+
+		progressCallback(float(rowStart + rows) / float(rowCount));
+	}
+
+	progressCallback(1);
+}
+
+void DatabaseInterface::_dataSetBatchedValuesDirty(DataSet * data, std::function<void(float)> progressCallback)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::_dataSetBatchedValuesDirty);
 
-			if(prevUpdate + updateInterval <= rowOutside)
+	Columns dirtyColumns;
+
+	if(!valuesMapped()) //Otherwise they are written to MappedColumnStore by dataSetBatchedValuesUpdate
+		for(Column * col : data->columns())
+			if(col->batchedDirty())
+				dirtyColumns.push_back(col);
+
+	const bool filterDirty = data->filter()->batchedDirty();
+
+	if(dirtyColumns.size() == 0 && !filterDirty)
+	{
+		progressCallback(1);
+		return;
+	}
+
+	//A single UPDATE per row for all dirty columns, as sqlite rewrites the entire row record for any change anyway
+	std::stringstream statementStream;
+
+	statementStream << "UPDATE " << dataSetName(data->id()) << " SET ";
+
+	//Both values of a column are written, the one not used by its type becomes NULL just like in _dataSetBatchedValuesRewrite. Otherwise a column that changed type during the batch keeps its old values there.
+	for(size_t i=0; i<dirtyColumns.size(); i++)
+		statementStream << (i == 0 ? "" : ", ") << columnBaseName(dirtyColumns[i]->id()) << "_DBL=?, " << columnBaseName(dirtyColumns[i]->id()) << "_INT=?";
+
+	if(filterDirty)
+		statementStream << (dirtyColumns.size() == 0 ? "" : ", ") << filterName(data->filter()->id()) << "=?";
+
+	statementStream << " WHERE rowNumber=?;";
+
+	const std::string	statement		= statementStream.str();
+	const boolvec	&	filtered		= data->filter()->filtered();
+	const size_t		rowCount		= data->rowCount(),
+						updateInterval	= std::max(size_t(1), rowCount / 100);
+	sqlite3_stmt	*	stmt			= _preparedStatement(statement);
+
+	for(size_t row=0; row<rowCount; row++)
+	{
+		int param = 1;
+
+		for(Column * col : dirtyColumns)
+			if(col->type() == columnType::scale)
 			{
-				progressCallback(float(rowOutside) * rowsInverse);
-				prevUpdate = rowOutside;
+				_doubleTroubleBinder(	stmt,	param++, col->dbls()[row]);
+				sqlite3_bind_null(		stmt,	param++);
+			}
+			else
+			{
+				sqlite3_bind_null(		stmt,	param++);
+				sqlite3_bind_int(		stmt,	param++, col->ints()[row]);
 			}
 
-			(*bindParameters) = &bindParamStore;
+		if(filterDirty)
+			sqlite3_bind_int(stmt,	param++, filtered[row]);
 
-			return true;
-		});
+		sqlite3_bind_int(stmt,	param++, row+1);
 
-	transactionWriteEnd();
+		_preparedStatementRun(stmt, statement);
+
+		if(row % updateInterval == 0)
+			progressCallback(float(row) / float(rowCount));
+	}
+
+	progressCallback(1);
 }
 
 void DatabaseInterface::dataSetBatchedValuesLoad(DataSet *data, std::function<void(float)> progressCallback)
@@ -550,62 +664,186 @@ void DatabaseInterface::dataSetBatchedValuesLoad(DataSet *data, std::function<vo
 
 	transactionReadBegin();
 
-	std::stringstream statement;
-
-	statement << "SELECT ";
+	const long		startMs		= Utils::currentMillis();
+	const size_t	rowCount	= dataSetRowCount(data->id());
+	const bool		mapped		= valuesMapped();
+	Columns			columns; //The ones that need to be read from DataSet_#
 
 	for(Column * col : data->columns())
-		statement << "Column_" << col->id() << (col->type() == columnType::scale ? "_DBL" : "_INT") << ", ";
+	{
+		col->_unmapValues(false);
 
-	statement << filterName(data->filter()->id()) << " FROM " << dataSetName(data->id()) << " ORDER BY rowNumber";
+		//With MappedColumnStore the engines map the values and Desktop reads them, only columns without a file are left for sqlite.
+		bool fromStore = false;
 
-	std::function<void(sqlite3_stmt *stmt)>  prepare = [&](sqlite3_stmt *stmt) {};
+		if(mapped && _isEngine)
+		{
+			MappedColumnStore::Mapping * mapping = MappedColumnStore::map(col->id(), col->type() == columnType::scale, rowCount);
 
-	const size_t	rowCount	= dataSetRowCount(data->id());
+			if(mapping)
+			{
+				col->_setMappedValues(mapping);
+				fromStore = true;
+			}
+			else
+				col->_resizeValues(rowCount);
+		}
+		else
+		{
+			col->_resizeValues(rowCount);
 
-	for(Column * col : data->columns())
-		col->setRowCount(rowCount);
+			if(mapped)
+				fromStore = col->type() == columnType::scale ? MappedColumnStore::read(col->id(), col->_dbls, rowCount) : MappedColumnStore::read(col->id(), col->_ints, rowCount);
+		}
+
+		if(!fromStore)
+			columns.push_back(col);
+	}
 
 	data->filter()->setRowCount(rowCount);
 
-    size_t rowPercent = std::max(1, int(rowCount) / 100);
+	const size_t	rowPercent	= std::max(size_t(1), rowCount / 100),
+					groupCount	= std::max(size_t(1), (columns.size() + _columnarLoadGroupSize - 1) / _columnarLoadGroupSize);
+	const bool		hasFilter	= data->filter()->id() != -1;
 
-	std::function<void(size_t, sqlite3_stmt *stmt)> processRow = [&](size_t row, sqlite3_stmt *stmt)
+	//Each group gets its own SELECT, the first one also reads the filter. We keep plain pointers to the buffers of the columns so the loop over the rows does nothing but read from sqlite and write to memory.
+	std::vector<double	*>	dblTargets;
+	std::vector<int		*>	intTargets;
+
+	for(size_t group=0; group<groupCount; group++)
 	{
-        if(row % rowPercent == 0)
-            progressCallback(float(row) / float(rowCount));
+		const size_t	colStart	= group * _columnarLoadGroupSize,
+						colEnd		= std::min(columns.size(), colStart + _columnarLoadGroupSize);
+		const bool		readFilter	= group == 0 && hasFilter;
 
-		int colCount = sqlite3_column_count(stmt);
+		if(colStart == colEnd && !readFilter)
+			break;
+
+		dblTargets.assign(colEnd - colStart, nullptr);
+		intTargets.assign(colEnd - colStart, nullptr);
 
-		assert(colCount == data->columns().size() + 1);
+		std::stringstream statement;
+		statement << "SELECT ";
 
-		for(size_t colI=0; colI<data->columns().size(); colI++)
+		for(size_t colI=colStart; colI<colEnd; colI++)
 		{
-			Column * col = data->columns()[colI];
-			
-			if(!sqlite3_column_text(	stmt, colI)) //If string is NULL then column value is NULL, so empty!
-			{
-				if(col->type() == columnType::scale)	col->setValue(row, NAN,									false);
-				else									col->setValue(row, std::numeric_limits<int>::lowest(),	false);
-			}
-			else
-			{
-				if(col->type() == columnType::scale)	col->setValue(row, _doubleTroubleReader(	stmt, colI), false);
-				else									col->setValue(row, sqlite3_column_int(		stmt, colI), false);
-			}
+			Column * col = columns[colI];
+
+			if(col->type() == columnType::scale)	dblTargets[colI - colStart] = col->_dbls.data();
+			else									intTargets[colI - colStart] = col->_ints.data();
+
+			statement << columnBaseName(col->id()) << (col->type() == columnType::scale ? "_DBL" : "_INT") << (colI + 1 < colEnd || readFilter ? ", " : "");
 		}
 
-		data->filter()->setFilterValueNoDB(row, sqlite3_column_int(stmt, colCount - 1));
-	};
+		if(readFilter)
+			statement << filterName(data->filter()->id());
 
-	runStatements(statement.str(), prepare, processRow);
+		statement << " FROM " << dataSetName(data->id()) << " ORDER BY rowNumber";
+
+		const int		filterCol		= colEnd - colStart;
+		const float		groupProgress	= 1.0f / float(groupCount);
+		Filter		*	filter			= data->filter();
+
+		std::function<void(size_t, sqlite3_stmt *stmt)> processRow = [&](size_t row, sqlite3_stmt *stmt)
+		{
+			if(row % rowPercent == 0)
+				progressCallback(groupProgress * (float(group) + float(row) / float(rowCount)));
+
+			assert(sqlite3_column_count(stmt) == filterCol + int(readFilter));
+
+			for(int colI=0; colI<filterCol; colI++)
+				if(dblTargets[colI])	dblTargets[colI][row] = sqlite3_column_type(stmt, colI) == SQLITE_NULL ? NAN									: _doubleTroubleReader(stmt, colI);
+				else					intTargets[colI][row] = sqlite3_column_type(stmt, colI) == SQLITE_NULL ? std::numeric_limits<int>::lowest()	: sqlite3_column_int(stmt, colI);
+
+			if(readFilter)
+				filter->setFilterValueNoDB(row, sqlite3_column_int(stmt, filterCol));
+		};
+
+		runStatements(statement.str(), [](sqlite3_stmt *){}, processRow);
+	}
+
+	//Desktop moves whatever came from DataSet_# into the store, so the engines can map it from now on
+	if(mapped && !_isEngine)
+		for(Column * col : columns)
+		{
+			if(col->type() == columnType::scale)	MappedColumnStore::write(col->id(), col->dbls());
+			else									MappedColumnStore::write(col->id(), col->ints());
+		}
+
+	progressCallback(1);
+
+	_logLoadSpeed("dataSetBatchedValuesLoad", data, startMs);
 
 	transactionReadEnd();
 }
 
+bool DatabaseInterface::valuesMapped() const
+{
+	return _isEngine ? MappedColumnStore::enabledForSession() : _valuesMapped;
+}
+
+void DatabaseInterface::setValuesMapped(bool mapped)
+{
+	assert(!_isEngine);
+
+	if(_valuesMapped == mapped)
+		return;
+
+	_valuesMapped = mapped;
+	MappedColumnStore::setEnabledForSession(mapped);
+}
+
+bool DatabaseInterface::columnMapValues(Column * column)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::columnMapValues);
+
+	if(!_isEngine || !valuesMapped())
+		return false;
+
+	MappedColumnStore::Mapping * mapping = MappedColumnStore::map(column->id(), column->type() == columnType::scale, dataSetRowCount(columnGetDataSetId(column->id())));
+
+	if(!mapping)
+		return false;
+
+	column->_setMappedValues(mapping);
+
+	return true;
+}
+
+void DatabaseInterface::dataSetWriteMappedValuesToDB(DataSet * data)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::dataSetWriteMappedValuesToDB);
+
+	if(!valuesMapped())
+		return;
+
+	transactionWriteBegin();
+	_dataSetBatchedValuesRewrite(data, [](float){}, true);
+	transactionWriteEnd();
+}
+
+void DatabaseInterface::_logLoadSpeed(const char * loader, DataSet * data, long startMs)
+{
+#ifdef PROFILE_JASP
+	const long		ms		= std::max(1L, Utils::currentMillis() - startMs);
+	const size_t	rows	= data->filter()->filtered().size();
+
+	Log::log() << loader << " loaded " << rows << " rows of " << data->columns().size() << " columns in " << ms << "ms, that is " << size_t(double(rows) * 1000.0 / double(ms)) << " rows/s." << std::endl;
+#endif
+}
+
 void DatabaseInterface::columnSetValues(int columnId, const intvec &ints)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::columnSetValues);
+
+	_columnLogValuesReset(columnId);
+
+	if(valuesMapped())
+	{
+		MappedColumnStore::write(columnId, ints);
+		return;
+	}
+
 	transactionWriteBegin();
 	
 	const int dataSetId = columnGetDataSetId(columnId);
@@ -641,6 +879,15 @@ void DatabaseInterface::columnSetValues(int columnId, const intvec &ints)
 void DatabaseInterface::columnSetValues(int columnId, const doublevec &dbls)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::columnSetValues);
+
+	_columnLogValuesReset(columnId);
+
+	if(valuesMapped())
+	{
+		MappedColumnStore::write(columnId, dbls);
+		return;
+	}
+
 	transactionWriteBegin();
 	
 	const int dataSetId = columnGetDataSetId(columnId);
@@ -674,15 +921,105 @@ void DatabaseInterface::columnSetValues(int columnId, const doublevec &dbls)
 void DatabaseInterface::columnSetValue(int columnId, size_t row, int value)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::columnSetValue);
+
+	_columnLogValueChange(columnId, row, value);
+
+	if(valuesMapped() && MappedColumnStore::writeValue(columnId, row, value))
+		return;
+
 	const int dataSetId = columnGetDataSetId(columnId);
 	
 	const std::string updateStatement = "UPDATE Dataset_" + std::to_string(dataSetId)	+ " SET Column_"  + std::to_string(columnId) + "_INT=? WHERE rowNumber=?";
 
-	runStatements(updateStatement, [&](sqlite3_stmt * stmt)
+	sqlite3_stmt * stmt = _preparedStatement(updateStatement);
+
+	sqlite3_bind_int(	stmt,	1, value);
+	sqlite3_bind_int(	stmt,	2, row+1);
+
+	_preparedStatementRun(stmt, updateStatement);
+}
+
+void DatabaseInterface::_columnLogValueChange(int columnId, size_t row, double value)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::_columnLogValueChange);
+
+	transactionWriteBegin();
+
+	const std::string insertStatement = "INSERT INTO ColumnValueChanges (columnId, revision, row, value) SELECT id, revision, ?, ? FROM Columns WHERE id=?;";
+
+	sqlite3_stmt * stmt = _preparedStatement(insertStatement);
+
+	sqlite3_bind_int(	stmt,	1, row);
+	_doubleTroubleBinder(stmt,	2, value);
+	sqlite3_bind_int(	stmt,	3, columnId);
+
+	_preparedStatementRun(stmt, insertStatement);
+
+	const std::string trimStatement = "DELETE FROM ColumnValueChanges WHERE columnId=? AND revision < (SELECT revision FROM Columns WHERE id=?) - ?;";
+
+	stmt = _preparedStatement(trimStatement);
+
+	sqlite3_bind_int(stmt,	1, columnId);
+	sqlite3_bind_int(stmt,	2, columnId);
+	sqlite3_bind_int(stmt,	3, _valueChangesKept);
+
+	_preparedStatementRun(stmt, trimStatement);
+
+	if(sqlite3_changes(_db) > 0) //Whoever is still behind the trimmed part cannot catch up through the log anymore
+		runStatements("INSERT INTO ColumnValueChanges (columnId, revision, row) SELECT id, revision - ?, -1 FROM Columns WHERE id=?;", [&](sqlite3_stmt * stmt)
+		{
+			sqlite3_bind_int(stmt,	1, _valueChangesKept);
+			sqlite3_bind_int(stmt,	2, columnId);
+		});
+
+	transactionWriteEnd();
+}
+
+void DatabaseInterface::_columnLogValuesReset(int columnId)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::_columnLogValuesReset);
+
+	transactionWriteBegin();
+
+	std::function<void(sqlite3_stmt *stmt)> prepare = [&](sqlite3_stmt *stmt)
 	{
-		sqlite3_bind_int(	stmt,	1, value);
-		sqlite3_bind_int(	stmt,	2, row+1);
-	});
+		sqlite3_bind_int(stmt, 1, columnId);
+	};
+
+	//The single changes before this are of no use anymore, the marker is enough
+	runStatements("DELETE FROM ColumnValueChanges WHERE columnId=?;",															prepare);
+	runStatements("INSERT INTO ColumnValueChanges (columnId, revision, row) SELECT id, revision, -1 FROM Columns WHERE id=?;",	prepare);
+
+	transactionWriteEnd();
+}
+
+bool DatabaseInterface::columnGetValueChanges(int columnId, int sinceRevision, std::vector<std::pair<size_t, double>> & changes)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::columnGetValueChanges);
+
+	//A change tagged with sinceRevision might or might not have been seen already, but applying it again in the same order does no harm
+	bool usable = true;
+
+	changes.clear();
+
+	runStatements("SELECT row, value FROM ColumnValueChanges WHERE columnId=? AND revision>=? ORDER BY id;",
+		[&](sqlite3_stmt *stmt)
+		{
+			sqlite3_bind_int(stmt, 1, columnId);
+			sqlite3_bind_int(stmt, 2, sinceRevision);
+		},
+		[&](size_t, sqlite3_stmt *stmt)
+		{
+			const int row = sqlite3_column_int(stmt, 0);
+
+			if(row < 0)	usable = false;
+			else		changes.push_back(std::make_pair(size_t(row), _doubleTroubleReader(stmt, 1)));
+		});
+
+	if(!usable)
+		changes.clear();
+
+	return usable;
 }
 
 void DatabaseInterface::_doubleTroubleBinder(sqlite3_stmt * stmt, int param, double dbl)
@@ -702,6 +1039,10 @@ double DatabaseInterface::_doubleTroubleReader(sqlite3_stmt * stmt, int colI)
 {	
 	JASPTIMER_SCOPE(DatabaseInterface::_doubleTroubleReader);
 
+	//Only _doubleTroubleBinder's special values are stored as text, so anything else can skip the string compares entirely
+	if(sqlite3_column_type(stmt, colI) != SQLITE_TEXT)
+		return sqlite3_column_double(stmt, colI);
+
 	const std::string strVal = _wrap_sqlite3_column_text(stmt, colI);
 	
 	if(!strVal.empty())
@@ -725,15 +1066,59 @@ double DatabaseInterface::_doubleTroubleReader(sqlite3_stmt * stmt, int colI)
 void DatabaseInterface::columnSetValue(int columnId, size_t row, double value)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::columnSetValue);
+
+	_columnLogValueChange(columnId, row, value);
+
+	if(valuesMapped() && MappedColumnStore::writeValue(columnId, row, value))
+		return;
+
 	const int dataSetId = columnGetDataSetId(columnId);
 	
 	const std::string updateStatement = "UPDATE Dataset_" + std::to_string(dataSetId)	+ " SET Column_"  + std::to_string(columnId) + "_DBL=? WHERE rowNumber=?";
 
-	runStatements(updateStatement, [&](sqlite3_stmt * stmt)
+	sqlite3_stmt * stmt = _preparedStatement(updateStatement);
+
+	_doubleTroubleBinder(stmt,	1, value);
+	sqlite3_bind_int(	stmt,	2, row+1);
+
+	_preparedStatementRun(stmt, updateStatement);
+}
+
+void DatabaseInterface::columnSetValuesFrom(int columnId, size_t firstRow, const intvec & ints)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::columnSetValuesFrom int);
+
+	//More cells than that would push an engine past the log anyway, and the mapped file needs to be rewritten to get longer
+	if(valuesMapped() || ints.size() - std::min(firstRow, ints.size()) > size_t(_valueChangesKept))
 	{
-		_doubleTroubleBinder(stmt,	1, value);
-		sqlite3_bind_int(	stmt,	2, row+1);
-	});
+		columnSetValues(columnId, ints);
+		return;
+	}
+
+	transactionWriteBegin();
+
+	for(size_t row = firstRow; row < ints.size(); row++)
+		columnSetValue(columnId, row, ints[row]);
+
+	transactionWriteEnd();
+}
+
+void DatabaseInterface::columnSetValuesFrom(int columnId, size_t firstRow, const doublevec & dbls)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::columnSetValuesFrom double);
+
+	if(valuesMapped() || dbls.size() - std::min(firstRow, dbls.size()) > size_t(_valueChangesKept))
+	{
+		columnSetValues(columnId, dbls);
+		return;
+	}
+
+	transactionWriteBegin();
+
+	for(size_t row = firstRow; row < dbls.size(); row++)
+		columnSetValue(columnId, row, dbls[row]);
+
+	transactionWriteEnd();
 }
 
 
@@ -801,6 +1186,12 @@ void DatabaseInterface::columnGetValuesInts(int columnId, intvec & ints)
 	int				dataSet		= columnGetDataSetId(columnId);
 	const size_t	rowCount	= dataSetRowCount(dataSet);
 
+	if(valuesMapped() && MappedColumnStore::read(columnId, ints, rowCount))
+	{
+		transactionReadEnd();
+		return;
+	}
+
 	ints.resize(rowCount);
 
 	std::function<void(size_t, sqlite3_stmt *stmt)> processRow = [&](size_t row, sqlite3_stmt *stmt)
@@ -830,6 +1221,12 @@ void DatabaseInterface::columnGetValuesDbls(int columnId, doublevec & dbls)
 	int				dataSet		= columnGetDataSetId(columnId);
 	const size_t	rowCount	= dataSetRowCount(dataSet);
 
+	if(valuesMapped() && MappedColumnStore::read(columnId, dbls, rowCount))
+	{
+		transactionReadEnd();
+		return;
+	}
+
 	dbls.resize(rowCount);
 
 	//Log::log() << "columnId " << columnId << " has " << rowCount << " values.\n";
@@ -901,6 +1298,9 @@ void DatabaseInterface::columnDelete(int columnId, bool cleanUpRest)
 	JASPTIMER_SCOPE(DatabaseInterface::columnDelete);
 	transactionWriteBegin();
 
+	_preparedStatementsClear();
+	MappedColumnStore::remove(columnId);
+
 	//First lets drop the columns in the dataSet
 	int dataSetId	= columnGetDataSetId(columnId),
 		columnIndex	= columnIndexForId(columnId);
@@ -921,6 +1321,8 @@ void DatabaseInterface::columnDelete(int columnId, bool cleanUpRest)
 		sqlite3_bind_int(stmt,	1, dataSetId);
 		sqlite3_bind_int(stmt,	2, columnId);
 	});
+
+	runStatements("DELETE FROM ColumnValueChanges WHERE columnId=?;", [&](sqlite3_stmt * stmt) { sqlite3_bind_int(stmt, 1, columnId); });
 	
 	if(cleanUpRest)
 		columnIndexDecrements(dataSetId, columnIndex);
@@ -949,6 +1351,16 @@ void DatabaseInterface::columnSetInvalidated(int columnId, bool invalidated)
 	});
 }
 
+void DatabaseInterface::columnSetFingerprint(int columnId, uint64_t fingerprint)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::columnSetFingerprint);
+	runStatements("UPDATE Columns SET fingerprint=? WHERE id=?;", [&](sqlite3_stmt * stmt)
+	{
+		sqlite3_bind_int64(stmt,	1,	sqlite3_int64(fingerprint));
+		sqlite3_bind_int(stmt,		2,	columnId);
+	});
+}
+
 void DatabaseInterface::columnSetIndex(int columnId, int index)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::columnSetIndex);
@@ -1034,7 +1446,7 @@ void DatabaseInterface::columnSetComputedInfo(int columnId, int analysisId, bool
 	});
 }
 
-void DatabaseInterface::columnGetBasicInfo(int columnId, std::string &name, std::string &title, std::string &description, columnType &colType, int & revision)
+void DatabaseInterface::columnGetBasicInfo(int columnId, std::string &name, std::string &title, std::string &description, columnType &colType, int & revision, uint64_t & fingerprint)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::columnGetBasicInfo);
 	std::function<void(sqlite3_stmt *stmt)>  prepare = [&](sqlite3_stmt *stmt)
@@ -1046,17 +1458,18 @@ void DatabaseInterface::columnGetBasicInfo(int columnId, std::string &name, std:
 	{
 		int colCount = sqlite3_column_count(stmt);
 
-		assert(colCount == 5);
+		assert(colCount == 6);
 					name		= _wrap_sqlite3_column_text(stmt, 0);
 					title		= _wrap_sqlite3_column_text(stmt, 1);
 					description	= _wrap_sqlite3_column_text(stmt, 2);
 		std::string colTypeStr	= _wrap_sqlite3_column_text(stmt, 3);
 		revision				= sqlite3_column_int(		stmt, 4);
+		fingerprint				= uint64_t(sqlite3_column_int64(stmt, 5));
 
 		colType = colTypeStr.empty() ? columnType::unknown : columnTypeFromString(colTypeStr);
 	};
 
-	runStatements("SELECT name, title, description, columnType, revision FROM Columns WHERE id = ?;", prepare, processRow);
+	runStatements("SELECT name, title, description, columnType, revision, fingerprint FROM Columns WHERE id = ?;", prepare, processRow);
 }
 
 
@@ -1398,9 +1811,13 @@ void DatabaseInterface::dataSetDelete(int dataSetId)
 {
 	JASPTIMER_SCOPE(DatabaseInterface::dataSetDelete);
 	transactionWriteBegin();
+	_preparedStatementsClear();
 	runStatements("DELETE FROM DataSets WHERE id = " + std::to_string(dataSetId) + ";");
 	runStatements("DROP TABLE " + dataSetName(dataSetId) + ";");
 	transactionWriteEnd();
+
+	if(!_isEngine)
+		MappedColumnStore::clear();
 }
 
 void DatabaseInterface::_runStatements(const std::string & statements, bindParametersType * bindParameters, std::function<void(size_t row, sqlite3_stmt *stmt)> * processRow)
@@ -1575,6 +1992,72 @@ void DatabaseInterface::_runStatementsRepeatedly(const std::string & statements,
 	}
 }
 
+sqlite3_stmt * DatabaseInterface::_preparedStatement(const std::string & statement)
+{
+	JASPTIMER_SCOPE(DatabaseInterface::_preparedStatement);
+
+	auto cached = _preparedStatements.find(statement);
+
+	if(cached != _preparedStatements.end())
+	{
+		cached->second.lastUse = ++_preparedStatementUses;
+
+		sqlite3_reset(			cached->second.stmt);
+		sqlite3_clear_bindings(	cached->second.stmt);
+		return cached->second.stmt;
+	}
+
+	//Statements built for specific columns or row counts would otherwise pile up, so whatever was not used for the longest time makes room
+	if(_preparedStatements.size() >= _preparedStatementsKept)
+	{
+		auto leastRecent = std::min_element(_preparedStatements.begin(), _preparedStatements.end(), [](const auto & l, const auto & r) { return l.second.lastUse < r.second.lastUse; });
+
+		sqlite3_finalize(leastRecent->second.stmt);
+		_preparedStatements.erase(leastRecent);
+	}
+
+	sqlite3_stmt * dbStmt = nullptr;
+
+	if(sqlite3_prepare_v2(_db, statement.c_str(), statement.size(), &dbStmt, nullptr) != SQLITE_OK || !dbStmt)
+	{
+		std::string errorMsg = "A problem occured trying to prepare statement `" + statement + "` and the error was: : `" + sqlite3_errmsg(_db);
+		Log::log() << errorMsg << std::endl;
+		sqlite3_finalize(dbStmt);
+		throw std::runtime_error(errorMsg);
+	}
+
+	_preparedStatements[statement] = { dbStmt, ++_preparedStatementUses };
+
+	return dbStmt;
+}
+
+void DatabaseInterface::_preparedStatementRun(sqlite3_stmt * dbStmt, const std::string & statement)
+{
+	int ret;
+
+	do		ret = sqlite3_step(dbStmt);
+	while(	ret == SQLITE_BUSY || ret == SQLITE_ROW);
+
+	sqlite3_reset(dbStmt);
+
+	if(ret != SQLITE_DONE)
+	{
+		std::string errorMsg = ret == SQLITE_READONLY
+			? "Running ```\n"+statement+"\n``` failed because the database is readonly..."
+			: "Running ```\n"+statement+"\n``` failed because of: `" + sqlite3_errmsg(_db);
+		Log::log() << errorMsg << std::endl;
+		throw std::runtime_error(errorMsg);
+	}
+}
+
+void DatabaseInterface::_preparedStatementsClear()
+{
+	for(auto & statementStmt : _preparedStatements)
+		sqlite3_finalize(statementStmt.second.stmt);
+
+	_preparedStatements.clear();
+}
+
 void DatabaseInterface::create()
 {
 	JASPTIMER_SCOPE(DatabaseInterface::create);
@@ -1599,7 +2082,11 @@ void DatabaseInterface::create()
 
 	transactionWriteBegin();
 	runStatements(_dbConstructionSql);
+	runStatements(_dbValueChangesSql);
 	transactionWriteEnd();
+
+	if(!_isEngine) //Column ids start from scratch so whatever is still in the store is stale
+		MappedColumnStore::clear();
 }
 
 void DatabaseInterface::load()
@@ -1620,6 +2107,16 @@ void DatabaseInterface::load()
 	else
 		Log::log() << "Opened internal sqlite database for loading at '" << dbFile() << "'." << std::endl;
 
+	if(!_isEngine)
+	{
+		MappedColumnStore::clear();
+
+		//Whatever changes were logged in the jaspfile are meaningless now, engines load everything from scratch anyway
+		transactionWriteBegin();
+		runStatements(_dbValueChangesSql);
+		runStatements("DELETE FROM ColumnValueChanges;");
+		transactionWriteEnd();
+	}
 }
 
 void DatabaseInterface::close()
@@ -1627,6 +2124,7 @@ void DatabaseInterface::close()
 	JASPTIMER_SCOPE(DatabaseInterface::);
 	if(_db)
 	{
+		_preparedStatementsClear();
 		sqlite3_close(_db);
 		_db = nullptr;
 	}
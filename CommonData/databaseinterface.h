@@ -44,6 +44,10 @@ class DatabaseInterface;
 /// As each side (Desktop and Engine) both have datastructures that map to these tables,
 /// they also have a "revision" field and so they can, and do, regurlarly check for it to synchronise
 /// their loaded data.
+///
+/// Every value set through columnSetValue is also written to ColumnValueChanges, tagged with the revision of its column at that time.
+/// Bulk writes instead leave a marker (row -1) there, as does trimming the log to its last _valueChangesKept revisions.
+/// That way an engine can catch up on a few edited cells through columnGetValueChanges instead of reloading the entire column.
 /// 
 /// General table structure (an example with a single dataset and support for a single filter
 /// 
@@ -63,6 +67,8 @@ public:
 	static		DatabaseInterface * singleton() { return _singleton; }					///< There can be only one! https://www.youtube.com/watch?v=sqcLjcSloXs
 
 	bool		hasConnection() { return _db; }
+	bool		valuesMapped() const;													///< Whether the values of the columns are kept in MappedColumnStore instead of DataSet_#
+	void		setValuesMapped(bool mapped);											///< Only for Desktop and only before any data is loaded, the engines follow automatically
 	void		upgradeDBFromVersion(Version originalVersion);							///< Ensures that the database has all the fields configured as required for the current JASP version, useful when loading older sqlite-containing jasp-files
 
 	void		runQuery(		const std::string & query,		std::function<void(sqlite3_stmt *stmt)>		bindParameters,				std::function<void(size_t row, sqlite3_stmt *stmt)>		processRow);	///< Runs a single query and then goes through the resultrows while calling processRow for each.
@@ -88,7 +94,7 @@ public:
 	int			dataSetGetFilter(		int dataSetId);
 	void		dataSetInsertEmptyRow(	int dataSetId, size_t row);
 
-	void		dataSetBatchedValuesUpdate(DataSet * data, std::function<void(float)> progressCallback = [](float){});
+	void		dataSetBatchedValuesUpdate(DataSet * data, std::function<void(float)> progressCallback = [](float){});	///< Writes the values changed during a batch, only the dirty columns (and filter) if the rowcount is unchanged, otherwise the entire DataSet_# is rewritten with multirow INSERTs
 
 	//Filters
 	std::string filterName(				int filterIndex) const;
@@ -123,22 +129,28 @@ public:
 	void		columnDelete(				int columnId, bool cleanUpRest = true);			///< Also makes sure indices stay as contiguous and correct as before. disable cleanUpRest to just clear from Columns
 	void		columnSetType(				int columnId, columnType colType);
 	void		columnSetInvalidated(		int columnId, bool invalidated);
+	void		columnSetFingerprint(		int columnId, uint64_t fingerprint);					///< Stores the fingerprint of the values the column was last imported from, see Column::fingerprint
 	void		columnSetName(				int columnId, const std::string & name);
 	void		columnSetTitle(				int columnId, const std::string & title);
 	void		columnSetDescription(		int columnId, const std::string & description);
-	void		columnGetBasicInfo(			int columnId,		std::string & name, std::string & title, std::string & description, columnType & colType, int & revision);
+	void		columnGetBasicInfo(			int columnId,		std::string & name, std::string & title, std::string & description, columnType & colType, int & revision, uint64_t & fingerprint);
 	void		columnSetComputedInfo(		int columnId, int analysisId, bool isComputed, bool   invalidated, computedColumnType   codeType, const	std::string & rCode, const	std::string & error, const	std::string & constructorJson);
 	bool		columnGetComputedInfo(		int columnId, int &analysisId, bool & invalidated, computedColumnType & codeType,		std::string & rCode,		std::string & error,		Json::Value & constructorJson);
 	void		columnSetValues(			int columnId, const intvec	  & ints);
 	void		columnSetValues(			int columnId, const doublevec & dbls);
 	void		columnSetValue(				int columnId, size_t row, int value);
 	void		columnSetValue(				int columnId, size_t row, double value);
+	void		columnSetValuesFrom(		int columnId, size_t firstRow, const intvec		& ints);	///< Writes the rows from firstRow onwards, cell by cell so engines can catch up through ColumnValueChanges, unless there are too many of them or the values are mapped
+	void		columnSetValuesFrom(		int columnId, size_t firstRow, const doublevec	& dbls);
+	bool		columnGetValueChanges(		int columnId, int sinceRevision, std::vector<std::pair<size_t, double>> & changes);	///< Fills changes with the cells written since sinceRevision in order, returns false if the values were (or might have been) changed in bulk and should be reloaded entirely
 	intvec		columnGetLabelIds(			int columnId);
 	size_t		columnGetLabelCount(		int columnId);
 	void		columnGetValuesInts(		int columnId,	intvec		& ints);
 	void		columnGetValuesDbls(		int columnId,	doublevec	& dbls);
 	std::string columnBaseName(				int columnId) const;
-	void		dataSetBatchedValuesLoad(	DataSet * data, std::function<void(float)> progressCallback = [](float){});
+	void		dataSetBatchedValuesLoad(		DataSet * data, std::function<void(float)> progressCallback = [](float){});	///< Loads all values of all columns and the filter columnwise, straight into the buffers of Column and in groups of _columnarLoadGroupSize columns per statement
+	bool		columnMapValues(			Column * column);															///< Engine only: maps the values of column read-only from MappedColumnStore, returns false if that is not possible and they should be loaded from DataSet_#
+	void		dataSetWriteMappedValuesToDB(DataSet * data);															///< Copies the values from MappedColumnStore into DataSet_# so that the sqlite file can be stored in a jaspfile
 
 	//Labels
 	void		labelsClear(			int columnId);
@@ -160,6 +172,15 @@ public:
 private:
 	void		_doubleTroubleBinder(sqlite3_stmt *stmt, int param, double dbl);	///< Needed to work around the lack of support for NAN, INF and NEG_INF in sqlite, converts those to string to make use of sqlite flexibility
 	double		_doubleTroubleReader(sqlite3_stmt *stmt, int colI);					///< The reading counterpart to _doubleTroubleBinder to convert string representations of NAN, INF and NEG_INF back to double
+	void		_logLoadSpeed(const char * loader, DataSet * data, long startMs);	///< Logs rows/s for dataSetBatchedValuesLoad when PROFILE_JASP is defined
+	void		_dataSetBatchedValuesRewrite(	DataSet * data, std::function<void(float)> progressCallback, bool withValues = true);	///< Clears DataSet_# and inserts all rows again, as many per statement as SQLITE_LIMIT_VARIABLE_NUMBER allows. Without values only the filter and rownumbers are inserted.
+	void		_dataSetBatchedValuesDirty(		DataSet * data, std::function<void(float)> progressCallback);	///< Only UPDATEs the columns (and filter) that are marked as batchedDirty
+	void		_columnLogValueChange(			int columnId, size_t row, double value);	///< Adds the change to ColumnValueChanges and trims what is too old to be of use
+	void		_columnLogValuesReset(			int columnId);								///< Adds a marker to ColumnValueChanges that anything before it is unusable
+
+	sqlite3_stmt *	_preparedStatement(			const std::string & statement);						///< Gets a prepared statement from _preparedStatements or prepares and stores it there. It is reset and its bindings cleared so it is ready for use, but only until _preparedStatementsKept other statements were asked for.
+	void			_preparedStatementRun(		sqlite3_stmt * stmt, const std::string & statement);	///< Steps the (cached) statement until done, throwing on errors, and resets it afterwards. Any resulting rows are ignored.
+	void			_preparedStatementsClear();														///< Finalizes all cached statements, must be called whenever the schema loses a table or column they might refer to
 	void		_runStatements(				const std::string & statements,						std::function<void(sqlite3_stmt *stmt)> *	bindParameters = nullptr,	std::function<void(size_t row, sqlite3_stmt *stmt)> *	processRow = nullptr);	///< Runs several sql statements without looking at the results. Unless processRow is not NULL, then this is called for each row.
 	void		_runStatementsRepeatedly(	const std::string & statements, std::function<bool(	std::function<void(sqlite3_stmt *stmt)> **	bindParameters, size_t row)> bindParameterFactory, std::function<void(size_t row, size_t repetition, sqlite3_stmt *stmt)> * processRow = nullptr);
 
@@ -169,11 +190,26 @@ private:
 
 	int			_transactionWriteDepth	= 0,
 				_transactionReadDepth	= 0;
+	bool		_isEngine				= false;	///< Engines do not own the database, so they never clear MappedColumnStore and they map its values read-only
+	bool		_valuesMapped			= false;	///< Only meaningful for Desktop, the engines check MappedColumnStore::enabledForSession
 
 	sqlite3	*	_db = nullptr;
 
+	struct PreparedStatement
+	{
+		sqlite3_stmt	*	stmt	= nullptr;
+		size_t				lastUse	= 0;
+	};
+
+	std::map<std::string, PreparedStatement>	_preparedStatements;		///< Cache of prepared statements keyed by their sql, see _preparedStatement
+	size_t										_preparedStatementUses	= 0;
+
 	static			std::string _wrap_sqlite3_column_text(sqlite3_stmt * stmt, int iCol);
 	static const	std::string _dbConstructionSql;
+	static const	size_t		_columnarLoadGroupSize;		///< How many columns dataSetBatchedValuesLoad reads per statement, sqlite refuses more than SQLITE_MAX_COLUMN (default 2000) per resultset
+	static const	std::string _dbValueChangesSql;			///< Kept apart from _dbConstructionSql because it is also run when loading a jaspfile that predates ColumnValueChanges
+	static const	int			_valueChangesKept;			///< How many revisions per column ColumnValueChanges goes back, an engine further behind than that reloads the column
+	static const	size_t		_preparedStatementsKept;	///< At most this many statements stay in _preparedStatements, the least recently used one is finalized to make room
 
 
 	static DatabaseInterface * _singleton;
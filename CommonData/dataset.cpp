@@ -57,6 +57,12 @@ void DataSet::beginBatchedToDB()
 {
 	assert(!_writeBatchedToDB);
 	_writeBatchedToDB = true;
+
+	for(Column * col : _columns)
+		col->setBatchedDirty(false);
+
+	if(_filter)
+		_filter->setBatchedDirty(false);
 }
 
 void DataSet::endBatchedToDB(std::function<void(float)> progressCallback)
@@ -65,6 +71,12 @@ void DataSet::endBatchedToDB(std::function<void(float)> progressCallback)
 	_writeBatchedToDB = false;
 
 	db().dataSetBatchedValuesUpdate(this, progressCallback);
+
+	for(Column * col : _columns)
+		col->setBatchedDirty(false);
+
+	_filter->setBatchedDirty(false);
+
 	incRevision(); //Should trigger reload at engine end
 }
 
@@ -175,14 +187,7 @@ size_t DataSet::getMaximumColumnWidthInCharacters(size_t columnIndex) const
 		return 0;
 
 	default:
-	{
-		int tempVal = 0;
-
-		for(Label * label : col->labels())
-			tempVal = std::max(tempVal, static_cast<int>(label->label(true).length()));
-
-		return tempVal + extraPad;
-	}
+		return col->labelsMaxDisplayLength() + extraPad;
 	}
 
 }
@@ -322,6 +327,25 @@ void DataSet::setRowCount(size_t rowCount)
 	_filter->reset();
 }
 
+void DataSet::appendEmptyRows(size_t count)
+{
+	JASPTIMER_SCOPE(DataSet::appendEmptyRows);
+
+	assert(!writeBatchedToDB());
+
+	db().transactionWriteBegin();
+
+	_rowCount += count;
+	db().dataSetSetRowCount(_dataSetID, _rowCount);
+
+	for(Column * column : _columns)
+		column->appendEmptyRows(count);
+
+	_filter->reset();
+
+	db().transactionWriteEnd();
+}
+
 void DataSet::incRevision()
 {
 	assert(_dataSetID != -1);
@@ -353,7 +377,12 @@ bool DataSet::checkForUpdates(stringvec * colsChanged)
 	}
 	else
 	{
-		bool somethingChanged = _filter->checkForUpdates();
+		//appendEmptyRows does not change the revision of the dataset, the columns catch up on the new rows themselves
+		const int rowCount		= db().dataSetRowCount(_dataSetID);
+		bool somethingChanged	= rowCount != _rowCount;
+		_rowCount				= rowCount;
+
+		somethingChanged		= _filter->checkForUpdates() || somethingChanged;
 
 		for(Column * col : _columns)
 			if(col->checkForUpdates())
@@ -60,6 +60,7 @@ public:
 
 			void			setColumnCount(	size_t colCount);
 			void			setRowCount(	size_t rowCount);
+			void			appendEmptyRows(size_t count);	///< Unlike setRowCount this keeps the values already loaded and leaves the revision alone, so the engines only load the new rows
 
 			void			incRevision() override;
 			bool			checkForUpdates(stringvec * colsChanged = nullptr);
@@ -79,8 +79,8 @@ bool Filter::setFilterVector(const boolvec & filterResult)
 
 	_filteredRowCount = 0;
 
-	if(!_data->writeBatchedToDB())
-		db().filterWrite(_id, _filtered);
+	if(!_data->writeBatchedToDB())	db().filterWrite(_id, _filtered);
+	else							_batchedDirty = true;
 
 	for(bool row : _filtered)
 		if(row)
@@ -100,6 +100,7 @@ void Filter::setFilterValueNoDB(size_t row, bool val)
 void Filter::setRowCount(size_t rows)
 {
 	_filtered.resize(rows);
+	_batchedDirty = _batchedDirty || _data->writeBatchedToDB();
 }
 
 bool Filter::dbLoadResultAndError()
@@ -159,8 +160,8 @@ bool Filter::checkForUpdates()
 
 void Filter::reset()
 {
-	if(!_data->writeBatchedToDB())
-		db().filterClear(_id);
+	if(!_data->writeBatchedToDB())	db().filterClear(_id);
+	else							_batchedDirty = true;
 
 	incRevision();
 	_filtered = boolvec(_data->rowCount(), true);
@@ -32,6 +32,7 @@ public:
 	const std::string		&	errorMsg()			const { return _errorMsg;				}
 	const std::vector<bool>	&	filtered()			const { return _filtered;				}
 	int							filteredRowCount()	const { return _filteredRowCount;		}
+	bool						batchedDirty()		const { return _batchedDirty;			} ///< Whether the values changed since DataSet::beginBatchedToDB
 
 	void				setRFilter(			const std::string	& rFilter)			{ _rFilter			= rFilter;			dbUpdate(); }
 	void				setGeneratedFilter(	const std::string	& generatedFilter)	{ _generatedFilter	= generatedFilter;	dbUpdate(); }
@@ -42,6 +43,7 @@ public:
 	void				setFilterValueNoDB(	size_t	row, bool val);
 	void				setRowCount(		size_t	rows);
 	void				setId(				int		id)			{ _id = id; }
+	void				setBatchedDirty(	bool	dirty)		{ _batchedDirty = dirty; }
 
 	void				dbCreate();
 	void				dbUpdate();
@@ -67,6 +69,7 @@ private:
 							_constructorR		= "",
 							_errorMsg			= "";
 	std::vector<bool>		_filtered;
+	bool					_batchedDirty		= false;
 };
 
 #endif // FILTER_H
@@ -0,0 +1,324 @@
+#include "filterexpression.h"
+#include "dataset.h"
+#include "column.h"
+#include "columnutils.h"
+#include "timers.h"
+#include <algorithm>
+#include <thread>
+#include <cmath>
+#include <limits>
+#include <map>
+
+//The result of a node for a single row, like the logical values of R
+static const char	FALSE_	= 0,
+					TRUE_	= 1,
+					NA_		= 2;
+
+static const size_t	BLOCK_ROWS			= 4096,			///< Rows evaluated in one go by each node, small enough for the intermediate results to stay in cache
+					MIN_ROWS_PER_THREAD	= 256 * 1024;	///< Below this the threads aren't worth starting
+
+FilterExpression::~FilterExpression()
+{
+	for(FilterExpression * child : _children)
+		delete child;
+}
+
+FilterExpression * FilterExpression::fromDataSet(DataSet * data, const std::string & constructorJson)
+{
+	JASPTIMER_SCOPE(FilterExpression::fromDataSet);
+
+	Json::Value constructor;
+
+	if(!data || !Json::Reader().parse(constructorJson, constructor) || !constructor.isObject())
+		return nullptr;
+
+	const Json::Value & formulas = constructor["formulas"];
+
+	if(!formulas.isNull() && !formulas.isArray())
+		return nullptr;
+
+	FilterExpression * all = new FilterExpression(Kind::conjunction);
+
+	for(const Column * column : data->columns())
+		if(column->hasFilter())
+			all->_children.push_back(labelsNode(column, [](const Label * label) { return label->filterAllows(); }));
+
+	//The constructor joins its formulas with "&"
+	for(const Json::Value & formula : formulas)
+	{
+		FilterExpression * node = fromFormula(data, formula);
+
+		if(!node)
+		{
+			delete all;
+			return nullptr;
+		}
+
+		all->_children.push_back(node);
+	}
+
+	return all;
+}
+
+FilterExpression * FilterExpression::fromFormula(DataSet * data, const Json::Value & formula)
+{
+	if(!formula.isObject())
+		return nullptr;
+
+	const std::string nodeType = formula.get("nodeType", "").asString();
+
+	if(nodeType == "Operator" || nodeType == "OperatorVertical")
+	{
+		const std::string	op		= formula.get("operator", "").asString();
+		const Json::Value &	left	= formula["leftArgument"],
+						 &	right	= formula["rightArgument"];
+
+		if(op == "&" || op == "|")
+		{
+			FilterExpression	*	combined	= new FilterExpression(op == "&" ? Kind::conjunction : Kind::disjunction),
+								*	leftNode	= fromFormula(data, left),
+								*	rightNode	= leftNode ? fromFormula(data, right) : nullptr;
+
+			if(leftNode)	combined->_children.push_back(leftNode);
+			if(rightNode)	combined->_children.push_back(rightNode);
+
+			if(!rightNode)
+			{
+				delete combined;
+				return nullptr;
+			}
+
+			return combined;
+		}
+
+		return fromComparison(data, op, left, right);
+	}
+
+	if(nodeType == "Function" && formula.get("functionName", "").asString() == "!")
+	{
+		const Json::Value & arguments = formula["arguments"];
+
+		if(!arguments.isArray() || arguments.size() != 1)
+			return nullptr;
+
+		FilterExpression * negated = fromFormula(data, arguments[0]["argument"]);
+
+		if(!negated)
+			return nullptr;
+
+		FilterExpression * negation = new FilterExpression(Kind::negation);
+		negation->_children.push_back(negated);
+
+		return negation;
+	}
+
+	return nullptr;
+}
+
+FilterExpression * FilterExpression::fromComparison(DataSet * data, const std::string & op, const Json::Value & left, const Json::Value & right)
+{
+	static const std::map<std::string, std::string> flipped = { {"==", "=="}, {"!=", "!="}, {"<", ">"}, {"<=", ">="}, {">", "<"}, {">=", "<="} };
+
+	if(!flipped.count(op) || !left.isObject() || !right.isObject())
+		return nullptr;
+
+	//Make sure the column is on the left
+	if(left.get("nodeType", "").asString() != "Column")
+		return right.get("nodeType", "").asString() == "Column" ? fromComparison(data, flipped.at(op), right, left) : nullptr;
+
+	const Column		*	column		= data->column(left.get("columnName", "").asString());
+	const std::string		otherType	= right.get("nodeType", "").asString();
+
+	if(!column)
+		return nullptr;
+
+	if(column->type() == columnType::scale && otherType == "Number")
+	{
+		const Json::Value	&	value	= right["value"];
+		double					number;
+
+		if		(value.isNumeric())																number = value.asDouble();
+		else if	(!value.isString() || !ColumnUtils::getDoubleValue(value.asString(), number))	return nullptr;
+
+		return rangeNode(column, op, number);
+	}
+
+	if(column->type() != columnType::scale && otherType == "String" && (op == "==" || op == "!="))
+	{
+		const std::string	text	= right.get("text", "").asString();
+		const bool			equal	= op == "==";
+
+		return labelsNode(column, [text, equal](const Label * label) { return (label->label() == text) == equal; });
+	}
+
+	return nullptr;
+}
+
+FilterExpression * FilterExpression::labelsNode(const Column * column, LabelAllows allows)
+{
+	FilterExpression * node = new FilterExpression(Kind::labels);
+	node->_column = column;
+
+	//Values without a label are missing and thus NA
+	for(const Label * label : column->labels())
+		node->_valueResults.push_back(std::make_pair(label->value(), allows(label) ? TRUE_ : FALSE_));
+
+	std::sort(node->_valueResults.begin(), node->_valueResults.end());
+
+	if(node->_valueResults.empty())
+		return node;
+
+	const int64_t	lowest	= node->_valueResults.front().first,
+					span	= node->_valueResults.back().first - lowest + 1;
+
+	if(span <= int64_t(4 * node->_valueResults.size() + 1024))
+	{
+		node->_valueTableMin = lowest;
+		node->_valueTable.assign(span, NA_);
+
+		for(const auto & valueResult : node->_valueResults)
+			node->_valueTable[valueResult.first - lowest] = valueResult.second;
+
+		node->_valueResults.clear();
+	}
+
+	return node;
+}
+
+FilterExpression * FilterExpression::rangeNode(const Column * column, const std::string & op, double number)
+{
+	const double infinity = std::numeric_limits<double>::infinity();
+
+	FilterExpression * node = new FilterExpression(Kind::range);
+	node->_column	= column;
+	node->_min		= -infinity;
+	node->_max		= infinity;
+
+	if		(op == "<" || op == "<=")	{ node->_max = number; node->_maxInclusive = op == "<=";	}
+	else if	(op == ">" || op == ">=")	{ node->_min = number; node->_minInclusive = op == ">=";	}
+	else								{ node->_min = node->_max = number;							}
+
+	if(op != "!=")
+		return node;
+
+	FilterExpression * negation = new FilterExpression(Kind::negation);
+	negation->_children.push_back(node);
+
+	return negation;
+}
+
+boolvec FilterExpression::evaluate(size_t rowCount) const
+{
+	JASPTIMER_SCOPE(FilterExpression::evaluate);
+
+	std::vector<char>	results(rowCount);
+	const size_t		threadCount	= std::max(size_t(1), std::min(size_t(std::thread::hardware_concurrency()), rowCount / MIN_ROWS_PER_THREAD)),
+						rowsPerThread	= (rowCount + threadCount - 1) / threadCount;
+
+	auto evaluateRows = [&](size_t first, size_t last)
+	{
+		for(size_t row = first; row < last; row += BLOCK_ROWS)
+			evaluateBlock(row, std::min(BLOCK_ROWS, last - row), results.data() + row);
+	};
+
+	if(threadCount == 1)
+		evaluateRows(0, rowCount);
+	else
+	{
+		//Each thread gets its own contiguous part of results, so they never touch the same cacheline except at the edges
+		std::vector<std::thread> evaluators;
+
+		for(size_t first = 0; first < rowCount; first += rowsPerThread)
+			evaluators.emplace_back(evaluateRows, first, std::min(rowCount, first + rowsPerThread));
+
+		for(std::thread & evaluator : evaluators)
+			evaluator.join();
+	}
+
+	//NA doesn't pass, just like in R
+	boolvec passes(rowCount);
+
+	for(size_t row=0; row<rowCount; row++)
+		passes[row] = results[row] == TRUE_;
+
+	return passes;
+}
+
+void FilterExpression::evaluateBlock(size_t firstRow, size_t rowCount, char * out) const
+{
+	switch(_kind)
+	{
+	case Kind::labels:
+	{
+		const intspan	values		= _column->ints();
+		const size_t	available	= firstRow < values.size() ? std::min(rowCount, values.size() - firstRow) : 0;
+
+		for(size_t i=0; i<available; i++)
+		{
+			const int value = values[firstRow + i];
+
+			if(!_valueTable.empty())
+			{
+				const int64_t index = int64_t(value) - _valueTableMin;
+				out[i] = index >= 0 && index < int64_t(_valueTable.size()) ? _valueTable[index] : NA_;
+			}
+			else
+			{
+				auto found = std::lower_bound(_valueResults.begin(), _valueResults.end(), value, [](const std::pair<int, char> & valueResult, int value) { return valueResult.first < value; });
+				out[i] = found != _valueResults.end() && found->first == value ? found->second : NA_;
+			}
+		}
+
+		std::fill(out + available, out + rowCount, NA_);
+		break;
+	}
+
+	case Kind::range:
+	{
+		const doublespan	values		= _column->dbls();
+		const size_t		available	= firstRow < values.size() ? std::min(rowCount, values.size() - firstRow) : 0;
+
+		for(size_t i=0; i<available; i++)
+		{
+			const double value = values[firstRow + i];
+
+			if(std::isnan(value))
+				out[i] = NA_;
+			else
+				out[i] =	(_minInclusive ? value >= _min : value > _min) &&
+							(_maxInclusive ? value <= _max : value < _max)		? TRUE_ : FALSE_;
+		}
+
+		std::fill(out + available, out + rowCount, NA_);
+		break;
+	}
+
+	case Kind::negation:
+		_children[0]->evaluateBlock(firstRow, rowCount, out);
+
+		for(size_t i=0; i<rowCount; i++)
+			if(out[i] != NA_)
+				out[i] = out[i] == TRUE_ ? FALSE_ : TRUE_;
+		break;
+
+	case Kind::conjunction:
+	case Kind::disjunction:
+	{
+		//An empty conjunction lets everything through, like the default generated filter
+		const char	dominant	= _kind == Kind::conjunction ? FALSE_ : TRUE_;
+		std::fill(out, out + rowCount, _kind == Kind::conjunction ? TRUE_ : FALSE_);
+
+		std::vector<char> childOut(rowCount);
+
+		for(const FilterExpression * child : _children)
+		{
+			child->evaluateBlock(firstRow, rowCount, childOut.data());
+
+			for(size_t i=0; i<rowCount; i++)
+				if(out[i] != dominant && childOut[i] != out[i])
+					out[i] = childOut[i] == dominant ? dominant : NA_;
+		}
+		break;
+	}
+	}
+}
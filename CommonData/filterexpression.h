@@ -0,0 +1,64 @@
+#ifndef FILTEREXPRESSION_H
+#define FILTEREXPRESSION_H
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <json/json.h>
+#include "utils.h"
+
+class DataSet;
+class Column;
+class Label;
+
+/// An expression tree of the filter built from the label checkboxes and the filter constructor, that can be evaluated directly over the values of the columns
+///
+/// The generated filter would otherwise go to R as `(col == "a" | col == "b") & (...)` and back again, which takes seconds on large data.
+/// FilterExpression::fromDataSet only accepts what it can evaluate exactly as R would, meaning:
+///  - the labels of non-scale columns that are not allowed by the label filter
+///  - `&`, `|` and `!` from the constructor
+///  - `==`, `!=`, `<`, `<=`, `>`, `>=` between a scale column and a number
+///  - `==`, `!=` between a non-scale column and a string, comparing with the labels as R compares a factor
+/// For anything else it returns nullptr and the filter must be run by R.
+///
+/// Like in R each node is either true, false or NA, a row only passes if the whole filter is true.
+/// NA comes from missing values, either a value without a label or a NaN in a scale column.
+class FilterExpression
+{
+public:
+	enum class Kind { labels, range, conjunction, disjunction, negation };
+
+								~FilterExpression();
+
+	static FilterExpression	*	fromDataSet(DataSet * data, const std::string & constructorJson);	///< Combines the label filters and the constructor into one expression, nullptr if any part needs R
+
+	boolvec						evaluate(size_t rowCount) const;									///< Whether each row passes the filter, spread over multiple threads for large data
+
+	Kind						kind() const { return _kind; }
+
+private:
+	typedef std::function<bool(const Label * label)> LabelAllows;
+
+								FilterExpression(Kind kind) : _kind(kind) {}
+
+	static FilterExpression	*	fromFormula(	DataSet * data, const Json::Value & formula);
+	static FilterExpression	*	fromComparison(	DataSet * data, const std::string & op, const Json::Value & left, const Json::Value & right);
+	static FilterExpression	*	labelsNode(		const Column * column, LabelAllows allows);
+	static FilterExpression	*	rangeNode(		const Column * column, const std::string & op, double number);
+
+	void						evaluateBlock(size_t firstRow, size_t rowCount, char * out) const;
+
+	Kind								_kind;
+	std::vector<FilterExpression*>		_children;						///< For conjunction, disjunction and negation
+
+	const Column					*	_column			= nullptr;		///< For labels and range
+	std::vector<char>					_valueTable;					///< labels: result per value starting at _valueTableMin, when the values are close enough together
+	int									_valueTableMin	= 0;
+	std::vector<std::pair<int, char>>	_valueResults;					///< labels: result per value sorted on value, when they aren't
+	double								_min			= 0,			///< range: the passing values of a scale column
+										_max			= 0;
+	bool								_minInclusive	= true,
+										_maxInclusive	= true;
+};
+
+#endif // FILTEREXPRESSION_H
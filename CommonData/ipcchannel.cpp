@@ -39,6 +39,9 @@ using namespace std;
 using namespace boost;
 using namespace boost::posix_time;
 
+const size_t IPCChannel::_chunkSize		= 1024 * 1024 * 4; //Half of the initial size of the memory, so a chunk always fits
+const long	 IPCChannel::_chunkTimeout	= 30000;
+
 IPCChannel::IPCChannel(std::string name, size_t channelNumber, bool isSlave)
 	:
 	  _baseName(		name + "_" + std::to_string(channelNumber)	),
@@ -134,6 +137,11 @@ IPCChannel::IPCChannel(std::string name, size_t channelNumber, bool isSlave)
 			if(foundDataIn.first == nullptr)	throw std::runtime_error("Couldn't find data in for IPCChannel...");
 			if(foundDataOut.first == nullptr)	throw std::runtime_error("Couldn't find data out for IPCChannel...");
 
+			_chunkIn	= _memoryIn ->find<ChunkState>(_chunkInName.c_str()).first;
+			_chunkOut	= _memoryOut->find<ChunkState>(_chunkOutName.c_str()).first;
+
+			if(!_chunkIn  || !_chunkOut)		throw std::runtime_error("Couldn't find chunk states for IPCChannel...");
+
 			_dataIn	 = foundDataIn.first;  //It could actually be an array, but of course, this would just take the first one and we ignore the rest.
 			_dataOut = foundDataOut.first;
 
@@ -217,6 +225,9 @@ void IPCChannel::findConstructDataStrings()
 
 	Log::log() << "Creating " << _dataOutName << std::endl;
 	_dataOut	= _memoryOut->find_or_construct<String>(_dataOutName.c_str())	(_memoryOut->get_segment_manager());
+
+	_chunkIn	= _memoryIn ->find_or_construct<ChunkState>(_chunkInName.c_str())		();
+	_chunkOut	= _memoryOut->find_or_construct<ChunkState>(_chunkOutName.c_str())		();
 }
 
 void IPCChannel::findConstructAllAgain()
@@ -304,6 +315,8 @@ void IPCChannel::generateNames()
 	_mutexInName		= mutexInName.str();
 	_dataOutName		= dataOutName.str();
 	_dataInName			= dataInName.str();
+	_chunkOutName		= _dataOutName + "c";
+	_chunkInName		= _dataInName  + "c";
 }
 
 void IPCChannel::rebindMemoryInIfSizeChanged()
@@ -319,7 +332,8 @@ void IPCChannel::rebindMemoryInIfSizeChanged()
 		if(_isSlave)	_memoryMasterToSlave	= _memoryIn;
 		else			_memorySlaveToMaster	= _memoryIn;
 
-		_dataIn = _memoryIn->find<String>(_dataInName.c_str()).first;
+		_dataIn		= _memoryIn->find<String>(_dataInName.c_str()).first;
+		_chunkIn	= _memoryIn->find<ChunkState>(_chunkInName.c_str()).first;
 	}
 }
 
@@ -327,6 +341,7 @@ void IPCChannel::doubleMemoryOut()
 {
 	Log::log() << "IPCChannel::doubleMemoryOut is called and new memsize: ";
 
+	//Only send and sendChunked grow the memory, right before they assign to _dataOut, so whatever it held does not need to be kept
 	std::string memOutName = _isSlave ? _nameStM : _nameMtS;
 
 	_memoryOut->destroy<String>(_dataOutName.c_str());
@@ -340,23 +355,31 @@ void IPCChannel::doubleMemoryOut()
 	else			_memoryMasterToSlave = _memoryOut;
 
 	_dataOut	= _memoryOut->construct<String>(_dataOutName.c_str())(_memoryOut->get_segment_manager());
+	_chunkOut	= _memoryOut->find<ChunkState>(_chunkOutName.c_str()).first;
 	*_sizeOut	= _memoryOut->get_size();
 
 	Log::log() << *_sizeOut << "\n" << std::flush;
 }
 
-void IPCChannel::send(string &&data, bool alreadyLockedMutex)
+bool IPCChannel::send(string &&data, bool alreadyLockedMutex)
 {
-	send(data, alreadyLockedMutex);
+	return send(data, alreadyLockedMutex);
 }
 
 
-void IPCChannel::send(string &data, bool alreadyLockedMutex)
+bool IPCChannel::send(string &data, bool alreadyLockedMutex)
 {
+	if(_isSlave && !alreadyLockedMutex && data.size() > _chunkSize)
+		return sendChunked(data);
+
 	try
 	{
 		if(!alreadyLockedMutex)
 			_mutexOut->lock();
+
+		_chunkOut->total	= 0;
+		_chunkOut->consumed	= false;
+
 		_dataOut->assign(data.begin(), data.end());
 	}
 	catch (boost::interprocess::bad_alloc &e)	{ goto retryAfterDoublingMemory; }
@@ -383,20 +406,83 @@ void IPCChannel::send(string &data, bool alreadyLockedMutex)
 
 
 	_mutexOut->unlock();
-	return; // return here to avoid going to retryAfterDoublingMemory
+	return true; // return here to avoid going to retryAfterDoublingMemory
 
 retryAfterDoublingMemory:
 		Log::log() << "IPCChannel::send out buffer is too small!\n" << std::flush;
 
 		doubleMemoryOut();
 
-		send(data, true); //try again!
+		return send(data, true); //try again!
 }
 
 bool IPCChannel::receive(string &data, int timeout)
 {
-	if (tryWait(timeout))
+	if(_isSlave)
+		return receiveMessage(data, timeout);
+
+	std::lock_guard<std::mutex> lock(_gatheredLock);
+
+	if(!_gatheredWaiting)
+		return false;
+
+	data				= std::move(_gathered);
+	_gatheredWaiting	= false;
+	_gathered.clear();
+
+	return true;
+}
+
+bool IPCChannel::gather(int timeout)
+{
 	{
+		std::lock_guard<std::mutex> lock(_gatheredLock);
+
+		if(_gatheredWaiting)
+			return true;
+	}
+
+	//Only the IPCChannelWaiter calls this on the master, and it waits until the previous message was handled.
+	std::string message;
+
+	if(!receiveMessage(message, timeout))
+		return false;
+
+	std::lock_guard<std::mutex> lock(_gatheredLock);
+
+	_gathered			= std::move(message);
+	_gatheredWaiting	= true;
+
+	return true;
+}
+
+void IPCChannel::abortGather()
+{
+	_gatherAborted = true;
+}
+
+void IPCChannel::resumeGather()
+{
+	_gatherAborted = false;
+}
+
+bool IPCChannel::receiveMessage(string &data, int timeout)
+{
+	if (!tryWait(timeout))
+		return false;
+
+	size_t	total		= 0;
+	bool	firstChunk	= true;
+
+	do
+	{
+		if(!firstChunk && !waitForChunk())
+		{
+			Log::log() << "IPCChannel::receive stopped waiting for the rest of a streamed message after " << data.size() << " of " << total << " bytes, dropping it." << std::endl;
+			data.clear();
+			return false;
+		}
+
 		_mutexIn->lock();
 
 		while (tryWait()); // clear it completely
@@ -404,7 +490,44 @@ bool IPCChannel::receive(string &data, int timeout)
 		try
 		{
 			rebindMemoryInIfSizeChanged();
-			data.assign(_dataIn->c_str(), _dataIn->size());
+
+			if(!firstChunk && (_chunkIn->consumed || _chunkIn->total != total || _chunkIn->offset != data.size()))
+			{
+				//The slave gave up on this message and took back its chunk
+				_mutexIn->unlock();
+				Log::log() << "IPCChannel::receive got something else than the next chunk of a streamed message after " << data.size() << " of " << total << " bytes, dropping it." << std::endl;
+				data.clear();
+				return false;
+			}
+
+			total = _chunkIn->total;
+
+			if(firstChunk && _chunkIn->consumed)
+			{
+				//Whoever woke us up (a waiter thread putting it back for instance) was late, this message was already taken
+				_mutexIn->unlock();
+				return false;
+			}
+
+			if(firstChunk && total && _chunkIn->offset != 0)
+			{
+				//The rest of a message we already gave up on
+				_chunkIn->consumed = true;
+				_mutexIn->unlock();
+				data.clear();
+				return false;
+			}
+
+			if(firstChunk)
+			{
+				data.clear();
+
+				if(total)
+					data.reserve(total);
+			}
+
+			data.append(_dataIn->c_str(), _dataIn->size());
+			_chunkIn->consumed = true;
 		}
 		catch(std::exception & e)
 		{
@@ -414,12 +537,110 @@ bool IPCChannel::receive(string &data, int timeout)
 
 		_mutexIn->unlock();
 
-		return true;
+		if(total) //Lets sendChunked on the other side know it can put in the next chunk, instead of having it poll for that
+			postSemaphore(_semaphoreOut);
+
+		firstChunk = false;
 	}
+	while(total && data.size() < total);
+
+	return true;
+}
+
+bool IPCChannel::waitForChunk()
+{
+	const long start = Utils::currentMillis();
+
+	while(Utils::currentMillis() < start + _chunkTimeout && !_gatherAborted)
+		if(tryWait(100))
+			return true;
 
 	return false;
 }
 
+bool IPCChannel::sendChunked(const std::string & data)
+{
+	bool woken = false; //Whether we took a post of our semaphoreIn while waiting, it might have been meant for a message from the master instead
+
+	auto giveBackWake = [&]()
+	{
+		if(woken)
+			postSemaphore(_semaphoreIn); //receive copes with it if it was only the master taking a chunk
+	};
+
+	for(size_t offset = 0; offset < data.size(); offset += _chunkSize)
+	{
+		_mutexOut->lock();
+
+		for(bool assigned = false; !assigned; )
+			try
+			{
+				_dataOut->assign(data.begin() + offset, data.begin() + std::min(data.size(), offset + _chunkSize));
+				assigned = true;
+			}
+			catch (boost::interprocess::bad_alloc &)	{ doubleMemoryOut(); } //We still hold the mutex, just like send does when it grows the memory
+			catch (std::length_error &)					{ doubleMemoryOut(); }
+
+		//After the assign because doubleMemoryOut looks up _chunkOut again
+		_chunkOut->total	= data.size();
+		_chunkOut->offset	= offset;
+		_chunkOut->consumed	= false;
+
+		postSemaphore(_semaphoreOut);
+
+		_mutexOut->unlock();
+
+		//Backpressure: the next chunk only goes in once the master took this one, so the memory never needs to grow. The master posts our semaphoreIn when it did.
+		const long giveUpAt = Utils::currentMillis() + _chunkTimeout;
+
+		for(bool consumed = false; !consumed; )
+		{
+			_mutexOut->lock();
+			consumed = _chunkOut->consumed;
+
+			const long now = Utils::currentMillis();
+
+			if(!consumed && now > giveUpAt)
+			{
+				//The master stopped reading, so take the chunk back. That way it will not start on (or continue with) a message that never gets completed
+				_chunkOut->total	= 0;
+				_chunkOut->consumed	= true;
+				_dataOut->clear();
+				_mutexOut->unlock();
+
+				Log::log() << "IPCChannel::send gave up streaming a message of " << data.size() << " bytes after " << offset << " bytes, the master did not take the next chunk in time." << std::endl;
+
+				giveBackWake();
+				return false;
+			}
+
+			_mutexOut->unlock();
+
+			if(!consumed && tryWait(int(std::min(100L, giveUpAt - now + 1))))
+				woken = true;
+		}
+	}
+
+	giveBackWake();
+	return true;
+}
+
+#ifdef __APPLE__
+void IPCChannel::postSemaphore(sem_t * semaphore)
+{
+	sem_post(semaphore);
+}
+#elif defined _WIN32
+void IPCChannel::postSemaphore(HANDLE semaphore)
+{
+	ReleaseSemaphore(semaphore, 1, NULL);
+}
+#else
+void IPCChannel::postSemaphore(boost::interprocess::named_semaphore * semaphore)
+{
+	semaphore->post();
+}
+#endif
 
 bool IPCChannel::tryWait(int timeout)
 {
@@ -429,10 +650,10 @@ bool IPCChannel::tryWait(int timeout)
 
 	messageWaiting = sem_trywait(_semaphoreIn) == 0;
 
-	while (timeout > 0 && messageWaiting == false)
+	//There is no sem_timedwait on macOS, so poll but start fast to keep the latency of a message low and back off while nothing arrives
+	for(int slept = 0, sleep = 1; slept < timeout && !messageWaiting; slept += sleep, sleep = std::min(sleep * 2, 32))
 	{
-		usleep(100000);
-		timeout -= 10;
+		usleep(sleep * 1000);
 		messageWaiting = sem_trywait(_semaphoreIn) == 0;
 	}
 
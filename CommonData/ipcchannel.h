@@ -37,6 +37,8 @@
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/container/string.hpp>
 #include <functional>
+#include <mutex>
+#include <atomic>
 
 typedef boost::interprocess::allocator<char,	boost::interprocess::managed_shared_memory::segment_manager	> CharAllocator;
 typedef boost::container::basic_string<char,	std::char_traits<char>, CharAllocator						> String;
@@ -47,6 +49,11 @@ typedef boost::interprocess::allocator<String,	boost::interprocess::managed_shar
 /// Roughly a string guarded by a mutex to have a one way communication channel between Engine and Desktop
 /// This means that two of these are needed to have, well you guessed it, two way communication.
 /// It is created with a certain size but if it needs to grow (because of massive messages) it will double in size until it accomodates the message.
+/// That is only true for the master (Desktop) though, the slave (Engine) streams anything bigger than _chunkSize in chunks instead, waiting for the master to take each one.
+/// That way the memory of a channel stays the same size no matter how big the results get. The master never streams, because if both sides were waiting on the other to take a chunk they would wait forever.
+/// Both sides give up on a streamed message when the other side did not get to the next chunk within _chunkTimeout, a slave that gives up takes its chunk back so the master never starts on it.
+///
+/// On the master the chunks are gathered by gather, which IPCChannelWaiter calls from its own thread. receive then only hands over a complete message and never blocks.
 ///
 class IPCChannel
 {
@@ -56,16 +63,41 @@ public:
 
 	std::string lastSentMsg() const;
 
-	void send(std::string		&	data,	bool alreadyLockedMutex = false);
-	void send(std::string		&&	data,	bool alreadyLockedMutex = false);
-	bool receive(std::string	&	data,	int timeout = 0);
+	bool send(std::string		&	data,	bool alreadyLockedMutex = false);	///< Only returns false when streaming a message failed because the master did not take a chunk in time
+	bool send(std::string		&&	data,	bool alreadyLockedMutex = false);
+	bool receive(std::string	&	data,	int timeout = 0);					///< On the master this takes what gather got and ignores timeout
+	bool gather(int timeout = 0);											///< Master only: blocks until a complete message arrived, however many chunks that takes, and keeps it for receive. Returns true right away while the previous one wasn't taken yet
+	void abortGather();														///< Makes a gather that is waiting for the next chunk give up, so its thread can stop. Stays in effect until resumeGather
+	void resumeGather();
 
 	size_t channelNumber() { return _channelNumber; }
 
 	void findConstructAllAgain();
 
 private:
+	///Shared next to the data string, total is 0 for a normal message and otherwise the size of the full message that is being streamed in chunks
+	struct ChunkState
+	{
+		uint64_t	total		= 0,
+					offset		= 0;	///< Where in the full message the current chunk starts
+		bool		consumed	= true;	///< Set by the receiver once it took the message (or chunk), so that it never takes the same one twice
+	};
+
+	static const size_t	_chunkSize;
+	static const long	_chunkTimeout;	///< Milliseconds
+
+	bool receiveMessage(std::string & data, int timeout);
+	bool sendChunked(const std::string & data);
+	bool waitForChunk();
+
 	bool tryWait(int timeout = 0);
+#ifdef __APPLE__
+	void postSemaphore(sem_t * semaphore);
+#elif defined _WIN32
+	void postSemaphore(HANDLE semaphore);
+#else
+	void postSemaphore(boost::interprocess::named_semaphore * semaphore);
+#endif
 	void catchAndRepeat(const std::string & taskDescription, std::function<void()> doThis);
 
 	void doubleMemoryOut();
@@ -91,6 +123,12 @@ private:
 												*	_mutexIn				= nullptr;
 	String										*	_dataOut				= nullptr,
 												*	_dataIn					= nullptr;
+	ChunkState									*	_chunkOut				= nullptr,
+												*	_chunkIn				= nullptr;
+	std::mutex										_gatheredLock;
+	std::string										_gathered;							///< The message gather got, until receive takes it
+	bool											_gatheredWaiting		= false;
+	std::atomic<bool>								_gatherAborted			= false;
 	size_t										*	_sizeMtoS				= nullptr,
 												*	_sizeStoM				= nullptr,
 												*	_sizeIn					= nullptr,
@@ -101,6 +139,8 @@ private:
 													_mutexOutName,
 													_dataInName,
 													_dataOutName,
+													_chunkInName,
+													_chunkOutName,
 													_semaphoreInName,
 													_semaphoreOutName;
 #ifdef __APPLE__
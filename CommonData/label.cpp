@@ -92,6 +92,8 @@ void Label::dbUpdate()
 
 void Label::setInformation(Column * column, int id, int order, const std::string &label, int value, bool filterAllows, const std::string & description, const Json::Value & originalValue)
 {
+	const size_t oldLength = this->label(true).size();
+
 	_id				= id;
 	_order			= order;
 	_label			= label;
@@ -99,6 +101,8 @@ void Label::setInformation(Column * column, int id, int order, const std::string
 	_filterAllows	= filterAllows;
 	_description	= description;
 	_originalValue	= originalValue;
+
+	_column->labelDisplayLengthChanged(oldLength, this->label(true).size());
 }
 
 Json::Value Label::serialize() const
@@ -211,8 +215,12 @@ bool Label::setLabel(const std::string & label)
 {
 	if(_label != label)
 	{
+		const size_t oldLength = this->label(true).size();
+
 		_label = label.empty() ? originalValueAsString() : label;
 
+		_column->labelDisplayLengthChanged(oldLength, this->label(true).size());
+
 		dbUpdate();
 		return true;
 	}
@@ -0,0 +1,431 @@
+#include "mappedcolumnstore.h"
+#include "tempfiles.h"
+#include "log.h"
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <cmath>
+
+namespace bip = boost::interprocess;
+
+static const char _magic[4] = {'J', 'C', 'S', '1'};
+
+std::set<std::string>	MappedColumnStore::_leftovers;
+std::recursive_mutex	MappedColumnStore::_lock;
+const size_t			MappedColumnStore::_overlayLimit = 4096;
+
+MappedColumnStore::Mapping::Mapping(const std::string & path)
+	: _file(path.c_str(), bip::read_only), _region(_file, bip::read_only)
+{
+	if(_region.get_size() < sizeof(Header))
+		throw std::runtime_error("MappedColumnStore file '" + path + "' is too small to even contain a header.");
+
+	const Header * header = static_cast<const Header*>(_region.get_address());
+
+	if(std::memcmp(header->magic, _magic, sizeof(_magic)) != 0 || _region.get_size() < sizeof(Header) + header->rowCount * header->valueSize)
+		throw std::runtime_error("MappedColumnStore file '" + path + "' is malformed.");
+
+	_rowCount	= header->rowCount;
+	_valueSize	= header->valueSize;
+	_values		= static_cast<const char*>(_region.get_address()) + sizeof(Header);
+}
+
+void MappedColumnStore::Mapping::copyTo(intvec & ints) const
+{
+	ints.assign(this->ints(), this->ints() + _rowCount);
+	_applyOverlay(_overlay, reinterpret_cast<char*>(ints.data()), sizeof(int), _rowCount);
+}
+
+void MappedColumnStore::Mapping::copyTo(doublevec & dbls) const
+{
+	dbls.assign(this->dbls(), this->dbls() + _rowCount);
+	_applyOverlay(_overlay, reinterpret_cast<char*>(dbls.data()), sizeof(double), _rowCount);
+}
+
+std::string MappedColumnStore::_dir()
+{
+	return Utils::osPath(TempFiles::sessionDirName() + "/columns").string();
+}
+
+bool MappedColumnStore::enabledForSession()
+{
+	return !TempFiles::sessionDirName().empty() && std::filesystem::is_directory(_dir());
+}
+
+void MappedColumnStore::setEnabledForSession(bool enabled)
+{
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	std::error_code error;
+
+	_leftovers.clear();
+
+	if(enabled)		std::filesystem::create_directories(_dir(), error);
+	else			std::filesystem::remove_all(_dir(), error);
+
+	if(error)
+		Log::log() << "MappedColumnStore::setEnabledForSession(" << (enabled ? "true" : "false") << ") had a problem: " << error.message() << std::endl;
+}
+
+void MappedColumnStore::clear()
+{
+	if(!enabledForSession())
+		return;
+
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	std::error_code error;
+
+	//The .gen files go as well, so no column has values afterwards. Whatever is still mapped on windows is left for _removeFrom to try again
+	for(const auto & entry : std::filesystem::directory_iterator(_dir(), error))
+		_removeFile(entry.path().string());
+}
+
+std::string MappedColumnStore::_prefix(int columnId, bool dbl)
+{
+	return "Column_" + std::to_string(columnId) + (dbl ? "_DBL" : "_INT");
+}
+
+std::string MappedColumnStore::_path(int columnId, bool dbl, int generation, const char * extension)
+{
+	return Utils::osPath(_dir() + "/" + _prefix(columnId, dbl) + "_" + std::to_string(generation) + extension).string();
+}
+
+std::string MappedColumnStore::_pointerPath(int columnId, bool dbl)
+{
+	return Utils::osPath(_dir() + "/" + _prefix(columnId, dbl) + ".gen").string();
+}
+
+int MappedColumnStore::_generation(int columnId, bool dbl)
+{
+	std::ifstream	file(_pointerPath(columnId, dbl));
+	int				generation;
+
+	return file >> generation ? generation : -1;
+}
+
+void MappedColumnStore::_setGeneration(int columnId, bool dbl, int generation)
+{
+	const std::string pointer = _pointerPath(columnId, dbl);
+
+	if(generation == -1)
+	{
+		if(!_removeFile(pointer))
+			throw std::runtime_error("MappedColumnStore could not remove '" + pointer + "'");
+		return;
+	}
+
+	//Written next to it and then renamed over it, so another process reading it sees either the old or the new number but never half of one
+	const std::string	temporary	= pointer + ".new";
+	std::error_code		error;
+
+	{
+		std::ofstream file(temporary, std::ios::trunc);
+		file << generation;
+
+		if(!file)
+			throw std::runtime_error("MappedColumnStore could not write '" + temporary + "'");
+	}
+
+	//On windows the rename fails while an engine happens to be reading the old one, that only takes a moment
+	for(int attempt=0; attempt<100; attempt++)
+	{
+		std::filesystem::rename(temporary, pointer, error);
+
+		if(!error)
+			return;
+
+		Utils::sleep(1);
+	}
+
+	throw std::runtime_error("MappedColumnStore could not replace '" + pointer + "': " + error.message());
+}
+
+bool MappedColumnStore::_removeFile(const std::string & path)
+{
+	std::error_code error;
+
+	if(std::filesystem::remove(path, error) || !std::filesystem::exists(path, error))
+	{
+		_leftovers.erase(path);
+		return true;
+	}
+
+	//Probably still mapped by an engine on windows, try again next time
+	_leftovers.insert(path);
+	return false;
+}
+
+void MappedColumnStore::_removeFrom(int columnId, bool dbl, int generation)
+{
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	const std::set<std::string> leftovers = _leftovers;
+
+	for(const std::string & leftover : leftovers)
+		_removeFile(leftover);
+
+	//Each write removes the generation before it, so the first one that is entirely gone means the older ones are as well
+	std::error_code error;
+
+	for(int gen = generation; gen >= 0; gen--)
+	{
+		const std::string	values	= _path(columnId, dbl, gen),
+							edits	= _path(columnId, dbl, gen, ".edits");
+
+		if(!std::filesystem::exists(values, error) && !std::filesystem::exists(edits, error))
+			break;
+
+		_removeFile(values);
+		_removeFile(edits);
+	}
+}
+
+void MappedColumnStore::_removeAll(int columnId, bool dbl)
+{
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	const int generation = _generation(columnId, dbl);
+
+	if(generation == -1)
+		return;
+
+	_setGeneration(columnId, dbl, -1);
+	_removeFrom(columnId, dbl, generation);
+}
+
+bool MappedColumnStore::hasValues(int columnId, bool dbl)
+{
+	return enabledForSession() && _generation(columnId, dbl) != -1;
+}
+
+bool MappedColumnStore::hasEdits(int columnId, bool dbl)
+{
+	if(!enabledForSession())
+		return false;
+
+	const int		generation	= _generation(columnId, dbl);
+	std::error_code	error;
+
+	return generation != -1 && std::filesystem::file_size(_path(columnId, dbl, generation, ".edits"), error) > 0 && !error;
+}
+
+void MappedColumnStore::_write(int columnId, bool dbl, const char * values, size_t valueSize, size_t rowCount)
+{
+	JASPTIMER_SCOPE(MappedColumnStore::_write);
+
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	const int		previous	= _generation(columnId, dbl);
+	int				generation	= previous + 1;
+	std::error_code	error;
+
+	//Something of an earlier run of generations might not have been removable yet
+	while(std::filesystem::exists(_path(columnId, dbl, generation), error) || std::filesystem::exists(_path(columnId, dbl, generation, ".edits"), error))
+		generation++;
+
+	const std::string path = _path(columnId, dbl, generation);
+
+	{
+		std::ofstream	file(path, std::ios::binary | std::ios::trunc);
+		Header			header;
+
+		std::memcpy(header.magic, _magic, sizeof(_magic));
+		header.valueSize	= valueSize;
+		header.rowCount		= rowCount;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+		file.write(values, valueSize * rowCount);
+
+		if(!file)
+			throw std::runtime_error("MappedColumnStore could not write '" + path + "'");
+	}
+
+	_setGeneration(columnId, dbl, generation);
+
+	if(previous != -1)
+		_removeFrom(columnId, dbl, previous);
+
+	_removeAll(columnId, !dbl); //The column might have changed type, the other kind should not be found afterwards
+}
+
+void MappedColumnStore::write(int columnId, intspan ints)
+{
+	_write(columnId, false, reinterpret_cast<const char*>(ints.data()), sizeof(int), ints.size());
+}
+
+void MappedColumnStore::write(int columnId, doublespan dbls)
+{
+	_write(columnId, true, reinterpret_cast<const char*>(dbls.data()), sizeof(double), dbls.size());
+}
+
+bool MappedColumnStore::_writeValue(int columnId, bool dbl, size_t row, const char * value, size_t valueSize)
+{
+	JASPTIMER_SCOPE(MappedColumnStore::_writeValue);
+
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	const int generation = _generation(columnId, dbl);
+
+	if(generation == -1)
+		return false;
+
+	Header header;
+
+	{
+		std::ifstream file(_path(columnId, dbl, generation), std::ios::binary);
+
+		if(!_readHeader(file, header, valueSize) || row >= header.rowCount)
+			return false;
+	}
+
+	//The engines have the values mapped and lend its pages to R, so those are never changed in place. The cell goes into the overlay instead, which only an engine that (re)loads the column reads.
+	const std::string	path	= _path(columnId, dbl, generation, ".edits");
+	const uint64_t		row64	= row;
+	size_t				edits;
+
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::app);
+
+		file.write(reinterpret_cast<const char*>(&row64), sizeof(row64));
+		file.write(value, valueSize);
+
+		if(!file)
+			throw std::runtime_error("MappedColumnStore could not write '" + path + "'");
+
+		edits = size_t(file.tellp()) / (sizeof(row64) + valueSize);
+	}
+
+	if(edits >= _overlayLimit)
+	{
+		std::vector<char> values(header.rowCount * valueSize);
+
+		if(_read(columnId, dbl, values.data(), valueSize, header.rowCount))
+			_write(columnId, dbl, values.data(), valueSize, header.rowCount);
+	}
+
+	return true;
+}
+
+bool MappedColumnStore::writeValue(int columnId, size_t row, int value)
+{
+	return _writeValue(columnId, false, row, reinterpret_cast<const char*>(&value), sizeof(int));
+}
+
+bool MappedColumnStore::writeValue(int columnId, size_t row, double value)
+{
+	return _writeValue(columnId, true, row, reinterpret_cast<const char*>(&value), sizeof(double));
+}
+
+bool MappedColumnStore::_readHeader(std::istream & file, Header & header, size_t valueSize)
+{
+	return file.read(reinterpret_cast<char*>(&header), sizeof(Header)) && std::memcmp(header.magic, _magic, sizeof(_magic)) == 0 && header.valueSize == valueSize;
+}
+
+void MappedColumnStore::_readOverlay(int columnId, bool dbl, int generation, std::vector<char> & overlay, size_t valueSize)
+{
+	std::ifstream	file(_path(columnId, dbl, generation, ".edits"), std::ios::binary | std::ios::ate);
+	const size_t	edit	= sizeof(uint64_t) + valueSize,
+					size	= file ? size_t(file.tellg()) : 0;
+
+	//An edit that is being appended right now is left out, it comes with a new revision of the column anyway
+	overlay.resize(size - size % edit);
+
+	if(overlay.size() && !(file.seekg(0) && file.read(overlay.data(), overlay.size())))
+		overlay.clear();
+}
+
+void MappedColumnStore::_applyOverlay(const std::vector<char> & overlay, char * values, size_t valueSize, size_t rowCount)
+{
+	const size_t edit = sizeof(uint64_t) + valueSize;
+
+	for(size_t pos = 0; pos + edit <= overlay.size(); pos += edit)
+	{
+		uint64_t row;
+		std::memcpy(&row, overlay.data() + pos, sizeof(row));
+
+		if(row < rowCount)
+			std::memcpy(values + row * valueSize, overlay.data() + pos + sizeof(row), valueSize);
+	}
+}
+
+bool MappedColumnStore::_read(int columnId, bool dbl, char * values, size_t valueSize, size_t rowCount)
+{
+	JASPTIMER_SCOPE(MappedColumnStore::_read);
+
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	const int generation = _generation(columnId, dbl);
+
+	if(generation == -1)
+		return false;
+
+	std::ifstream	file(_path(columnId, dbl, generation), std::ios::binary);
+	Header			header;
+
+	if(!_readHeader(file, header, valueSize) || !file.read(values, valueSize * std::min(size_t(header.rowCount), rowCount)))
+		return false;
+
+	std::vector<char> overlay;
+	_readOverlay(columnId, dbl, generation, overlay, valueSize);
+	_applyOverlay(overlay, values, valueSize, rowCount);
+
+	return true;
+}
+
+bool MappedColumnStore::read(int columnId, intvec & ints, size_t rowCount)
+{
+	ints.assign(rowCount, std::numeric_limits<int>::lowest());
+	return _read(columnId, false, reinterpret_cast<char*>(ints.data()), sizeof(int), rowCount);
+}
+
+bool MappedColumnStore::read(int columnId, doublevec & dbls, size_t rowCount)
+{
+	dbls.assign(rowCount, NAN);
+	return _read(columnId, true, reinterpret_cast<char*>(dbls.data()), sizeof(double), rowCount);
+}
+
+MappedColumnStore::Mapping * MappedColumnStore::map(int columnId, bool dbl, size_t rowCount)
+{
+	JASPTIMER_SCOPE(MappedColumnStore::map);
+
+	std::lock_guard<std::recursive_mutex> lock(_lock);
+
+	//Desktop might write a new generation in the meantime and remove this one, in that case we simply try again with the new one
+	for(int attempt=0; attempt<3; attempt++)
+	{
+		const int generation = _generation(columnId, dbl);
+
+		if(generation == -1)
+			return nullptr;
+
+		try
+		{
+			std::unique_ptr<Mapping> mapping(new Mapping(_path(columnId, dbl, generation)));
+
+			if(mapping->rowCount() != rowCount || mapping->_valueSize != (dbl ? sizeof(double) : sizeof(int)))
+				return nullptr;
+
+			_readOverlay(columnId, dbl, generation, mapping->_overlay, mapping->_valueSize);
+
+			//Only if it is still current can we be sure the overlay was not removed before we read it
+			if(_generation(columnId, dbl) == generation)
+				return mapping.release();
+		}
+		catch(std::exception & e)
+		{
+			Log::log() << "MappedColumnStore::map failed for column " << columnId << ": " << e.what() << std::endl;
+		}
+	}
+
+	return nullptr;
+}
+
+void MappedColumnStore::remove(int columnId)
+{
+	if(!enabledForSession())
+		return;
+
+	_removeAll(columnId, false);
+	_removeAll(columnId, true);
+}
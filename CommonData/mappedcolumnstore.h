@@ -0,0 +1,100 @@
+#ifndef MAPPEDCOLUMNSTORE_H
+#define MAPPEDCOLUMNSTORE_H
+
+#include <cstdint>
+#include <set>
+#include <vector>
+#include <mutex>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include "utils.h"
+
+/// Keeps the values of columns in memory-mapped binary files in the sessiondir, as an alternative to the Column_#_INT/DBL pairs in DataSet_#
+///
+/// It is used by DatabaseInterface when Desktop turned it on through DatabaseInterface::setValuesMapped, sqlite still holds everything else (Columns, Labels, Filters and the revisions).
+/// Whether it is on is stored as the existence of the folder "columns" in the sessiondir, so that the engines automatically follow Desktop.
+/// Each full write of a column gets a new file named Column_#_INT_<generation>.bin or Column_#_DBL_<generation>.bin, containing a Header followed by the contiguous values.
+/// A file is never changed once written, so an engine that still has an older file mapped (which windows does not allow to be replaced) is never bothered and R never sees a value change halfway through an analysis.
+/// Which generation is current is kept in the small file Column_#_INT.gen or Column_#_DBL.gen, replaced with a rename so every process always sees a whole number. Older generations are removed when possible.
+/// A column without a .gen file still has its values in DataSet_#, for instance right after loading a jaspfile.
+///
+/// Single cells written through writeValue are appended to the overlay of the current generation (the same name with .edits instead of .bin), a new generation is only written by write.
+/// DatabaseInterface calls that at the end of a batch, writeValue itself only does so once the overlay grows past _overlayLimit edits.
+///
+/// Desktop reads the files into the vectors of Column because it needs to edit them, the engines instead map them read-only through Mapping.
+/// That means the values are only once in memory, regardless of how many engines are running, as long as the current generation has no overlay.
+class MappedColumnStore
+{
+public:
+	struct Header
+	{
+		char		magic[4];	///< "JCS1"
+		uint32_t	valueSize;	///< sizeof(int) or sizeof(double)
+		uint64_t	rowCount;
+	};
+
+	/// A read-only mapping of the values of a single column as written by MappedColumnStore::write, together with the overlay of that generation
+	class Mapping
+	{
+	public:
+							Mapping(const std::string & path);
+
+		size_t				rowCount()	const { return _rowCount;											}
+		const int		*	ints()		const { return reinterpret_cast<const int*>(	_values);	}	///< Without the overlay
+		const double	*	dbls()		const { return reinterpret_cast<const double*>(	_values);	}	///< Without the overlay
+		bool				edited()	const { return !_overlay.empty();								}	///< Whether cells were written after the file, those are only in copyTo
+		void				copyTo(intvec		& ints) const;													///< Copies the values with the overlay applied
+		void				copyTo(doublevec	& dbls) const;
+
+	private:
+		friend class MappedColumnStore;
+
+		boost::interprocess::file_mapping	_file;
+		boost::interprocess::mapped_region	_region;
+		const char						*	_values		= nullptr;
+		size_t								_rowCount	= 0,
+											_valueSize	= 0;
+		std::vector<char>					_overlay;
+	};
+
+	static bool			enabledForSession();								///< Whether the sessiondir contains the columns folder
+	static void			setEnabledForSession(bool enabled);					///< Creates or removes the columns folder and thus everything in it
+	static void			clear();											///< Removes all column files but keeps the store enabled, used when a new database is created or loaded
+
+	static bool			hasValues(	int columnId, bool dbl);
+	static bool			hasEdits(	int columnId, bool dbl);							///< Whether cells were written through writeValue since the last write
+	static bool			read(		int columnId, intvec	& ints, size_t rowCount);	///< Reads the values, overlay included, into ints padding or cutting it to rowCount. Returns false if there is no file for the column
+	static bool			read(		int columnId, doublevec & dbls, size_t rowCount);
+	static Mapping	*	map(		int columnId, bool dbl, size_t rowCount);			///< Returns nullptr if there is no file or if it does not have rowCount values
+	static void			write(		int columnId, intspan		ints);
+	static void			write(		int columnId, doublespan	dbls);
+	static bool			writeValue(	int columnId, size_t row, int		value);		///< Adds the value to the overlay of the current generation, returns false if there is none or it is too short
+	static bool			writeValue(	int columnId, size_t row, double	value);
+	static void			remove(		int columnId);
+
+private:
+	typedef std::pair<int, bool> ColumnKind;	///< Column id and whether it is the DBL file
+
+	static std::string	_dir();
+	static std::string	_prefix(		int columnId, bool dbl);
+	static std::string	_path(			int columnId, bool dbl, int generation, const char * extension = ".bin");
+	static std::string	_pointerPath(	int columnId, bool dbl);
+	static int			_generation(	int columnId, bool dbl);					///< Reads the current generation from the .gen file, -1 if there is none
+	static void			_setGeneration(	int columnId, bool dbl, int generation);
+	static void			_removeFrom(	int columnId, bool dbl, int generation);	///< Removes generation and everything older, plus whatever could not be removed before
+	static void			_removeAll(		int columnId, bool dbl);
+	static bool			_removeFile(	const std::string & path);					///< Returns false if it is still there afterwards
+
+	static void			_write(			int columnId, bool dbl, const char * values, size_t valueSize, size_t rowCount);
+	static bool			_writeValue(	int columnId, bool dbl, size_t row, const char * value, size_t valueSize);
+	static bool			_read(			int columnId, bool dbl, char * values, size_t valueSize, size_t rowCount);
+	static bool			_readHeader(	std::istream & file, Header & header, size_t valueSize);
+	static void			_readOverlay(	int columnId, bool dbl, int generation, std::vector<char> & overlay, size_t valueSize);
+	static void			_applyOverlay(	const std::vector<char> & overlay, char * values, size_t valueSize, size_t rowCount);
+
+	static std::set<std::string>	_leftovers;		///< Files that could not be removed yet, probably because an engine on windows still has them mapped
+	static std::recursive_mutex		_lock;
+	static const size_t				_overlayLimit;	///< How many edits the overlay may contain before writeValue writes a new generation
+};
+
+#endif // MAPPEDCOLUMNSTORE_H
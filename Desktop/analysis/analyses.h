@@ -95,6 +95,7 @@ public:
 	QVariant				data(const QModelIndex &index, int role = Qt::DisplayRole)	const override;
 	QHash<int, QByteArray>	roleNames()													const override;
 	int						currentAnalysisIndex()										const			{ return _currentAnalysisIndex;	}
+	Analysis*				currentAnalysis()														{ return _currentAnalysisIndex > -1 && _currentAnalysisIndex < count() ? (*this)[_currentAnalysisIndex] : nullptr; }
 	double					currentFormHeight()											const			{ return _currentFormHeight;	}
 	bool					visible()													const			{ return _visible;				}
 	bool					moving()													const			{ return _moving;				}
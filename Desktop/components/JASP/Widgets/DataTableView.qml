@@ -83,6 +83,50 @@ FocusScope
 			//flickableInteractive:	!ribbonModel.dataMode
 			onDoubleClicked:		__myRoot.doubleClicked()
 
+			drawCellText:			true
+			onCellPressed:			(rowIndex, columnIndex, mouse, globalPos) => cellPressedAt(view, globalPos, mouse, rowIndex, columnIndex)
+			onCellDragged:			(rowIndex, columnIndex, mouse) => cellDraggedAt(mouse, rowIndex, columnIndex)
+
+			function cellPressedAt(fromItem, globalPos, mouse, rowIndex, columnIndex)
+			{
+				if(ribbonModel.dataMode)
+				{
+					var shiftPressed = Boolean(mouse.modifiers & Qt.ShiftModifier)
+					var rightPressed = Boolean(mouse.buttons & Qt.RightButton)
+					var isSelected = dataTableView.view.isSelected(rowIndex, columnIndex)
+
+					if(!shiftPressed)
+					{
+						if (!rightPressed || !isSelected)
+							dataTableView.view.selectionStart = Qt.point(columnIndex, rowIndex)
+					}
+					else
+						dataTableView.view.selectionEnd = Qt.point(columnIndex, rowIndex);
+
+					if(rightPressed)
+					{
+						dataTableView.view.clearEdit()
+						dataTableView.showPopupMenu(fromItem, globalPos, rowIndex, columnIndex);
+					}
+					else if(!shiftPressed)
+						dataTableView.view.edit(rowIndex, columnIndex)
+
+				}
+				else if (columnModel.visible)
+				{
+					columnModel.chosenColumn = columnIndex
+				}
+			}
+
+			function cellDraggedAt(mouse, rowIndex, columnIndex)
+			{
+				if(ribbonModel.dataMode && Boolean(mouse.modifiers & Qt.ShiftModifier))
+				{
+					dataTableView.view.pollSelectScroll(rowIndex, columnIndex)
+					dataTableView.view.selectionEnd = Qt.point(columnIndex, rowIndex)
+				}
+			}
+
 			function showPopupMenu(fromItem, globalPos, rowIndex, columnIndex)
 			{
 				var ctrlCmd = MACOS ? qsTr("Cmd") : qsTr("Ctrl");
@@ -388,45 +432,8 @@ FocusScope
 						anchors.fill:		itemHighlight
 						acceptedButtons:	Qt.LeftButton | Qt.RightButton
 
-						onPressed:	(mouse) =>
-						{
-							if(ribbonModel.dataMode)
-							{
-								var shiftPressed = Boolean(mouse.modifiers & Qt.ShiftModifier)
-								var rightPressed = Boolean(mouse.buttons & Qt.RightButton)
-								var isSelected = dataTableView.view.isSelected(rowIndex, columnIndex)
-
-								if(!shiftPressed)
-								{
-									if (!rightPressed || !isSelected)
-										dataTableView.view.selectionStart = Qt.point(columnIndex, rowIndex)
-								}
-								else
-									dataTableView.view.selectionEnd = Qt.point(columnIndex, rowIndex);
-
-								if(rightPressed)
-								{
-									dataTableView.view.clearEdit()
-									dataTableView.showPopupMenu(itemHighlight, mapToGlobal(mouse.x, mouse.y), rowIndex, columnIndex);
-								}
-								else if(!shiftPressed)
-									dataTableView.view.edit(rowIndex, columnIndex)
-
-							}
-							else if (columnModel.visible)
-							{
-								columnModel.chosenColumn = columnIndex
-							}
-						}
-
-						onPositionChanged:	(mouse) =>
-						{
-							if(ribbonModel.dataMode && Boolean(mouse.modifiers & Qt.ShiftModifier))
-							{
-								dataTableView.view.pollSelectScroll(rowIndex, columnIndex)
-								dataTableView.view.selectionEnd = Qt.point(columnIndex, rowIndex)
-							}
-						}
+						onPressed:			(mouse) => dataTableView.cellPressedAt(itemHighlight, mapToGlobal(mouse.x, mouse.y), mouse, rowIndex, columnIndex)
+						onPositionChanged:	(mouse) => dataTableView.cellDraggedAt(mouse, rowIndex, columnIndex)
 
 					}
 
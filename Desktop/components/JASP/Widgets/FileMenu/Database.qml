@@ -370,6 +370,26 @@ For a local or toy database this is probably overkill, but use your own judgemen
                 }
             }
 
+            RowLayout
+            {
+                width:						parent.width
+
+                Text
+                {
+                    id:						dbKeyColumnLabel
+                    text:					qsTr("Numeric key column that only increases, to synch just the new rows (optional)")
+                    width:					implicitWidth + jaspTheme.generalAnchorMargin
+                }
+
+                PrefsTextInput
+                {
+                    id:						dbKeyColumn
+                    text:					fileMenuModel.database.keyColumn
+                    onEditingFinished:		fileMenuModel.database.keyColumn = text
+                    LQ.Layout.fillWidth:	true
+                }
+            }
+
 
 			Rectangle
 			{
@@ -24,6 +24,7 @@ FocusScope
 				property alias editDelegate:			theView.editDelegate
 				property alias cacheItems:				theView.cacheItems
 				property alias expandDataSet:			theView.expandDataSet
+				property alias drawCellText:			theView.drawCellText
 
 				property alias itemHorizontalPadding:	theView.itemHorizontalPadding
 				property alias itemVerticalPadding:		theView.itemVerticalPadding
@@ -142,6 +143,32 @@ FocusScope
 			onSelectionBudgesDown:	__JASPDataViewRoot.budgeDown()
 			onSelectionBudgesLeft:	__JASPDataViewRoot.budgeLeft()
 			onSelectionBudgesRight:	__JASPDataViewRoot.budgeRight()
+
+			MouseArea
+			{
+				// With drawCellText there are no item delegates to click on, so the cells get their mouse events from here
+				id:					cellMouseArea
+				enabled:			theView.drawCellText
+				anchors.fill:		parent
+				z:					-5
+				acceptedButtons:	Qt.LeftButton | Qt.RightButton
+
+				onPressed: (mouse) =>
+				{
+					var cell = theView.cellAt(mouse.x, mouse.y);
+
+					if(cell.x === -1)	mouse.accepted = false;
+					else				__JASPDataViewRoot.cellPressed(cell.y, cell.x, mouse, mapToGlobal(mouse.x, mouse.y));
+				}
+
+				onPositionChanged: (mouse) =>
+				{
+					var cell = theView.cellAt(mouse.x, mouse.y);
+
+					if(cell.x !== -1)
+						__JASPDataViewRoot.cellDragged(cell.y, cell.x, mouse);
+				}
+			}
 		}
 	}
 	/*
@@ -157,6 +184,8 @@ FocusScope
 	*/
 
 	signal doubleClicked()
+	signal cellPressed(int rowIndex, int columnIndex, var mouse, point globalPos)	///< Only when drawCellText is on
+	signal cellDragged(int rowIndex, int columnIndex, var mouse)					///< Only when drawCellText is on
 
 	JASPMouseAreaToolTipped
 	{
@@ -2,6 +2,7 @@
 #include "utilities/qutils.h"
 #include <QSqlDatabase>
 #include <QSqlError>
+#include <QSqlDriver>
 #include "log.h"
 
 Json::Value DatabaseConnectionInfo::toJson(bool forJaspFile) const
@@ -17,6 +18,7 @@ Json::Value DatabaseConnectionInfo::toJson(bool forJaspFile) const
 	out["database"]		= fq(_database);
 	out["hostname"]		= fq(_hostname);
 	out["query"]		= fq(_query);
+	out["keyColumn"]	= fq(_keyColumn);
 	out["port"]			= _port;
 	out["interval"]		= _interval;
 	out["rememberMe"]	= _rememberMe;
@@ -35,6 +37,7 @@ void DatabaseConnectionInfo::fromJson(const Json::Value & json)
 	_database		= tq(				json["database"]	.asString() )	;
 	_hostname		= tq(				json["hostname"]	.asString() )	;
 	_query			= tq(				json["query"]		.asString() )	;
+	_keyColumn		= tq(				json["keyColumn"]	.asString() )	;
 	_port			=					json["port"]		.asUInt()		;
 	_interval		=					json["interval"]	.asInt()		;
 	_rememberMe		=					json["rememberMe"]	.asBool()		;
@@ -74,14 +77,42 @@ QString DatabaseConnectionInfo::lastError() const
 }
 
 QSqlQuery DatabaseConnectionInfo::runQuery() const
+{
+	return _runQuery(_query);
+}
+
+QSqlQuery DatabaseConnectionInfo::runQueryAfterKey(const QVariant & lastKey) const
+{
+	QString inner = _query.trimmed();
+
+	while(inner.endsWith(';'))
+		inner = inner.chopped(1).trimmed();
+
+	const QString key = QSqlDatabase::database().driver()->escapeIdentifier(_keyColumn, QSqlDriver::FieldName);
+
+	return _runQuery("SELECT * FROM (" + inner + ") AS jaspIncremental WHERE " + key + " > ? ORDER BY " + key, lastKey);
+}
+
+QSqlQuery DatabaseConnectionInfo::_runQuery(const QString & queryText, const QVariant & bindValue) const
 {
 	if(!QSqlDatabase::database().isOpen())
 		throw std::runtime_error(fq(QObject::tr("JASP thinks it's connected to the database but the QSqlDatabase isn't opened...")));
 	
 	QSqlQuery query;
-	query.setForwardOnly(true);
+	query.setForwardOnly(true); //So the driver can hand over the rows as they come instead of caching the whole result first
+
+	bool ran;
+
+	if(!bindValue.isValid())
+		ran = query.exec(queryText);
+	else
+	{
+		ran = query.prepare(queryText);
+		query.addBindValue(bindValue);
+		ran = ran && query.exec();
+	}
 
-	if(!query.exec(_query))
+	if(!ran)
 		throw std::runtime_error(fq(QObject::tr("Query failed with: '%1'").arg(query.lastError().text())));
 
 	if(!query.isSelect())
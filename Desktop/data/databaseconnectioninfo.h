@@ -21,6 +21,7 @@ public:
 	
 	QString		lastError() const;
 	QSqlQuery	runQuery()	const;
+	QSqlQuery	runQueryAfterKey(const QVariant & lastKey) const; ///< Runs _query but only returns the rows where _keyColumn is higher than lastKey
 	
 	
 	DbType  _dbType			= DbType::NOTCHOSEN;
@@ -28,12 +29,15 @@ public:
 			_password		= "",
 			_database		= "",
 			_hostname		= "",
-			_query			= "";
+			_query			= "",
+			_keyColumn		= "";	///< If set the values in this column of the results only ever increase, so a synch only needs to fetch the rows after the last one it saw. Only numeric columns can be used, a text key depends on the collation of the database
 	int		_port			= 0,
 			_interval		= 0;
 	bool	_rememberMe		= false,
 			_hadPassword	= false;
-	
+
+private:
+	QSqlQuery	_runQuery(const QString & query, const QVariant & bindValue = QVariant()) const;
 };
 
 #endif // DATABASECONNECTIONINFO_H
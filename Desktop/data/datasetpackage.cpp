@@ -45,6 +45,7 @@ DataSetPackage::DataSetPackage(QObject * parent) : QAbstractItemModel(parent)
 	//True init is done in setEngineSync!
 	
 	_db			= new DatabaseInterface(true);
+	_db->setValuesMapped(Settings::value(Settings::DATA_VALUES_MAPPED).toBool());
 
 	_dataSet	= new DataSet(); //We create one here to make sure filter() etc can actually work
 	setDefaultWorkspaceEmptyValues();
@@ -124,6 +125,8 @@ void DataSetPackage::reset(bool newDataSet)
 	
 	beginLoadingData();
 
+	_dataSetResets++;
+
 	if(newDataSet)	createDataSet();
 	else			deleteDataSet();
 
@@ -1280,6 +1283,8 @@ void DataSetPackage::loadDataSet(std::function<void(float)> progressCallback)
 	if(_dataSet)
 		deleteDataSet(); //no dbDelete necessary cause we just copied an old sqlite file here from the JASP file
 
+	_dataSetResets++;
+
 	_db->close();
 	_db->load();
 	_db->upgradeDBFromVersion(_jaspVersion);
@@ -1353,111 +1358,114 @@ int DataSetPackage::getColIndex(QVariant colID)
 		return _dataSet->getColumnIndex(fq(colID.toString()));
 }
 
-bool DataSetPackage::convertVecToInt(int colIndex, const std::vector<std::string> &values, std::vector<int> &intValues, std::set<int> &uniqueValues, std::map<int, std::string> &emptyValuesMap)
+void DataSetPackage::initColumnWithStrings(QVariant colId, const std::string & newName, const stringvec &values, const std::string & title, columnType desiredType)
 {
-	JASPTIMER_SCOPE(ColumnUtils::convertVecToInt);
+	JASPTIMER_SCOPE(DataSetPackage::initColumnWithStrings);
 
-	emptyValuesMap.clear();
-	uniqueValues.clear();
-	intValues.clear();
-	intValues.reserve(values.size());
+	ConvertedStrings	converted;
+	int					colIndex = getColIndex(colId);
 
-	int row = 0;
+	convertColumnStrings(colIndex, values, importThresholdScale(), converted, desiredType);
+	initColumnWithConverted(colIndex, newName, values, converted);
+}
 
-	for (const std::string &value : values)
-	{
-		int intValue = std::numeric_limits<int>::lowest();
+size_t DataSetPackage::importThresholdScale() const
+{
+	//If less unique integers than the thresholdScale then we think it must be ordinal: https://github.com/jasp-stats/INTERNAL-jasp/issues/270
+	bool	useCustomThreshold	= Settings::value(Settings::USE_CUSTOM_THRESHOLD_SCALE).toBool();
+	return	(useCustomThreshold ? Settings::value(Settings::THRESHOLD_SCALE) : Settings::defaultValue(Settings::THRESHOLD_SCALE)).toUInt();
+}
 
-		if (_dataSet->column(colIndex)->convertValueToIntForImport(value, intValue))
-		{
-			if (intValue != std::numeric_limits<int>::lowest())	uniqueValues.insert(intValue);
-			else if (!value.empty())							emptyValuesMap.insert(make_pair(row, value));
+void DataSetPackage::convertColumnStrings(size_t colIndex, const stringvec & values, size_t thresholdScale, ConvertedStrings & converted, columnType desiredType) const
+{
+	JASPTIMER_SCOPE(DataSetPackage::convertColumnStrings);
 
-			intValues.push_back(intValue);
-		}
-		else
-		{
-			std::vector<int>().swap(intValues); //this clears intValues and guarentees its memory is released
-			return false;
-		}
+	// interpret the column as a datatype, all in one pass over the values
+	ColumnUtils::ColumnInference inference;
+	ColumnUtils::inferColumnType(values, _dataSet->column(colIndex)->emptyValues(), inference);
 
-		row++;
-	}
+	const intset	&	uniqueValues			= inference.uniqueInts;
+	bool				valuesAreIntegers		= inference.allIntegers();
+	size_t				minIntForThresh			= thresholdScale > 2 ? 2 : 0;
 
-	return true;
+	auto isNominalInt			= [&](){ return valuesAreIntegers && (desiredType == columnType::nominal || uniqueValues.size() == minIntForThresh); };
+	auto isOrdinal				= [&](){ return valuesAreIntegers && (desiredType == columnType::ordinal || (uniqueValues.size() >  minIntForThresh && uniqueValues.size() <= thresholdScale)); };
+	auto isScalar				= [&](){ return inference.allNumbers(); };
+
+	if		(isOrdinal())		converted.type = columnType::ordinal;
+	else if	(isNominalInt())	converted.type = columnType::nominal;
+	else if	(isScalar())		converted.type = columnType::scale;
+	else						converted.type = columnType::nominalText;
+
+	converted.emptyValues.swap(inference.emptyValues);
+
+	if(converted.type == columnType::ordinal || converted.type == columnType::nominal)	converted.ints.swap(inference.ints);
+	else if(converted.type == columnType::scale)										converted.dbls.swap(inference.dbls);
 }
 
+void DataSetPackage::initColumnWithConverted(size_t colIndex, const std::string & newName, const stringvec & values, ConvertedStrings & converted)
+{
+	JASPTIMER_SCOPE(DataSetPackage::initColumnWithConverted);
+
+	switch(converted.type)
+	{
+	case columnType::ordinal:		initColumnAsNominalOrOrdinal(	colIndex,	newName,	converted.ints,		true	);	break;
+	case columnType::nominal:		initColumnAsNominalOrOrdinal(	colIndex,	newName,	converted.ints,		false	);	break;
+	case columnType::scale:			initColumnAsScale(				colIndex,	newName,	converted.dbls				);	break;
+	default:	converted.emptyValues =	initColumnAsNominalText(	colIndex,	newName,	values						);	break;
+	}
+
+	storeMissingData(newName, converted.emptyValues);
+}
 
-bool DataSetPackage::convertVecToDouble(int colIndex, const stringvec & values, doublevec & doubleValues, intstrmap & emptyValuesMap)
+bool DataSetPackage::stringRowsFitColumns(const stringvec & columnNames, const std::vector<stringvec> & values)
 {
-	JASPTIMER_SCOPE(DataSetPackage::convertVecToDouble);
+	JASPTIMER_SCOPE(DataSetPackage::stringRowsFitColumns);
 
-	emptyValuesMap.clear();
-	doubleValues.clear();
-	doubleValues.resize(values.size());
+	if(!_dataSet || columnNames.size() != values.size())
+		return false;
 
-	int row = 0;
-	for (const std::string & value : values)
+	for(size_t c=0; c<columnNames.size(); c++)
 	{
-		double doubleValue = static_cast<double>(NAN);
+		Column * column = _dataSet->column(columnNames[c]);
 
-		if (_dataSet->column(colIndex)->convertValueToDoubleForImport(value, doubleValue))
-		{
-			doubleValues[row] = doubleValue;
-
-			if (std::isnan(doubleValue) && value != ColumnUtils::emptyValue)
-				emptyValuesMap.insert(std::make_pair(row, value));
-		}
-		else
-		{
-			std::vector<double>().swap(doubleValues); //this clears doubleValues and guarentees its memory is released
+		if(!column || column->isComputed() || values[c].size() != values[0].size() || !column->stringValuesFitType(values[c]))
 			return false;
-		}
-
-		row++;
 	}
 
 	return true;
 }
 
+void DataSetPackage::appendRowsWithStrings(const stringvec & columnNames, const std::vector<stringvec> & values)
+{
+	JASPTIMER_SCOPE(DataSetPackage::appendRowsWithStrings);
 
+	const size_t firstRow = dataRowCount();
 
-void DataSetPackage::initColumnWithStrings(QVariant colId, const std::string & newName, const stringvec &values, const std::string & title, columnType desiredType)
-{
-	JASPTIMER_SCOPE(DataSetPackage::initColumnWithStrings);
-	
-	// interpret the column as a datatype
-	intset		uniqueValues;
-	intvec		intValues;
-	doublevec	doubleValues;
-	intstrmap	emptyValuesMap;
-	int			colIndex = getColIndex(colId);
+	beginSynchingData();
 
-	//If less unique integers than the thresholdScale then we think it must be ordinal: https://github.com/jasp-stats/INTERNAL-jasp/issues/270
-	bool	useCustomThreshold	= Settings::value(Settings::USE_CUSTOM_THRESHOLD_SCALE).toBool();
-	size_t	thresholdScale		= (useCustomThreshold ? Settings::value(Settings::THRESHOLD_SCALE) : Settings::defaultValue(Settings::THRESHOLD_SCALE)).toUInt();
+	_dataSet->appendEmptyRows(values.empty() ? 0 : values[0].size());
 
-	JASPTIMER_RESUME(DataSetPackage::initColumnWithStrings preamble);
-	bool valuesAreIntegers		= convertVecToInt(colIndex, values, intValues, uniqueValues, emptyValuesMap);
-		
-	size_t minIntForThresh		= thresholdScale > 2 ? 2 : 0;
+	stringvec changedColumns;
 
-	auto isNominalInt			= [&](){ return valuesAreIntegers && (desiredType == columnType::nominal || uniqueValues.size() == minIntForThresh); };
-	auto isOrdinal				= [&](){ return valuesAreIntegers && (desiredType == columnType::ordinal || (uniqueValues.size() >  minIntForThresh && uniqueValues.size() <= thresholdScale)); };
-	auto isScalar				= [&](){ return convertVecToDouble(colIndex, values, doubleValues, emptyValuesMap); };
-	
-	JASPTIMER_STOP(DataSetPackage::initColumnWithStrings preamble);
+	for(size_t c=0; c<columnNames.size(); c++)
+	{
+		Column		*	column		= _dataSet->column(columnNames[c]);
+		intstrmap		emptyValues	= _dataSet->missingData(columnNames[c]);
+		const size_t	knownEmpty	= emptyValues.size();
 
-	JASPTIMER_RESUME(DataSetPackage::initColumnWithStrings followup - initing columns);
-	
-	if		(isOrdinal())					initColumnAsNominalOrOrdinal(	colIndex,	newName,	intValues,		true	);
-	else if	(isNominalInt())				initColumnAsNominalOrOrdinal(	colIndex,	newName,	intValues,		false	);
-	else if	(isScalar())					initColumnAsScale(				colIndex,	newName,	doubleValues	);
-	else				emptyValuesMap =	initColumnAsNominalText(		colIndex,	newName,	values			);
-	
-	JASPTIMER_STOP(DataSetPackage::initColumnWithStrings followup - initing columns);
+		column->setStringValuesFrom(firstRow, values[c], emptyValues);
 
-	storeMissingData(newName, emptyValuesMap);
+		if(emptyValues.size() != knownEmpty)
+			storeMissingData(columnNames[c], emptyValues);
+
+		changedColumns.push_back(columnNames[c]);
+	}
+
+	stringvec	missingColumns;
+	strstrmap	changeNameColumns;
+
+	endSynchingData(changedColumns, missingColumns, changeNameColumns, true, false);
 }
 
 void DataSetPackage::initializeComputedColumns()
@@ -1488,6 +1496,21 @@ bool DataSetPackage::isColumnDifferentFromStringValues(const std::string & colum
 	return true;
 }
 
+uint64_t DataSetPackage::columnFingerprint(const std::string & columnName)
+{
+	Column * col = _dataSet->column(columnName);
+
+	return col ? col->fingerprint() : 0;
+}
+
+void DataSetPackage::setColumnFingerprint(QVariant colId, uint64_t fingerprint)
+{
+	int colIndex = getColIndex(colId);
+
+	if(colIndex >= 0 && colIndex < _dataSet->columnCount())
+		_dataSet->columns()[colIndex]->setFingerprint(fingerprint);
+}
+
 void DataSetPackage::renameColumn(const std::string & oldColumnName, const std::string & newColumnName)
 {
 	try
@@ -1703,14 +1726,20 @@ intvec DataSetPackage::getColumnDataInts(size_t columnIndex)
 {
 	if(_dataSet == nullptr) return {};
 
-	return _dataSet->columns()[columnIndex]->ints();
+	intspan ints = _dataSet->columns()[columnIndex]->ints();
+
+	return intvec(ints.begin(), ints.end());
 }
 
 doublevec DataSetPackage::getColumnDataDbls(size_t columnIndex)
 {
 	
-	return !_dataSet || !_dataSet->columns()[columnIndex] ? doublevec() : _dataSet->columns()[columnIndex]->dbls();
-	
+	if(!_dataSet || !_dataSet->columns()[columnIndex])
+		return doublevec();
+
+	doublespan dbls = _dataSet->columns()[columnIndex]->dbls();
+
+	return doublevec(dbls.begin(), dbls.end());
 }
 
 stringvec DataSetPackage::getColumnDataStrs(size_t columnIndex)
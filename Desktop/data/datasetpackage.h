@@ -144,6 +144,7 @@ public:
 				bool				isModified()						const	{ return _isModified;					   }
 				std::string			initialMD5()						const	{ return _initialMD5;						 }
 				bool				manualEdits()						const;
+				size_t				dataSetResets()						const	{ return _dataSetResets;				} ///< Goes up whenever the data is reset or loaded from a jaspfile, so anything remembered about the data from before can be recognized as outdated
 				QString				windowTitle()						const;
 				QString				description()						const;
 				QString				currentFile()						const	{ return _currentFile;						 }
@@ -198,7 +199,23 @@ public:
 				bool						initColumnAsNominalOrOrdinal(	QVariant colID,		const std::string & newName, const intvec		& values,	bool is_ordinal)											{ return initColumnAsNominalOrOrdinal(getColIndex(colID), newName, values, is_ordinal); }
 				intstrmap					initColumnAsNominalText(		QVariant colID,		const std::string & newName, const stringvec	& values,	const strstrmap & labels = strstrmap())						{ return initColumnAsNominalText(getColIndex(colID), newName, values, labels); }
 				void						initColumnWithStrings(			QVariant			colId,		const std::string & newName, const stringvec	& values,	const std::string & title = "", columnType desiredType = columnType::unknown);
+
+				///What initColumnWithStrings makes of a column of strings, split off so that the conversion of several columns can run in parallel
+				struct ConvertedStrings
+				{
+					columnType	type		= columnType::unknown;
+					intvec		ints;
+					doublevec	dbls;
+					intstrmap	emptyValues;
+				};
+
+				size_t						importThresholdScale() const;	///< Reads the settings, so call it on the main thread and pass it on to convertColumnStrings
+				void						convertColumnStrings(			size_t				colIndex,	const stringvec & values, size_t thresholdScale, ConvertedStrings & converted, columnType desiredType = columnType::unknown) const; ///< Only reads from the dataset, so may be called from several threads at once for different columns
+				void						initColumnWithConverted(		size_t				colIndex,	const std::string & newName, const stringvec	& values,	ConvertedStrings & converted);
 				void						initializeComputedColumns();
+
+				bool						stringRowsFitColumns(		const stringvec & columnNames, const std::vector<stringvec> & values);	///< Whether appendRowsWithStrings can add these values (per column) to the columns with these names without changing their types
+				void						appendRowsWithStrings(		const stringvec & columnNames, const std::vector<stringvec> & values);	///< Adds rows at the end of the data, filled with values for the columns in columnNames and empty for the rest
 				
 				void						pasteSpreadsheet(size_t row, size_t column, const std::vector<std::vector<QString>> & cells, const intvec & colTypes = intvec(), const QStringList & colNames = {});
 
@@ -213,6 +230,8 @@ public:
 
 				stringvec					getColumnNames();
 				bool						isColumnDifferentFromStringValues(const std::string & columnName, const stringvec & strVals);
+				uint64_t					columnFingerprint(		const std::string	& columnName);					///< Column::fingerprint or 0 if there is no such column
+				void						setColumnFingerprint(	QVariant			  colId, uint64_t fingerprint);
 				int							findIndexByName(const std::string & name)	const;
 
 				bool						getRowFilter(				int						row)		const;
@@ -349,8 +368,6 @@ private:
 				bool				setDescriptionOnLabel(const QModelIndex & index, const QString & newDescription);
 				QModelIndex			lastCurrentCell();
 				int					getColIndex(QVariant colID);
-				bool				convertVecToInt(int colId, const std::vector<std::string> &values, std::vector<int> &intValues, std::set<int> &uniqueValues, std::map<int, std::string> &emptyValuesMap);
-				bool				convertVecToDouble(int colId, const stringvec & values, doublevec & doubleValues, intstrmap & emptyValuesMap);
 
 
 private:
@@ -382,6 +399,7 @@ private:
 								_jaspVersion;
 
 	uint						_dataFileTimestamp;
+	size_t						_dataSetResets				= 0;
 
 	bool						_synchingData				= false;
 	std::map<std::string, bool> _columnNameUsedInEasyFilter;
@@ -162,5 +162,8 @@ void JASPExporter::saveAnalyses(archive *a)
 
 void JASPExporter::saveDatabase(archive * a)
 {
+	//A jaspfile always has the values in DataSet_#, so whatever is in MappedColumnStore needs to go there first
+	DatabaseInterface::singleton()->dataSetWriteMappedValuesToDB(DataSetPackage::pkg()->dataSet());
+
 	saveTempFile(a, DatabaseInterface::singleton()->dbFile(true));
 }
@@ -1,6 +1,9 @@
 #include "filtermodel.h"
 #include "utilities/jsonutilities.h"
 #include "columnencoder.h"
+#include "filterexpression.h"
+#include "stringutils.h"
+#include <algorithm>
 
 FilterModel::FilterModel(labelFilterGenerator * labelFilterGenerator)
 	: QObject(DataSetPackage::pkg()), _labelFilterGenerator(labelFilterGenerator)
@@ -160,6 +163,13 @@ void FilterModel::processFilterResult(int requestId)
 	if((requestId < _lastSentRequestId))
 		return;
 
+	if(_filterAppliedWithoutR)
+	{
+		//An engine just wrote the result of an older filter to the database, put the current one back
+		_applyFilterWithoutR();
+		return;
+	}
+
 	if(!(DataSetPackage::pkg()->dataSet() || DataSetPackage::pkg()->dataSet()->filter()))
 		return;
 
@@ -175,7 +185,7 @@ void FilterModel::processFilterResult(int requestId)
 
 void FilterModel::processFilterErrorMsg(QString filterErrorMsg, int requestId)
 {
-	if(requestId == _lastSentRequestId || requestId == -1)
+	if((requestId == _lastSentRequestId || requestId == -1) && !_filterAppliedWithoutR)
 		setFilterErrorMsg(filterErrorMsg);
 }
 
@@ -184,7 +194,61 @@ void FilterModel::sendGeneratedAndRFilter()
 	JASPTIMER_SCOPE(FilterModel::sendGeneratedAndRFilter);
 
 	setFilterErrorMsg("");
-	_lastSentRequestId = emit sendFilter(generatedFilter(), rFilter());
+
+	if(_applyFilterWithoutR())
+		return;
+
+	_filterAppliedWithoutR	= false;
+	_lastSentRequestId		= emit sendFilter(generatedFilter(), rFilter());
+}
+
+///Evaluates the label filters and the filter constructor directly when the user didn't write their own R filter, instead of going through R.
+///Returns false if R is needed after all.
+bool FilterModel::_applyFilterWithoutR()
+{
+	JASPTIMER_SCOPE(FilterModel::_applyFilterWithoutR);
+
+	DataSet * dataSet = DataSetPackage::pkg()->dataSet();
+
+	std::string strippedRFilter = stringUtils::stripRComments(fq(rFilter()));
+
+	if(!dataSet || !dataSet->filter() || stringUtils::trim(strippedRFilter) != "generatedFilter")
+		return false;
+
+	FilterExpression * expression = FilterExpression::fromDataSet(dataSet, fq(constructorJson()));
+
+	if(!expression)
+		return false;
+
+	boolvec filterResult = expression->evaluate(dataSet->rowCount());
+	delete expression;
+
+	_filterAppliedWithoutR = true;
+
+	//Same as rbridge_applyFilter, the previous result stays
+	if(std::none_of(filterResult.begin(), filterResult.end(), [](bool passes) { return passes; }))
+	{
+		setFilterErrorMsg("Filtered out all data..");
+		return true;
+	}
+
+	dataSet->db().transactionWriteBegin();
+	bool changed = dataSet->filter()->setFilterVector(filterResult);
+	dataSet->filter()->setErrorMsg("");
+	dataSet->filter()->incRevision();
+	dataSet->db().transactionWriteEnd();
+
+	emit filterErrorMsgChanged();
+
+	if(changed)
+	{
+		emit refreshAllAnalyses();
+		emit filterUpdated();
+	}
+
+	updateStatusBar();
+
+	return true;
 }
 
 void FilterModel::updateStatusBar()
@@ -90,6 +90,7 @@ signals:
 private:
 	bool _setGeneratedFilter(const QString& newGeneratedFilter);
 	bool _setRFilter(const QString& newRFilter);
+	bool _applyFilterWithoutR();
 
 private:
 	labelFilterGenerator	*	_labelFilterGenerator	= nullptr;
@@ -99,6 +100,7 @@ private:
 								_columnsUsedInRFilter;
 
 	int							_lastSentRequestId		= 0;
+	bool						_filterAppliedWithoutR	= false;	///< The current filter was evaluated by FilterExpression, so results of filters still running in R are outdated
 
 	UndoStack*					_undoStack				= nullptr;
 };
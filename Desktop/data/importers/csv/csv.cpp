@@ -26,8 +26,18 @@
 #include "utils.h"
 #include "utilities/qutils.h"
 #include "utilities/settings.h"
+#include "log.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define CSV_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
 
 using namespace std;
+namespace bip = boost::interprocess;
 using boost::algorithm::trim;
 
 CSV::CSV(const string &path)
@@ -72,9 +82,17 @@ void CSV::open()
 	if (readRaw())
 	{
 		determineEncoding();
+
+		if (_encoding == UTF8 && mapFile())
+		{
+			//No separate pass to count the rows, the importer gets those from tokenizing the records anyway
+			determineDelimiters(_mapped + _mappedPos, std::min(_mappedSize - _mappedPos, sizeof(_utf8Buffer)));
+			return;
+		}
+
 		determineNumRows();
 		readUtf8();
-		determineDelimiters();
+		determineDelimiters(_utf8Buffer, _utf8BufferEndPos);
 	}
 	else
 	{
@@ -255,48 +273,75 @@ bool CSV::readUtf8()
 	}
 	}
 
-	for (int i = 0 ; i < _utf8BufferEndPos; i++)
+	sanitizeUtf8(_utf8Buffer, _utf8BufferEndPos);
+
+	return true;
+}
+
+
+void CSV::sanitizeUtf8(char * buffer, int bufferSize)
+{
+	for (int i = 0 ; i < bufferSize; i++)
 	{
-		if ((unsigned char)_utf8Buffer[i] < 0x80) // ascii
+		if ((unsigned char)buffer[i] < 0x80) // ascii
 		{
 			continue;
 		}
-		else if ((unsigned char)_utf8Buffer[i] < 0xC0) // illegal
+		else if ((unsigned char)buffer[i] < 0xC0) // illegal
 		{
-			_utf8Buffer[i] = '.';
+			buffer[i] = '.';
 		}
-		else if ((unsigned char)_utf8Buffer[i] < 0xE0) // 2 bytes
+		else if ((unsigned char)buffer[i] < 0xE0) // 2 bytes
 		{
-			if (i < _utf8BufferEndPos - 1 && (unsigned char)_utf8Buffer[i+1] < 0x80)
-				_utf8Buffer[i] = '.';
+			if (i < bufferSize - 1 && (unsigned char)buffer[i+1] < 0x80)
+				buffer[i] = '.';
 			else
 				i += 1;
 		}
-		else if ((unsigned char)_utf8Buffer[i] < 0xF0) // 3 bytes
+		else if ((unsigned char)buffer[i] < 0xF0) // 3 bytes
 		{
-			if (i < _utf8BufferEndPos - 2 && (unsigned char)_utf8Buffer[i+1] < 0x80 && (unsigned char)_utf8Buffer[i+2] < 0x80)
-				_utf8Buffer[i] = '.';
+			if (i < bufferSize - 2 && (unsigned char)buffer[i+1] < 0x80 && (unsigned char)buffer[i+2] < 0x80)
+				buffer[i] = '.';
 			else
 				i += 2;
 		}
-		else if ((unsigned char)_utf8Buffer[i] < 0xF8) // 4 bytes
+		else if ((unsigned char)buffer[i] < 0xF8) // 4 bytes
 		{
-			if (i < _utf8BufferEndPos - 3 && (unsigned char)_utf8Buffer[i+1] < 0x80 && (unsigned char)_utf8Buffer[i+2] < 0x80 && (unsigned char)_utf8Buffer[i+3] < 0x80)
-				_utf8Buffer[i] = '.';
+			if (i < bufferSize - 3 && (unsigned char)buffer[i+1] < 0x80 && (unsigned char)buffer[i+2] < 0x80 && (unsigned char)buffer[i+3] < 0x80)
+				buffer[i] = '.';
 			else
 				i += 3;
 		}
 		else
 		{
-			_utf8Buffer[i] = '.';
+			buffer[i] = '.';
 		}
 	}
+}
+
+bool CSV::mapFile()
+{
+	try
+	{
+		_mapping	= bip::file_mapping(_path.c_str(), bip::read_only);
+		_region		= bip::mapped_region(_mapping, bip::read_only);
+	}
+	catch(std::exception & e)
+	{
+		Log::log() << "CSV could not map '" << _path << "' so it will be streamed instead: " << e.what() << std::endl;
+		return false;
+	}
+
+	_mapped		= static_cast<const char*>(_region.get_address());
+	_mappedSize	= _region.get_size();
+	_mappedPos	= _rawBufferStartPos; //Skips the BOM if there is one
+
+	_stream.close();
 
 	return true;
 }
 
-
-void CSV::determineDelimiters(size_t fromHere)
+void CSV::determineDelimiters(const char * buffer, int bufferSize, size_t fromHere)
 {
 	bool	inQuote		= false,
 			eol			= false;
@@ -306,13 +351,13 @@ void CSV::determineDelimiters(size_t fromHere)
 			tabs		= 0,
 			stopped		= 0;
 
-	for (int i = fromHere; i < _utf8BufferEndPos && eol == false; i++)
+	for (int i = fromHere; i < bufferSize && eol == false; i++)
 	{
-		char ch = _utf8Buffer[i];
+		char ch = buffer[i];
 
 		if (ch == '"')
 		{
-			if (inQuote && i + 1 < _utf8BufferEndPos && _utf8Buffer[i + 1] == '"')
+			if (inQuote && i + 1 < bufferSize && buffer[i + 1] == '"')
 				i++;
 			else
 				inQuote = !inQuote;
@@ -341,7 +386,7 @@ void CSV::determineDelimiters(size_t fromHere)
 		case '\n':
 			eol		= true;
 			stopped = i;
-			while(stopped < _utf8BufferEndPos && (_utf8Buffer[stopped] == '\r' || _utf8Buffer[stopped] == '\n'))
+			while(stopped < bufferSize && (buffer[stopped] == '\r' || buffer[stopped] == '\n'))
 				stopped++;
 			break;
 		}
@@ -365,7 +410,7 @@ void CSV::determineDelimiters(size_t fromHere)
 		//See https://github.com/jasp-stats/jasp-test-release/issues/1040 for problems with single column-csv that contain a space in the title.
 		
 		if(fromHere == 0) //We just checked the first line, maybe the second line is more useful?
-			determineDelimiters(stopped);
+			determineDelimiters(buffer, bufferSize, stopped);
 		else //The second line was as useless as the first one apparently.
 			_delim = ' ';
 	}
@@ -374,6 +419,7 @@ void CSV::determineDelimiters(size_t fromHere)
 void CSV::determineNumRows()
 {
 	_numRows = 0;
+
 	bool eof = true;
 
 	if (_utf8BufferEndPos == _utf8BufferStartPos)
@@ -428,7 +474,7 @@ void CSV::determineNumRows()
 	{
 		determineEncoding();
 		readUtf8();
-		determineDelimiters();
+		determineDelimiters(_utf8Buffer, _utf8BufferEndPos);
 	}
 
 }
@@ -438,6 +484,16 @@ bool CSV::readLine(vector<string> &items)
 	if (_eof)
 		return false;
 
+	if (_mapped)
+	{
+		std::string record;
+
+		while (items.empty() && readMapped(record, 1))
+			tokenizeRecords(record, _delim, [&](size_t, const char * value, size_t length) { items.push_back(std::string(value, length)); }, [](size_t){});
+
+		return !items.empty();
+	}
+
 	if (_utf8BufferEndPos == _utf8BufferStartPos)
 	{
 		bool success = readUtf8();
@@ -543,6 +599,284 @@ bool CSV::readLine(vector<string> &items)
 	return true;
 }
 
+bool CSV::readMapped(std::string & records, size_t atLeast)
+{
+	records.clear();
+
+	if (_mappedPos >= _mappedSize)
+	{
+		_eof = true;
+		return false;
+	}
+
+	size_t length = scanRecords(_mapped + _mappedPos, _mappedSize - _mappedPos, atLeast);
+
+	records.assign(_mapped + _mappedPos, length);
+	sanitizeUtf8(records.data(), records.size());
+
+	_mappedPos		+= length;
+	_filePosition	=  _mappedPos;
+
+	return true;
+}
+
+bool CSV::readRecords(std::string & records, size_t atLeast)
+{
+	if (_mapped)
+		return readMapped(records, atLeast);
+
+	records.clear();
+	records.swap(_unfinishedRecord);
+
+	if (_eof && records.empty())
+		return false;
+
+	bool	inQuote		= false;
+	size_t	scanned		= 0,
+			boundary	= 0; //Where the last complete record in records ends
+
+	//Uses the same quoting rules as readLine, so that a newline inside quotes does not end the record
+	auto scan = [&]()
+	{
+		for (; scanned < records.size(); scanned++)
+		{
+			char ch = records[scanned];
+
+			if (ch == '"')
+			{
+				if (inQuote && scanned + 1 == records.size())
+					return; //Might be an escaped quote, we'll know once the next bit is appended
+
+				if (inQuote && records[scanned + 1] == '"')
+					scanned++;
+				else
+					inQuote = !inQuote;
+			}
+			else if (!inQuote && (ch == '\r' || ch == '\n'))
+				boundary = scanned + 1;
+		}
+	};
+
+	scan();
+
+	while (boundary == 0 || boundary < atLeast)
+	{
+		if (_eof || (_utf8BufferEndPos == _utf8BufferStartPos && !readUtf8()))
+		{
+			_eof		= true;
+			boundary	= records.size();
+			break;
+		}
+
+		records.append(&_utf8Buffer[_utf8BufferStartPos], _utf8BufferEndPos - _utf8BufferStartPos);
+		_utf8BufferStartPos = _utf8BufferEndPos;
+
+		scan();
+	}
+
+	_unfinishedRecord.assign(records, boundary, std::string::npos);
+	records.resize(boundary);
+
+	return !records.empty();
+}
+
+void CSV::tokenizeRecords(const std::string & records, char delim, itemFunc item, recordFunc recordDone)
+{
+	//boost::algorithm::trim in the classic locale
+	auto isSpace = [](char ch) { return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r'; };
+
+	const char	*	data		= records.data();
+	const size_t	end			= records.size();
+	bool			inQuote		= false;
+	size_t			start		= 0,
+					items		= 0;
+
+	auto addItem = [&](size_t until)
+	{
+		size_t from = start;
+
+		while (from < until && isSpace(data[from]))			from++;
+		while (until > from && isSpace(data[until - 1]))	until--;
+
+		if (until - from >= 2 && data[from] == '"' && data[until - 1] == '"')
+		{
+			from++;
+			until--;
+		}
+
+		item(items++, data + from, until - from);
+	};
+
+	for (size_t i = 0; i < end; i++)
+	{
+		i = findStructural(data + i, data + end, inQuote ? '"' : delim) - data;
+
+		if (i == end)
+			break;
+
+		char ch = data[i];
+
+		if (ch == '"')
+		{
+			if (inQuote && i + 1 < end && data[i + 1] == '"')
+				i++;
+			else
+				inQuote = !inQuote;
+		}
+
+		if (inQuote)
+			continue;
+
+		if (ch == delim)
+		{
+			addItem(i);
+			start = i + 1;
+		}
+		else if (ch == '\r' || ch == '\n')
+		{
+			if (items > 0 || i > start)
+				addItem(i);
+
+			if (ch == '\r' && i + 1 < end && data[i + 1] == '\n')
+				i++;
+
+			start = i + 1;
+
+			if (items > 0)
+			{
+				recordDone(items);
+				items = 0;
+			}
+		}
+	}
+
+	if (items > 0 || end > start)
+		addItem(end);
+
+	if (items > 0)
+		recordDone(items);
+}
+
+const char * CSV::findStructural(const char * from, const char * end, char delim)
+{
+#ifdef CSV_SSE2
+	const __m128i	quotes	= _mm_set1_epi8('"'),
+					delims	= _mm_set1_epi8(delim),
+					crs		= _mm_set1_epi8('\r'),
+					lfs		= _mm_set1_epi8('\n');
+
+	for (; end - from >= 16; from += 16)
+	{
+		__m128i	chunk	= _mm_loadu_si128(reinterpret_cast<const __m128i*>(from)),
+				hits	= _mm_or_si128(	_mm_or_si128(_mm_cmpeq_epi8(chunk, quotes),	_mm_cmpeq_epi8(chunk, delims)),
+										_mm_or_si128(_mm_cmpeq_epi8(chunk, crs),	_mm_cmpeq_epi8(chunk, lfs)));
+		unsigned int mask = _mm_movemask_epi8(hits);
+
+		if (mask)
+		{
+#ifdef _MSC_VER
+			unsigned long first;
+			_BitScanForward(&first, mask);
+			return from + first;
+#else
+			return from + __builtin_ctz(mask);
+#endif
+		}
+	}
+#endif
+
+	for (; from < end; from++)
+		if (*from == '"' || *from == delim || *from == '\r' || *from == '\n')
+			return from;
+
+	return end;
+}
+
+size_t CSV::scanRecords(const char * data, size_t size, size_t atLeast)
+{
+	//Toggling on every quote ends up in the same state as readLine skipping escaped ones ("") inside quotes
+	const char	*	end		= data + size;
+	bool			inQuote	= false;
+
+	for (const char * at = findStructural(data, end, '"'); at < end; at = findStructural(at + 1, end, '"'))
+	{
+		if (*at == '"')
+		{
+			inQuote = !inQuote;
+			continue;
+		}
+
+		if (inQuote)
+			continue;
+
+		if (*at == '\r' && at + 1 < end && at[1] == '\n')
+			at++;
+
+		if (size_t(at + 1 - data) >= atLeast)
+			return at + 1 - data;
+	}
+
+	return size;
+}
+
+uint64_t CSV::hashWord(uint64_t hash, uint64_t word)
+{
+	//Each step is invertible for a given word, so a single changed word always changes the hash
+	hash = (hash ^ word) * 1099511628211ULL;
+	return hash ^ (hash >> 32);
+}
+
+uint64_t CSV::hash()
+{
+	return _mapped ? hashUpTo(_mappedPos) : 0;
+}
+
+uint64_t CSV::hashUpTo(size_t position)
+{
+	//Whole words are hashed once and kept in _hash, only the few bytes after the last of them are hashed again on every call.
+	//That makes the result the same no matter in which steps the file was read.
+	const size_t wholeWords = position - position % sizeof(uint64_t);
+
+	if (wholeWords < _hashedPos)
+	{
+		_hash		= _hashStart;
+		_hashedPos	= 0;
+	}
+
+	for (; _hashedPos < wholeWords; _hashedPos += sizeof(uint64_t))
+	{
+		uint64_t word;
+		std::memcpy(&word, _mapped + _hashedPos, sizeof(uint64_t));
+		_hash = hashWord(_hash, word);
+	}
+
+	uint64_t tail = 0;
+	std::memcpy(&tail, _mapped + wholeWords, position - wholeWords);
+
+	return hashWord(hashWord(_hash, tail), position);
+}
+
+bool CSV::endsOnLine() const
+{
+	return _mapped && _mappedPos > 0 && (_mapped[_mappedPos - 1] == '\n' || _mapped[_mappedPos - 1] == '\r');
+}
+
+bool CSV::skipTo(size_t position, uint64_t hash)
+{
+	if (!_mapped || position < _mappedPos || position > _mappedSize)
+		return false;
+
+	if (hashUpTo(position) != hash)
+		return false;
+
+	_mappedPos		= position;
+	_filePosition	= position;
+	_eof			= false;
+	_unfinishedRecord.clear();
+
+	return true;
+}
+
 long CSV::pos()
 {
 	return _filePosition;
@@ -561,6 +895,10 @@ long CSV::numRows()
 void CSV::close()
 {
 	_stream.close();
+
+	_region		= bip::mapped_region();
+	_mapping	= bip::file_mapping();
+	_mapped		= nullptr;
 }
 
 bool CSV::utf16to8(char *out, char *in, int outSize, int inSize, int &written, int &read, bool bigEndian)
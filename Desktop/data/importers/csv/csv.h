@@ -23,6 +23,9 @@
 #include <string>
 #include <stdint.h>
 #include <fstream>
+#include <functional>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 ///
 /// This files is used to read CSV files
@@ -30,6 +33,9 @@
 /// And otherwise it just looks at the characters and sees if any of the codes for multiple bytes etc are present.
 /// It also tries to determine the delimiter by looking at the first line and trying some fun heuristics.
 /// If it finds nothing (one column for instance, or something crazy) it defaults to comma
+///
+/// When the file turns out to be utf8 it is memory-mapped instead of streamed through _rawBuffer and _utf8Buffer,
+/// the records are then found and split by jumping from one quote, delimiter or newline to the next with findStructural.
 class CSV
 {
 public:
@@ -37,9 +43,23 @@ public:
 
 	void open();
 	bool readLine(std::vector<std::string> &items);
+	bool readRecords(std::string & records, size_t atLeast);	///< Replaces records with as many whole records as needed to get at least atLeast bytes of utf8, returns false at the end of the file. Meant to be split by tokenizeRecords, possibly in another thread
+	char delim() const { return _delim; }
+
+	typedef std::function<void(size_t item, const char * value, size_t length)>	itemFunc;
+	typedef std::function<void(size_t items)>										recordFunc;
+
+	static void tokenizeRecords(const std::string & records, char delim, itemFunc item, recordFunc recordDone); ///< Splits records exactly like readLine would, item is called for every (trimmed and unquoted) value and recordDone after each non-empty record
+	static const char * findStructural(const char * from, const char * end, char delim);				///< Returns the first quote, delim, \r or \n in [from, end) or end if there is none, 16 bytes at a time where SSE2 is available
+	static size_t		scanRecords(const char * data, size_t size, size_t atLeast);	///< Returns where the first line ending outside of quotes at or after atLeast ends, or size
+	bool			mapped()		const { return _mapped; }
+	uint64_t		hash();										///< Of the bytes read so far, only when mapped. Computed when asked for, so an import that never synchs does not pay for it
+	bool			endsOnLine()	const;						///< Whether the bytes read so far end with a line ending, only when mapped
+	bool			skipTo(size_t position, uint64_t hash);	///< Continues reading at position if the bytes before it have this hash, only when mapped
+
 	long pos();
 	long size();
-	long numRows();
+	long numRows();	///< Only counted up front when the file is streamed, a mapped one is counted by tokenizing its records
 	void close();
 
 	enum Status { OK = 0, NotRead, Empty };
@@ -59,11 +79,15 @@ private:
 
 	bool readRaw();
 	bool readUtf8();
+	bool mapFile();
+	bool readMapped(std::string & records, size_t atLeast);
 
 	void determineEncoding();
-	void determineDelimiters(size_t fromHere = 0);
+	void determineDelimiters(const char * buffer, int bufferSize, size_t fromHere = 0);
 	void determineNumRows();
 
+	static void sanitizeUtf8(char * buffer, int bufferSize); ///< Replaces bytes that cannot be utf8 with '.'
+
 private:
 
 	Status _status;
@@ -73,6 +97,19 @@ private:
 	std::string _path;
 	std::ifstream _stream;
 	bool _eof;
+	std::string _unfinishedRecord; ///< What readRecords read after the last complete record
+
+	boost::interprocess::file_mapping	_mapping;
+	boost::interprocess::mapped_region	_region;
+	const char						*	_mapped		= nullptr; ///< Start of the mapped file or nullptr if it is being streamed
+	size_t								_mappedPos	= 0,
+										_mappedSize	= 0;
+	uint64_t							_hash		= _hashStart;	///< Of the whole words before _hashedPos
+	size_t								_hashedPos	= 0;
+
+	static const uint64_t				_hashStart	= 14695981039346656037ULL; ///< FNV-1a offset basis, but the file is hashed a word at a time
+	static uint64_t						hashWord(uint64_t hash, uint64_t word);
+	uint64_t							hashUpTo(size_t position);					///< Of the first position bytes of the mapped file
 
 	char _rawBuffer[32768];
 	char _utf8Buffer[65536];
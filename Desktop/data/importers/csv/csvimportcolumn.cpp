@@ -1,5 +1,6 @@
 #include "csvimportcolumn.h"
 #include "timers.h"
+#include "columnutils.h"
 
 CSVImportColumn::CSVImportColumn(ImportDataSet* importDataSet, std::string name) : ImportColumn(importDataSet, name)
 {
@@ -7,26 +8,94 @@ CSVImportColumn::CSVImportColumn(ImportDataSet* importDataSet, std::string name)
 
 CSVImportColumn::CSVImportColumn(ImportDataSet *importDataSet, std::string name, long reserve) : ImportColumn(importDataSet, name)
 {
-	_data.reserve(reserve);
+	_values.ends.reserve(reserve);
 }
 
 CSVImportColumn::~CSVImportColumn()
 {
 	JASPTIMER_SCOPE(CSVImportColumn::~CSVImportColumn());
-	_data.clear();
+	_strings.clear();
 }
 
 size_t CSVImportColumn::size() const
 {
-	return _data.size();
+	return _materialized ? _strings.size() : _values.ends.size();
+}
+
+const stringvec & CSVImportColumn::allValuesAsStrings() const
+{
+	if(!_materialized)
+	{
+		JASPTIMER_SCOPE(CSVImportColumn::allValuesAsStrings materialize);
+
+		_strings.reserve(_values.ends.size());
+
+		size_t start = 0;
+		for(size_t end : _values.ends)
+		{
+			_strings.push_back(_values.chars.substr(start, end - start));
+			start = end;
+		}
+
+		_values			= Values();
+		_materialized	= true;
+	}
+
+	return _strings;
+}
+
+uint64_t CSVImportColumn::_fingerprintValues() const
+{
+	if(_materialized)
+		return ImportColumn::_fingerprintValues();
+
+	JASPTIMER_SCOPE(CSVImportColumn::_fingerprintValues);
+
+	uint64_t	fingerprint = 0;
+	size_t		start		= 0;
+
+	for(size_t row=0; row<_values.ends.size(); row++)
+	{
+		fingerprint	+= ColumnUtils::fingerprintCell(row, _values.chars.data() + start, _values.ends[row] - start);
+		start		 = _values.ends[row];
+	}
+
+	return fingerprint == 0 ? 1 : fingerprint; //Same as ColumnUtils::fingerprint
 }
 
 void CSVImportColumn::addValue(const std::string &value)
 {
-	_data.push_back(value);
+	addValue(value.data(), value.size());
 }
 
-const std::vector<std::string> &CSVImportColumn::getValues() const
+void CSVImportColumn::addValue(const char * value, size_t length)
 {
-	return _data;
+	_fingerprint = 0;
+
+	if(_materialized)	_strings.push_back(std::string(value, length));
+	else				_values.add(value, length);
+}
+
+void CSVImportColumn::append(const Values & values)
+{
+	_fingerprint = 0;
+
+	if(_materialized)
+	{
+		size_t start = 0;
+		for(size_t end : values.ends)
+		{
+			_strings.push_back(values.chars.substr(start, end - start));
+			start = end;
+		}
+		return;
+	}
+
+	const size_t offset = _values.chars.size();
+
+	_values.chars.append(values.chars);
+	_values.ends.reserve(_values.ends.size() + values.ends.size());
+
+	for(size_t end : values.ends)
+		_values.ends.push_back(offset + end);
 }
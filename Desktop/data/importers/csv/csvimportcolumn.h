@@ -5,21 +5,38 @@
 
 ///
 /// Storing a column during import of a CSV
+/// The values are kept back to back in a single buffer instead of as a string per cell, that saves an allocation per cell and a lot of memory for big files.
+/// allValuesAsStrings only turns them into a stringvec when it is needed, after which the buffer is released.
 class CSVImportColumn : public ImportColumn
 {
 public:
+	///A piece of a column, filled by a tokenizer thread and appended to the column afterwards
+	struct Values
+	{
+		void			add(const char * value, size_t length) { chars.append(value, length); ends.push_back(chars.size()); }
+
+		std::string				chars;
+		std::vector<size_t>		ends;	///< Where each value ends in chars
+	};
+
 							CSVImportColumn(ImportDataSet* importDataSet, std::string name);
 							CSVImportColumn(ImportDataSet* importDataSet, std::string name, long reserve);
 							~CSVImportColumn()	override;
 
 			size_t			size()									const	override;
-	const	stringvec	&	allValuesAsStrings()					const	override { return  _data; }
+	const	stringvec	&	allValuesAsStrings()					const	override;
 			void			addValue(const std::string &value);
-	const	stringvec	&	getValues()								const;
+			void			addValue(const char * value, size_t length);
+			void			append(const Values & values);
+
 
+protected:
+			uint64_t		_fingerprintValues()					const	override;	///< Hashes the buffer directly, so a sync of an unchanged column never needs to build the stringvec
 
 private:
-	stringvec _data;
+	mutable	Values			_values;
+	mutable	stringvec		_strings;
+	mutable	bool			_materialized = false;
 
 };
 
@@ -19,9 +19,15 @@
 #include "csv/csvimportcolumn.h"
 #include "csv/csv.h"
 #include "timers.h"
+#include "log.h"
+#include <thread>
+#include <exception>
+#include <memory>
 
 using namespace std;
 
+CSVImporter::ReadState	CSVImporter::_lastSynced;
+size_t					CSVImporter::_lastSyncedResets = 0;
 
 CSVImporter::CSVImporter() : Importer()
 {
@@ -32,7 +38,8 @@ ImportDataSet* CSVImporter::loadFile(const string &locator, std::function<void(i
 {
 	JASPTIMER_RESUME(CSVImporter::loadFile);
 
-	ImportDataSet* result = new ImportDataSet(this);
+	std::unique_ptr<ImportDataSet>	resultOwner(new ImportDataSet(this)); //Deletes it, and the columns it got, if anything below throws
+	ImportDataSet				*	result = resultOwner.get();
 	stringvec colNames;
 	CSV csv(locator);
 	csv.open();
@@ -41,6 +48,119 @@ ImportDataSet* CSVImporter::loadFile(const string &locator, std::function<void(i
 	vector<CSVImportColumn *> importColumns;
 	importColumns.reserve(colNames.size());
 
+	fixColumnNames(colNames);
+
+	//The columns belong to result right away, so they are cleaned up with it when reading fails
+	for (const string & colName : colNames)
+	{
+		importColumns.push_back(new CSVImportColumn(result, colName, csv.numRows()));
+		result->addColumn(importColumns.back());
+	}
+
+	unsigned long long progress;
+	unsigned long long lastProgress = -1;
+
+	// The file is read in chunks of whole records on this thread while the previous batch of chunks is being split into values by one thread per chunk.
+	// Each of those fills its own fragment of the columns, which are then appended in order so the rows stay as they were in the file.
+	typedef std::vector<CSVImportColumn::Values> Fragment;
+
+	const size_t	columnCount	= colNames.size(),
+					chunkSize	= 4 * 1024 * 1024,
+					threadCount	= std::max(1u, std::thread::hardware_concurrency());
+	const char		delim		= csv.delim();
+
+	auto tokenize = [columnCount, delim](const std::string & records, Fragment & fragment)
+	{
+		fragment.assign(columnCount, CSVImportColumn::Values());
+
+		CSV::tokenizeRecords(records, delim,
+			[&](size_t item, const char * value, size_t length)	{ if(item < columnCount) fragment[item].add(value, length);	},
+			[&](size_t items)									{ for(size_t i = items; i < columnCount; i++) fragment[i].add("", 0); }); //add empty vals for missing columns
+	};
+
+	auto readBatch = [&](stringvec & chunks)
+	{
+		size_t read = 0;
+		while(read < chunks.size() && csv.readRecords(chunks[read], chunkSize))
+			read++;
+		return read;
+	};
+
+	stringvec							batch(threadCount),
+										nextBatch(threadCount);
+	std::vector<Fragment>				fragments(threadCount);
+	std::vector<std::exception_ptr>		errors(threadCount);
+	size_t								batchSize = readBatch(batch);
+
+	while (batchSize > 0)
+	{
+		//The tokenizers must be joined before anything is thrown, otherwise destroying them would terminate JASP
+		std::vector<std::thread>	tokenizers;
+		size_t						nextBatchSize = 0;
+		std::exception_ptr			readError;
+
+		try
+		{
+			for(size_t i=0; i<batchSize; i++)
+				tokenizers.emplace_back([&, i]()
+				{
+					try						{ tokenize(batch[i], fragments[i]);	}
+					catch(...)				{ errors[i] = std::current_exception();	}
+				});
+
+			nextBatchSize = readBatch(nextBatch);
+		}
+		catch(...)	{ readError = std::current_exception(); }
+
+		for(std::thread & tokenizer : tokenizers)
+			tokenizer.join();
+
+		if(readError)
+			std::rethrow_exception(readError);
+
+		for(size_t i=0; i<batchSize; i++)
+		{
+			if(errors[i])
+				std::rethrow_exception(errors[i]);
+
+			for(size_t c=0; c<columnCount; c++)
+				importColumns[c]->append(fragments[i][c]);
+
+			Fragment().swap(fragments[i]);
+		}
+
+		progress = 50 * csv.pos() / csv.size();
+		if (progress != lastProgress)
+		{
+			progressCallback(progress);
+			lastProgress = progress;
+		}
+
+		batch.swap(nextBatch);
+		batchSize = nextBatchSize;
+	}
+
+	_read = ReadState();
+
+	if (csv.mapped() && csv.endsOnLine() && columnCount > 0)
+	{
+		_read.path			= locator;
+		_read.columnNames	= colNames;
+		_read.length		= csv.pos();
+		_read.hash			= csv.hash();
+		_read.rows			= importColumns[0]->size();
+	}
+
+	// Build dictionary for sync.
+	result->buildDictionary();
+
+	JASPTIMER_STOP(CSVImporter::loadFile);
+
+	return resultOwner.release();
+}
+
+void CSVImporter::fixColumnNames(stringvec & colNames)
+{
 	int colNo = 0;
 	for (stringvec::iterator it = colNames.begin(); it != colNames.end(); ++it, ++colNo)
 	{
@@ -63,42 +183,73 @@ ImportDataSet* CSVImporter::loadFile(const string &locator, std::function<void(i
 				colName = colName + "_" + std::to_string(colNo + 1);
 
 		*it = colName;
-
-		importColumns.push_back(new CSVImportColumn(result, colName, csv.numRows()));
 	}
+}
 
-	unsigned long long progress;
-	unsigned long long lastProgress = -1;
+bool CSVImporter::syncAppendedRows(const string &locator, std::function<void(int)> progressCallback)
+{
+	JASPTIMER_SCOPE(CSVImporter::syncAppendedRows);
+
+	if (_lastSyncedResets != DataSetPackage::pkg()->dataSetResets() || _lastSynced.path != locator || _lastSynced.rows != size_t(DataSetPackage::pkg()->dataRowCount()))
+		return false;
+
+	CSV csv(locator);
+	csv.open();
+
+	stringvec colNames;
 
-	size_t columnCount = colNames.size();
+	if (!csv.mapped() || !csv.readLine(colNames))
+		return false;
 
-	stringvec line;
-	bool success = csv.readLine(line);
+	fixColumnNames(colNames);
 
-	while (success)
+	// The hash also covers the header, but checking the names first is cheap
+	if (colNames != _lastSynced.columnNames || !csv.skipTo(_lastSynced.length, _lastSynced.hash))
+		return false;
+
+	const size_t			columnCount = colNames.size();
+	std::vector<stringvec>	values(columnCount);
+	std::string				records;
+
+	while (csv.readRecords(records, 4 * 1024 * 1024))
 	{
-		progress = 50 * csv.pos() / csv.size();
-		if (progress != lastProgress)
+		CSV::tokenizeRecords(records, csv.delim(),
+			[&](size_t item, const char * value, size_t length)	{ if(item < columnCount) values[item].push_back(std::string(value, length));	},
+			[&](size_t items)									{ for(size_t i = items; i < columnCount; i++) values[i].push_back("");			});
+
+		progressCallback(50 * csv.pos() / csv.size());
+	}
+
+	if (!csv.endsOnLine()) //The last row might still be being written, so leave it to a full synch
+		return false;
+
+	const size_t appended = values[0].size();
+
+	if (appended > 0)
+	{
+		if (!DataSetPackage::pkg()->stringRowsFitColumns(colNames, values))
+			return false;
+
+		if (!emit DataSetPackage::pkg()->checkDoSync())
 		{
-			progressCallback(progress);
-			lastProgress = progress;
+			_lastSynced = ReadState();
+			return true;
 		}
 
-		if (line.size() != 0) //ignore empty lines
-            for(size_t i = 0; i<columnCount; i++)
-                importColumns.at(i)->addValue(i < line.size() ? line[i] : ""); //add components and add empty vals for missing columns
+		Log::log() << "Only rows were appended to '" << locator << "', synching the " << appended << " new ones." << std::endl;
 
-		line.clear();
-		success = csv.readLine(line);
+		DataSetPackage::pkg()->appendRowsWithStrings(colNames, values);
 	}
 
-	for (vector<CSVImportColumn *>::iterator it = importColumns.begin(); it != importColumns.end(); ++it)
-		result->addColumn(*it);
+	_lastSynced.length	=  csv.pos();
+	_lastSynced.hash	=  csv.hash();
+	_lastSynced.rows	+= appended;
 
-	// Build dictionary for sync.
-	result->buildDictionary();
-
-	JASPTIMER_STOP(CSVImporter::loadFile);
+	return true;
+}
 
-	return result;
+void CSVImporter::syncedWithFile(bool synced)
+{
+	_lastSynced			= synced ? _read : ReadState();
+	_lastSyncedResets	= DataSetPackage::pkg()->dataSetResets();
 }
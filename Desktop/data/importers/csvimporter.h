@@ -31,9 +31,27 @@ public:
 	CSVImporter();
 
 protected:
-	ImportDataSet* loadFile(const std::string &locator, std::function<void(int)> progressCallback) override;
+	ImportDataSet*	loadFile(			const std::string &locator, std::function<void(int)> progressCallback) override;
+	bool			syncAppendedRows(	const std::string &locator, std::function<void(int)> progressCallback) override;
+	void			syncedWithFile(bool synced) override;
 
 private:
+	static void		fixColumnNames(stringvec & colNames);
+
+	///What loadFile read from a file, so that the next synch can tell whether rows were only appended since
+	struct ReadState
+	{
+		std::string	path;
+		stringvec	columnNames;
+		size_t		length	= 0,	///< Up to and including the last line ending
+					rows	= 0;
+		uint64_t	hash	= 0;	///< Of the first length bytes, see CSV::hash
+	};
+
+	ReadState			_read;
+	static ReadState	_lastSynced;	///< Static because a new importer is made for every synch, only valid while DataSetPackage::dataSetResets() is still _lastSyncedResets
+	static size_t		_lastSyncedResets;
+
 	JASPTIMER_CLASS(CSVImporter);
 };
 
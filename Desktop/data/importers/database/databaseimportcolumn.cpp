@@ -1,9 +1,33 @@
 #include "databaseimportcolumn.h"
 #include "utilities/qutils.h"
+#include <QLocale>
+#include <cmath>
+#include <limits>
 
-DatabaseImportColumn::DatabaseImportColumn(ImportDataSet* importDataSet, std::string name, QMetaType type) 
+DatabaseImportColumn::DatabaseImportColumn(ImportDataSet* importDataSet, std::string name, QMetaType type, size_t reserve)
 	: ImportColumn(importDataSet, name), _type(type)
 {
+	typedef QMetaType::Type MT;
+
+	switch(_type.id())
+	{
+	case MT::Int:
+	case MT::UInt:
+		_storedAs = columnType::nominal;
+		_ints.reserve(reserve);
+		break;
+
+	case MT::Double:
+	case MT::Float:
+		_storedAs = columnType::scale;
+		_doubles.reserve(reserve);
+		break;
+
+	default: //QDate, QDateTime, Char, QString and the rest
+		_storedAs = columnType::nominalText;
+		_strings.reserve(reserve);
+		break;
+	}
 }
 
 DatabaseImportColumn::~DatabaseImportColumn()
@@ -12,26 +36,72 @@ DatabaseImportColumn::~DatabaseImportColumn()
 
 size_t DatabaseImportColumn::size() const
 {
-	return _data.size();
+	switch(_storedAs)
+	{
+	case columnType::nominal:	return _ints.size();
+	case columnType::scale:		return _doubles.size();
+	default:					return _strings.size();
+	}
 }
 
 const stringvec & DatabaseImportColumn::allValuesAsStrings() const 
 { 
-	static stringvec strs;
-	strs.resize(_data.size());
-	
-	for(size_t i=0; i<_data.size(); i++)
-		strs[i] = fq(_data[i].toString());
-	
-	return  strs;
+	static thread_local stringvec strs;
+
+	switch(_storedAs)
+	{
+	case columnType::nominal:
+		strs.resize(_ints.size());
+		for(size_t i=0; i<_ints.size(); i++)
+			strs[i] = _ints[i] == std::numeric_limits<int>::lowest() ? "" : std::to_string(_ints[i]);
+		return strs;
+
+	case columnType::scale:
+		strs.resize(_doubles.size());
+		for(size_t i=0; i<_doubles.size(); i++)
+			strs[i] = std::isnan(_doubles[i]) ? "" : fq(QString::number(_doubles[i], 'g', QLocale::FloatingPointShortest));
+		return strs;
+
+	default:
+		return _strings;
+	}
 }
 
 void DatabaseImportColumn::addValue(const QVariant & value)
 {
-	_data.push_back(value);
+	switch(_storedAs)
+	{
+	case columnType::nominal:	_ints.push_back(	value.isNull() ? std::numeric_limits<int>::lowest()	: value.toInt()			);	break;
+	case columnType::scale:		_doubles.push_back(	value.isNull() ? NAN								: value.toDouble()		);	break;
+	default:					_strings.push_back(	value.isNull() ? ""									: fq(value.toString())	);	break;
+	}
 }
 
-const std::vector<QVariant> &DatabaseImportColumn::getValues() const
+QVariant DatabaseImportColumn::maxValue() const
 {
-	return _data;
+	switch(_storedAs)
+	{
+	case columnType::nominal:
+	{
+		int highest = std::numeric_limits<int>::lowest();
+		for(int i : _ints)
+			highest = std::max(highest, i);
+
+		return highest == std::numeric_limits<int>::lowest() ? QVariant() : QVariant(highest);
+	}
+
+	case columnType::scale:
+	{
+		double highest = NAN;
+		for(double d : _doubles)
+			if(!std::isnan(d) && (std::isnan(highest) || d > highest))
+				highest = d;
+
+		return std::isnan(highest) ? QVariant() : QVariant(highest);
+	}
+
+	default:
+		//Which text is the highest depends on the collation of the database, so only a numeric key can be compared here
+		return QVariant();
+	}
 }
@@ -3,25 +3,33 @@
 
 #include "../importcolumn.h"
 #include <QMetaType>
+#include <QVariant>
 ///
 /// Storing a column during import from a database
+/// The values are converted as they are fetched, into ints, doubles or strings depending on the type of the field. NULL becomes a missing value.
 class DatabaseImportColumn : public ImportColumn
 {
 public:
-									DatabaseImportColumn(ImportDataSet* importDataSet, std::string name, QMetaType type);
+									DatabaseImportColumn(ImportDataSet* importDataSet, std::string name, QMetaType type, size_t reserve = 0);
 									~DatabaseImportColumn()	override;
 
 	size_t							size()									const	override;
-	const stringvec				&	allValuesAsStrings()					const	override;
+	const stringvec				&	allValuesAsStrings()					const	override;	///< Reference returned only valid till the next time this function is called on this thread. (static stringvec)
 	void							addValue(const QVariant & value);
-	const std::vector<QVariant> &	getValues()								const;
 	QMetaType						type()									const { return _type; }
+	columnType						storedAs()								const { return _storedAs; }	///< scale for doubles(), nominal for ints() and nominalText for strings()
+	QVariant						maxValue()								const;						///< The highest value that is not missing, or an invalid QVariant if there is none or the column holds text
 
+	const intvec				&	ints()									const { return _ints;		}
+	const doublevec				&	doubles()								const { return _doubles;	}
+	const stringvec				&	strings()								const { return _strings;	}
 
 private:
-	std::vector<QVariant>	_data;
 	QMetaType				_type;
-
+	columnType				_storedAs;
+	intvec					_ints;
+	doublevec				_doubles;
+	stringvec				_strings;
 };
 
 #endif // CSVIMPORTCOLUMN_H
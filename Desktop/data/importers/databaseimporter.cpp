@@ -3,8 +3,12 @@
 #include <QSqlField>
 #include "database/databaseimportcolumn.h"
 #include "utils.h"
+#include "log.h"
 
-ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, std::function<void(int)> progressCallback)
+DatabaseImporter::ReadState	DatabaseImporter::_lastSynced;
+size_t						DatabaseImporter::_lastSyncedResets = 0;
+
+void DatabaseImporter::connect(const std::string &locator)
 {
 	// locator is the result of DatabaseConnectionInfo::toJson, so:
 	Json::Value json;
@@ -19,92 +23,158 @@ ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, std::func
 										.arg(_info._hostname + ":" + tq(std::to_string(_info._port)))
 										.arg(_info._username)
 										.arg(_info.lastError())));
-	
-	
-	
-	QSqlQuery	query	= _info.runQuery();
-	float		progDiv	= 100.0f / float(query.size());
+}
+
+ImportDataSet * DatabaseImporter::readRows(QSqlQuery & query, std::function<void(int)> progressCallback)
+{
+	JASPTIMER_SCOPE(DatabaseImporter::readRows);
+
+	// The query is forward only, so each row is converted into the typed buffers of the columns as it comes in and then forgotten
+	const int	rows	= query.size(); //-1 if the driver does not know beforehand
 	QSqlRecord  record	= query.record();
 	
 	ImportDataSet * data = new ImportDataSet(this);
+	std::vector<DatabaseImportColumn*> columns;
 
 	for(int i=0; i<record.count(); i++)
-		data->addColumn(new DatabaseImportColumn(data, fq(record.fieldName(i)), record.field(i).metaType()));
+	{
+		columns.push_back(new DatabaseImportColumn(data, fq(record.fieldName(i)), record.field(i).metaType(), std::max(0, rows)));
+		data->addColumn(columns.back());
+	}
 												
 	long lastProgress = Utils::currentMillis();	
 		
-	do
+	while(query.next())
 	{
-		if(lastProgress + 1000 < Utils::currentMillis())
+		if(rows > 0 && lastProgress + 1000 < Utils::currentMillis())
 		{
-			progressCallback(int(progDiv * query.at()));
+			progressCallback(int(100.0f * query.at() / rows));
 			lastProgress = Utils::currentMillis();	
 		}
 
-		if(query.isValid())
-			for(int i=0; i<record.count(); i++)
-				static_cast<DatabaseImportColumn*>(data->getColumn(i))->addValue(query.value(i));
+		for(size_t i=0; i<columns.size(); i++)
+			columns[i]->addValue(query.value(i));
 	}
-	while(query.next());
 
-	_info.close();
-	
 	data->buildDictionary(); //Not necessary for reading from database but synching will break otherwise...
 	
 	return data;
 }
 
-void DatabaseImporter::initColumn(QVariant colId, ImportColumn *importColumn)
+ImportDataSet * DatabaseImporter::loadFile(const std::string &locator, std::function<void(int)> progressCallback)
 {
-	JASPTIMER_SCOPE(DatabaseImporter::initColumn);
-	
-	typedef QMetaType::Type MT;
-	
-	DatabaseImportColumn * col = static_cast<DatabaseImportColumn*>(importColumn);
+	connect(locator);
 	
-	switch(col->type().id())
-	{
-	default:
-	case MT::QDate:			//These could later get their own handler, dependent on https://github.com/jasp-stats/INTERNAL-jasp/issues/312 and https://github.com/jasp-stats/jasp-issues/issues/606
-	case MT::QDateTime: 
-	case MT::Char:
-	case MT::QString:
+	QSqlQuery		query	= _info.runQuery();
+	ImportDataSet * data	= readRows(query, progressCallback);
+
+	_info.close();
+
+	_read = ReadState();
+
+	if(!_info._keyColumn.isEmpty())
 	{
-		stringvec asStrings;
-		asStrings.reserve(col->size());
-		
-		for(const QVariant & v : col->getValues())
-			asStrings.push_back(fq(v.toString()));
-		
-		initColumnAsNominalText(colId, col->name(), asStrings);
-		break;
+		DatabaseImportColumn * keyColumn = findColumn(data, fq(_info._keyColumn));
+
+		if(!keyColumn)
+			Log::log() << "Key column '" << fq(_info._keyColumn) << "' is not part of the results of the query, so every synch will run the entire query." << std::endl;
+		else if(keyColumn->storedAs() != columnType::nominal && keyColumn->storedAs() != columnType::scale)
+			Log::log() << "Key column '" << fq(_info._keyColumn) << "' does not hold numbers, how its text is ordered depends on the database so every synch will run the entire query." << std::endl;
+		else
+		{
+			_read.locator	= locator;
+			_read.rows		= data->rowCount();
+			_read.lastKey	= keyColumn->maxValue(); //Invalid if there are no rows yet, then the next synch just runs the entire query
+
+			for(ImportColumn * col : *data)
+				_read.columnNames.push_back(col->name());
+		}
 	}
-		
-	case MT::Int:
-	case MT::UInt:
+	
+	return data;
+}
+
+bool DatabaseImporter::syncAppendedRows(const std::string &locator, std::function<void(int)> progressCallback)
+{
+	JASPTIMER_SCOPE(DatabaseImporter::syncAppendedRows);
+
+	if (_lastSyncedResets != DataSetPackage::pkg()->dataSetResets() || _lastSynced.locator != locator || !_lastSynced.lastKey.isValid() || _lastSynced.rows != size_t(DataSetPackage::pkg()->dataRowCount()))
+		return false;
+
+	connect(locator);
+
+	QSqlQuery		query	= _info.runQueryAfterKey(_lastSynced.lastKey);
+	ImportDataSet * data	= readRows(query, progressCallback);
+
+	_info.close();
+
+	stringvec				colNames;
+	std::vector<stringvec>	values;
+
+	for(ImportColumn * col : *data)
 	{
-		std::vector<int> asInts;
-		asInts.reserve(col->size());
-		
-		for(const QVariant & v : col->getValues())
-			asInts.push_back(v.toInt());
-		
-		initColumnAsNominalOrOrdinal(colId, col->name(), asInts, true);
-		break;
+		colNames.push_back(col->name());
+		values.push_back(col->allValuesAsStrings());
 	}
-		
-	case MT::Double:
-	case MT::Float:
+
+	const size_t			appended	= data->rowCount();
+	DatabaseImportColumn *	keyColumn	= findColumn(data, fq(_info._keyColumn));
+	QVariant				lastKey		= keyColumn ? keyColumn->maxValue() : QVariant();
+
+	delete data;
+
+	if (colNames != _lastSynced.columnNames)
+		return false;
+
+	if (appended > 0)
 	{
-		std::vector<double> asDoubles;
-		asDoubles.reserve(col->size());
-		
-		for(const QVariant & v : col->getValues())
-			asDoubles.push_back(v.toDouble());
-		
-		initColumnAsScale(colId, col->name(), asDoubles);
-		break;
+		if (!DataSetPackage::pkg()->stringRowsFitColumns(colNames, values))
+			return false;
+
+		if (!emit DataSetPackage::pkg()->checkDoSync())
+		{
+			_lastSynced = ReadState();
+			return true;
+		}
+
+		Log::log() << "Synching the " << appended << " rows of the database with a key above the last one seen." << std::endl;
+
+		DataSetPackage::pkg()->appendRowsWithStrings(colNames, values);
+
+		_lastSynced.lastKey	=  lastKey;
+		_lastSynced.rows	+= appended;
 	}
-			
+
+	return true;
+}
+
+DatabaseImportColumn * DatabaseImporter::findColumn(ImportDataSet * data, const std::string & name)
+{
+	for(ImportColumn * col : *data)
+		if(col->name() == name)
+			return static_cast<DatabaseImportColumn*>(col);
+
+	return nullptr;
+}
+
+void DatabaseImporter::syncedWithFile(bool synced)
+{
+	_lastSynced			= synced ? _read : ReadState();
+	_lastSyncedResets	= DataSetPackage::pkg()->dataSetResets();
+}
+
+void DatabaseImporter::initColumn(QVariant colId, ImportColumn *importColumn)
+{
+	JASPTIMER_SCOPE(DatabaseImporter::initColumn);
+	
+	DatabaseImportColumn * col = static_cast<DatabaseImportColumn*>(importColumn);
+	
+	//The values were already converted to the right type while fetching them, see DatabaseImportColumn::addValue
+	switch(col->storedAs())
+	{
+	default:					//Dates could later get their own handler, dependent on https://github.com/jasp-stats/INTERNAL-jasp/issues/312 and https://github.com/jasp-stats/jasp-issues/issues/606
+	case columnType::nominalText:	initColumnAsNominalText(colId, col->name(), col->strings());				break;
+	case columnType::nominal:		initColumnAsNominalOrOrdinal(colId, col->name(), col->ints(), true);		break;
+	case columnType::scale:			initColumnAsScale(colId, col->name(), col->doubles());						break;
 	}
 }
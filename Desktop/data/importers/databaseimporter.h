@@ -4,6 +4,8 @@
 #include "importer.h"
 #include "data/databaseconnectioninfo.h"
 
+class DatabaseImportColumn;
+
 class DatabaseImporter : public Importer
 {
 	Q_DECLARE_TR_FUNCTIONS(DatabaseImporter)
@@ -15,8 +17,32 @@ public:
 	
 	ImportDataSet* loadFile(const std::string &locator, std::function<void(int)> progressCallback) override;
 	void initColumn(QVariant colId, ImportColumn * importColumn) override;
+	void prepareColumn(size_t, ImportColumn *) override {} ///< initColumn uses the typed values of the column directly, so there is nothing to convert beforehand
 	
 	DatabaseConnectionInfo _info;
+
+protected:
+	bool			syncAppendedRows(	const std::string &locator, std::function<void(int)> progressCallback) override;
+	void			syncedWithFile(bool synced) override;
+
+private:
+	void			connect(const std::string & locator);
+	ImportDataSet *	readRows(QSqlQuery & query, std::function<void(int)> progressCallback);
+
+	static DatabaseImportColumn * findColumn(ImportDataSet * data, const std::string & name);
+
+	///What loadFile read, so that a synch with Info::_keyColumn set only needs to fetch the rows after the last key
+	struct ReadState
+	{
+		std::string	locator;
+		stringvec	columnNames;
+		size_t		rows	= 0;
+		QVariant	lastKey;
+	};
+
+	ReadState			_read;
+	static ReadState	_lastSynced;	///< Static because a new importer is made for every synch, only valid while DataSetPackage::dataSetResets() is still _lastSyncedResets
+	static size_t		_lastSyncedResets;
 };
 
 #endif // DATABASEIMPORTER_H
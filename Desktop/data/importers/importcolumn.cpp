@@ -15,6 +15,19 @@ ImportColumn::~ImportColumn()
 }
 
 
+uint64_t ImportColumn::fingerprint() const
+{
+	if(!_fingerprint)
+		_fingerprint = _fingerprintValues();
+
+	return _fingerprint;
+}
+
+uint64_t ImportColumn::_fingerprintValues() const
+{
+	return ColumnUtils::fingerprint(allValuesAsStrings());
+}
+
 std::string ImportColumn::name() const
 {
 	return _name;
@@ -4,6 +4,7 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <cstdint>
 #include "columntype.h"
 
 class ImportDataSet;
@@ -20,12 +21,16 @@ public:
 
 	virtual			size_t				size()									const = 0;
 	virtual const	stringvec		&	allValuesAsStrings()					const = 0;
+					uint64_t			fingerprint()							const;	///< ColumnUtils::fingerprint of allValuesAsStrings, used by Importer::syncDataSet to see whether a column changed. Calculated once
 					std::string			name()									const;
 					void				changeName(const std::string & name);
 
 protected:
-	ImportDataSet * _importDataSet;
-	std::string		_name;
+	virtual			uint64_t			_fingerprintValues()					const;
+
+	ImportDataSet *		_importDataSet;
+	std::string			_name;
+	mutable uint64_t	_fingerprint = 0;
 };
 
 #endif // IMPORTCOLUMN_H
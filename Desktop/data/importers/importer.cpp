@@ -3,6 +3,9 @@
 #include "utilities/settings.h"
 #include "log.h"
 #include <QVariant>
+#include <thread>
+#include <exception>
+#include <unordered_map>
 
 Importer::~Importer() {}
 
@@ -25,14 +28,48 @@ void Importer::loadDataSet(const std::string &locator, std::function<void(int)>
 		DataSetPackage::pkg()->setDataSetSize(columnCount, rowCount);
 
 
-		int colNo = 0;
-		for (ImportColumn *& importColumn : *importDataSet)
+		// Working out what type each column is and converting its values only reads, so a group of columns is prepared in parallel.
+		// Putting them in the dataset is done in order on this thread afterwards, because DataSetPackage and the database are not threadsafe.
+		const int groupSize	= std::max(1u, std::thread::hardware_concurrency());
+		_thresholdScale		= DataSetPackage::pkg()->importThresholdScale();
+
+		for (int groupStart = 0; groupStart < columnCount; groupStart += groupSize)
 		{
-			progressCallback(50 + 25 * colNo / columnCount);
-			initColumn(colNo, importColumn);
-			delete importColumn;
-			importColumn = nullptr;
-			colNo++;
+			const int						groupEnd = std::min(columnCount, groupStart + groupSize);
+			std::vector<std::thread>		preparers;
+			std::vector<std::exception_ptr>	errors(groupEnd - groupStart);
+
+			for (int colNo = groupStart; colNo < groupEnd; colNo++)
+				_prepared[importDataSet->getColumn(colNo)]; //Created here so the threads only have to look them up
+
+			for (int colNo = groupStart; colNo < groupEnd; colNo++)
+				preparers.emplace_back([&, colNo]()
+				{
+					try			{ prepareColumn(colNo, importDataSet->getColumn(colNo));	}
+					catch(...)	{ errors[colNo - groupStart] = std::current_exception();	}
+				});
+
+			for (std::thread & preparer : preparers)
+				preparer.join();
+
+			for (const std::exception_ptr & error : errors)
+				if (error)
+				{
+					_prepared.clear();
+					std::rethrow_exception(error);
+				}
+
+			for (int colNo = groupStart; colNo < groupEnd; colNo++)
+			{
+				ImportColumn *& importColumn = *(importDataSet->begin() + colNo);
+
+				progressCallback(50 + 25 * colNo / columnCount);
+				initColumn(colNo, importColumn);
+				DataSetPackage::pkg()->setColumnFingerprint(colNo, importColumn->fingerprint());
+				_prepared.erase(importColumn);
+				delete importColumn;
+				importColumn = nullptr;
+			}
 		}
 
 		DataSetPackage::pkg()->dataSet()->endBatchedToDB([&](float f){ progressCallback(75 + f * 25); });
@@ -42,16 +79,34 @@ void Importer::loadDataSet(const std::string &locator, std::function<void(int)>
 	importDataSet->clearColumns();
 	delete importDataSet;
 	DataSetPackage::pkg()->endLoadingData();
+
+	syncedWithFile(true);
 }
 
 void Importer::initColumn(QVariant colId, ImportColumn *importColumn)
 {
 	JASPTIMER_SCOPE(Importer::initColumn);
-	initColumnWithStrings(colId, importColumn->name(),  importColumn->allValuesAsStrings());
+
+	auto prepared = _prepared.find(importColumn);
+
+	if(prepared == _prepared.end())	initColumnWithStrings(colId, importColumn->name(),  importColumn->allValuesAsStrings());
+	else								DataSetPackage::pkg()->initColumnWithConverted(colId.toInt(), importColumn->name(), importColumn->allValuesAsStrings(), prepared->second);
+}
+
+void Importer::prepareColumn(size_t colNo, ImportColumn *importColumn)
+{
+	importColumn->fingerprint(); //Calculated here so it happens in parallel, and before the strings are needed for the conversion
+	DataSetPackage::pkg()->convertColumnStrings(colNo, importColumn->allValuesAsStrings(), _thresholdScale, _prepared.at(importColumn));
 }
 
 void Importer::syncDataSet(const std::string &locator, std::function<void(int)> progress)
 {
+	if(syncAppendedRows(locator, progress))
+	{
+		DataSetPackage::pkg()->setManualEdits(false);
+		return;
+	}
+
 	ImportDataSet *	importDataSet	= loadFile(locator, progress);
 	bool			rowCountChanged	= importDataSet->rowCount() != DataSetPackage::pkg()->dataRowCount();
 	int				syncColNo		= 0;
@@ -77,7 +132,12 @@ void Importer::syncDataSet(const std::string &locator, std::function<void(int)>
 		{
 			missingColumns.erase(syncColumnName);
 
-			if(DataSetPackage::pkg()->isColumnDifferentFromStringValues(syncColumnName, syncColumn->allValuesAsStrings()))
+			//If the column still has the fingerprint of what it was imported from that is all we need to compare, otherwise (older jaspfile or edited) look at all the values
+			uint64_t	knownFingerprint	= DataSetPackage::pkg()->columnFingerprint(syncColumnName);
+			bool		different			= knownFingerprint	? knownFingerprint != syncColumn->fingerprint()
+																: DataSetPackage::pkg()->isColumnDifferentFromStringValues(syncColumnName, syncColumn->allValuesAsStrings());
+
+			if(different)
 			{
 				Log::log() << "Something changed in column: " << syncColumnName << std::endl;
 				changedColumns.push_back(std::pair<int, std::string>(syncColNo, syncColumnName));
@@ -88,7 +148,34 @@ void Importer::syncDataSet(const std::string &locator, std::function<void(int)>
 	}
 
 	if (missingColumns.size() > 0 && newColumns.size() > 0)
+	{
+		//A renamed column is found by looking up the fingerprint of each new column, only missing columns without a known fingerprint need their values compared one by one
+		std::unordered_map<uint64_t, std::string>	missingByFingerprint;
+		stringvec									missingUnknown;
+
 		for (const std::string & nameMissing : missingColumns)
+		{
+			uint64_t fingerprint = DataSetPackage::pkg()->columnFingerprint(nameMissing);
+
+			if(fingerprint && !missingByFingerprint.count(fingerprint))	missingByFingerprint[fingerprint] = nameMissing;
+			else														missingUnknown.push_back(nameMissing);
+		}
+
+		for (auto newColIt = newColumns.begin(); newColIt != newColumns.end() && missingByFingerprint.size();)
+		{
+			auto missing = missingByFingerprint.find(importDataSet->getColumn(newColIt->first)->fingerprint());
+
+			if(missing == missingByFingerprint.end())
+				++newColIt;
+			else
+			{
+				changeNameColumns[missing->second] = newColIt->first;
+				missingByFingerprint.erase(missing);
+				newColIt = newColumns.erase(newColIt);
+			}
+		}
+
+		for (const std::string & nameMissing : missingUnknown)
 			for (auto newColIt = newColumns.begin(); newColIt != newColumns.end(); ++newColIt)
 			{
 				const std::string & newColName	= newColIt->first;
@@ -101,18 +188,23 @@ void Importer::syncDataSet(const std::string &locator, std::function<void(int)>
 					break;
 				}
 			}
+	}
 
 	for (auto & changeNameColumnIt : changeNameColumns)
 		missingColumns.erase(changeNameColumnIt.first);
 
+	bool synced = true;
+
 	if (newColumns.size() > 0 || changedColumns.size() > 0 || missingColumns.size() > 0 || changeNameColumns.size() > 0 || rowCountChanged)
-			_syncPackage(importDataSet, newColumns, changedColumns, missingColumns, changeNameColumns, rowCountChanged);
+		synced = _syncPackage(importDataSet, newColumns, changedColumns, missingColumns, changeNameColumns, rowCountChanged);
+
+	syncedWithFile(synced);
 
 	DataSetPackage::pkg()->setManualEdits(false);
 	delete importDataSet;
 }
 
-void Importer::_syncPackage(
+bool Importer::_syncPackage(
 		ImportDataSet								*	syncDataSet,
 		std::vector<std::pair<std::string, int>>	&	newColumns,
 		std::vector<std::pair<int, std::string>>	&	changedColumns, // import col index and original (old) col name
@@ -122,7 +214,7 @@ void Importer::_syncPackage(
 
 {
 	if( ! emit DataSetPackage::pkg()->checkDoSync())
-		return;
+		return false;
 
 	DataSetPackage::pkg()->beginSynchingData();
 
@@ -152,6 +244,7 @@ void Importer::_syncPackage(
 		std::string colName	= indexColChanged.second;
 		_changedColumns.push_back(colName);
 		initColumn(tq(colName), syncDataSet->getColumn(indexColChanged.first));
+		DataSetPackage::pkg()->setColumnFingerprint(tq(colName), syncDataSet->getColumn(indexColChanged.first)->fingerprint());
 	}
 
 	if (newColumns.size() > 0)
@@ -162,6 +255,7 @@ void Importer::_syncPackage(
 			Log::log() << "New column " << it->first << std::endl;
 
 			initColumn(DataSetPackage::pkg()->dataColumnCount() - 1, syncDataSet->getColumn(it->first));
+			DataSetPackage::pkg()->setColumnFingerprint(DataSetPackage::pkg()->dataColumnCount() - 1, syncDataSet->getColumn(it->first)->fingerprint());
 		}
 	}
 
@@ -177,4 +271,6 @@ void Importer::_syncPackage(
 
 
 	DataSetPackage::pkg()->endSynchingData(_changedColumns, _missingColumns, _changeNameColumns, rowCountChanged, newColumns.size() > 0);
+
+	return true;
 }
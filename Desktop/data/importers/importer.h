@@ -29,6 +29,17 @@ protected:
 	///colID can be either an integer (the column index in the data) or a string (the (old) name of the column in the data)
 	virtual void initColumn(QVariant colId, ImportColumn *importColumn);
 
+	///Called by syncDataSet before anything else, when it returns true the synch was handled entirely and the file is not loaded again.
+	///Meant for importers that can tell whether rows were only appended to the file since it was last read.
+	virtual bool syncAppendedRows(const std::string & /*locator*/, std::function<void(int)> /*progressCallback*/) { return false; }
+
+	///Called when the data in JASP matches (or no longer matches) what loadFile last read
+	virtual void syncedWithFile(bool /*synced*/) {}
+
+	///Called by loadDataSet for a group of columns at once, each in its own thread, before initColumn is called for each of them in order.
+	///So it must not change anything in DataSetPackage, by default it works out the type and values of the column for initColumn.
+	virtual void prepareColumn(size_t colNo, ImportColumn *importColumn);
+
 	void initColumnWithStrings(QVariant colId, const std::string & newName, const std::vector<std::string> & values) { DataSetPackage::pkg()->initColumnWithStrings(colId, newName, values); }
 
 	///colID can be either an integer (the column index in the data) or a string (the (old) name of the column in the data)
@@ -43,7 +54,10 @@ protected:
 	void						storeInEmptyValues(std::string columnName, std::map<int, std::string> emptyValues)																{ DataSetPackage::pkg()->storeMissingData(columnName, emptyValues);											}
 
 private:
-	void _syncPackage(
+	size_t														_thresholdScale = 0;
+	std::map<const ImportColumn*, DataSetPackage::ConvertedStrings>	_prepared;
+
+	bool _syncPackage(
 			ImportDataSet								*	syncDataSet,
 			std::vector<std::pair<std::string, int>>	&	newColumns,
 			std::vector<std::pair<int, std::string>>	&	changedColumns,
@@ -0,0 +1,522 @@
+#include "odscontentsreader.h"
+#include "odsimportcolumn.h"
+#include "archivereader.h"
+#include "timers.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+
+using namespace std;
+using namespace ods;
+
+ContentsReader::ContentsReader(ODSImportDataSet * dataSet)
+	: _dataSet(dataSet)
+{
+}
+
+void ContentsReader::read(ArchiveReader & contents, std::function<void(int)> progressCallback)
+{
+	JASPTIMER_SCOPE(ContentsReader::read);
+
+	const int	total			= contents.bytesAvailable();
+	int			errorCode		= 0,
+				lastProgress	= -1;
+	size_t		readSoFar		= 0;
+	string		buffer;			//Holds whatever the previous chunk ended with that could not be parsed yet, like half a tag, followed by the next chunk
+
+	while (!_tableRead)
+	{
+		const size_t kept = buffer.size();
+		buffer.resize(kept + _chunkSize);
+
+		const int count = contents.readData(&buffer[kept], _chunkSize, errorCode);
+
+		if (errorCode < 0 || (count <= 0 && readSoFar == 0))
+			throw runtime_error("Error reading contents in ODS.");
+
+		const bool lastChunk = count <= 0;
+
+		buffer.resize(kept + (lastChunk ? 0 : count));
+		readSoFar += lastChunk ? 0 : count;
+
+		buffer.erase(0, _parse(buffer.data(), buffer.data() + buffer.size(), lastChunk));
+
+		const int progress = total > 0 ? int(readSoFar * 100 / total) : 0;
+		if (progress != lastProgress)
+			progressCallback(lastProgress = progress);
+
+		if (lastChunk)
+			break;
+	}
+}
+
+size_t ContentsReader::_parse(const char * begin, const char * end, bool lastChunk)
+{
+	auto startsWith = [&](const char * pos, const char * literal)
+	{
+		const size_t len = strlen(literal);
+		return size_t(end - pos) >= len && memcmp(pos, literal, len) == 0;
+	};
+
+	auto find = [&](const char * from, const char * literal) -> const char *
+	{
+		const size_t found = string_view(from, end - from).find(literal);
+		return found == string_view::npos ? nullptr : from + found;
+	};
+
+	const char * pos = begin;
+
+	while (pos < end && !_tableRead)
+	{
+		if (*pos != '<')
+		{
+			const char * lt = static_cast<const char *>(memchr(pos, '<', end - pos));
+
+			if (!lt)
+				break; // The rest of the text is in the next chunk
+
+			_characters(pos, lt, true);
+			pos = lt;
+			continue;
+		}
+
+		if (end - pos < 9 && !lastChunk)
+			break; // Too little left to tell what kind of markup this is
+
+		if (startsWith(pos, "<?"))
+		{
+			const char * close = find(pos + 2, "?>");
+			if (!close) break;
+			pos = close + 2;
+		}
+		else if (startsWith(pos, "<!--"))
+		{
+			const char * close = find(pos + 4, "-->");
+			if (!close) break;
+			pos = close + 3;
+		}
+		else if (startsWith(pos, "<![CDATA["))
+		{
+			const char * close = find(pos + 9, "]]>");
+			if (!close) break;
+			_characters(pos + 9, close, false);
+			pos = close + 3;
+		}
+		else if (startsWith(pos, "<!"))
+		{
+			const char * close = static_cast<const char *>(memchr(pos, '>', end - pos));
+			if (!close) break;
+			pos = close + 1;
+		}
+		else
+		{
+			// An attribute value may contain a '>'
+			const char	*	close = pos + 1;
+			char			quote = 0;
+
+			for (; close < end; close++)
+				if (quote)					{ if (*close == quote) quote = 0;	}
+				else if (*close == '>')		break;
+				else if (*close == '"' || *close == '\'')	quote = *close;
+
+			if (close == end)
+				break;
+
+			if (pos[1] == '/')
+			{
+				string_view name(pos + 2, close - pos - 2);
+				_endElement(_localName(name.substr(0, name.find_first_of(" \t\r\n"))));
+			}
+			else
+			{
+				const bool selfClosing = close[-1] == '/';
+				string_view tag(pos + 1, close - pos - 1 - selfClosing);
+
+				_startElement(tag);
+
+				if (selfClosing)
+					_endElement(_localName(tag.substr(0, tag.find_first_of(" \t\r\n"))));
+			}
+
+			pos = close + 1;
+		}
+	}
+
+	return lastChunk ? end - begin : pos - begin;
+}
+
+void ContentsReader::_startElement(string_view tag)
+{
+	if (_tableRead)
+		return;
+
+	if (_skipDepth > 0)
+	{
+		_skipDepth++;
+		return;
+	}
+
+	const string_view localName = _localName(tag.substr(0, tag.find_first_of(" \t\r\n")));
+
+	switch(_docDepth)
+	{
+	case not_in_doc:
+		if (localName == "document-content")
+			_docDepth = document_content;
+		break;
+	case document_content:
+		if (localName == "body")
+			_docDepth = body;
+		break;
+	case body:
+		if (localName == "spreadsheet")
+			_docDepth = spreadsheet;
+		break;
+	case spreadsheet:
+		if (localName == "table")
+			_docDepth = table;
+		break;
+	case table:
+		if (localName == "table-row")
+		{
+			_docDepth	= table_row;
+			_parseAttributes(tag, _attributes);
+			_rowRepeat	= _repeat(_attributes, "table:number-rows-repeated");
+		}
+		break;
+	case table_row:
+		if (localName == "table-cell" || localName == "covered-table-cell")
+		{
+			_docDepth	= table_cell;
+			_parseAttributes(tag, _attributes);
+			_startCell(localName == "covered-table-cell");
+		}
+		break;
+	case table_cell:
+		if (localName == "p" && !_textDone && !_coveredCell)
+			_docDepth = text;
+		else
+			_skipDepth = 1;
+		break;
+	case text:
+		// Spaces, tabs and linebreaks are elements inside a paragraph, anything else (like a span) just holds more text
+		if (localName == "s")
+		{
+			_parseAttributes(tag, _attributes);
+			_currentCell.append(_repeat(_attributes, "text:c"), ' ');
+		}
+		else if (localName == "tab")
+			_currentCell.push_back('\t');
+		else if (localName == "line-break")
+			_currentCell.push_back('\n');
+		break;
+	}
+}
+
+void ContentsReader::_endElement(string_view localName)
+{
+	if (_tableRead)
+		return;
+
+	if (_skipDepth > 0)
+	{
+		_skipDepth--;
+		return;
+	}
+
+	switch(_docDepth)
+	{
+	case not_in_doc:
+		break;
+	case document_content:
+		if (localName == "document-content")
+			_docDepth = not_in_doc;
+		break;
+	case body:
+		if (localName == "body")
+			_docDepth = document_content;
+		break;
+	case spreadsheet:
+		if (localName == "spreadsheet")
+			_docDepth = body;
+		break;
+	case table:
+		if (localName == "table")
+		{
+			_docDepth	= spreadsheet;
+			_tableRead	= true;
+		}
+		break;
+	case table_row:
+		if (localName == "table-row")
+		{
+			_docDepth = table;
+			_endRow();
+		}
+		break;
+	case table_cell:
+		if (localName == "table-cell" || localName == "covered-table-cell")
+		{
+			_docDepth = table_row;
+			_endCell();
+		}
+		break;
+	case text:
+		if (localName == "p")
+		{
+			_docDepth = table_cell;
+			_textDone = true;
+		}
+		break;
+	}
+}
+
+void ContentsReader::_characters(const char * begin, const char * end, bool decode)
+{
+	if (_docDepth != text || _skipDepth > 0)
+		return;
+
+	if (decode)	_appendDecoded(_currentCell, begin, end);
+	else		_currentCell.append(begin, end);
+}
+
+void ContentsReader::_startCell(bool covered)
+{
+	_coveredCell	= covered;
+	_colRepeat		= _repeat(_attributes, "table:number-columns-repeated");
+	_currentCell.clear();
+
+	XmlDatatype				type		= odsType_unknown;
+	const string_view		valueType	= _attribute(_attributes, "office:value-type");
+	string_view				value;
+
+	if		(valueType == "float")		type = odsType_float;
+	else if (valueType == "currency")	type = odsType_currency;
+	else if (valueType == "percentage")	type = odsType_percent;
+	else if (valueType == "boolean")	type = odsType_boolean;
+	else if (valueType == "date")		type = odsType_date;
+	else if (valueType == "time")		type = odsType_time;
+	else if (valueType == "string")		type = odsType_string;
+
+	switch(type)
+	{
+	case odsType_float:
+	case odsType_currency:
+	case odsType_percent:
+		value = _attribute(_attributes, "office:value");
+		break;
+	case odsType_boolean:
+		value = _attribute(_attributes, "office:boolean-value");
+		break;
+	case odsType_date:
+		value = _attribute(_attributes, "office:date-value");
+		break;
+	case odsType_time:
+		value = _attribute(_attributes, "office:time-value");
+		break;
+	case odsType_string:
+	case odsType_unknown:
+		break;
+	}
+
+	// The value attribute is used when there is one, the displayed text of the cell only otherwise
+	_appendDecoded(_currentCell, value.data(), value.data() + value.size());
+	_textDone = !_currentCell.empty();
+}
+
+void ContentsReader::_endCell()
+{
+	if (!_coveredCell && !_currentCell.empty())
+	{
+		// First value in this row, so any empty rows before it are really there
+		if (_lastNotEmptyColumn == -1)
+		{
+			_row			+= _pendingRows;
+			_pendingRows	=  0;
+		}
+
+		if (_row == 0)
+		{
+			// Deals with header
+			// First add columns that had no name
+			for (int i = _lastNotEmptyColumn + 1; i < _column; i++)
+				_dataSet->createColumn("_col" + std::to_string(i + 1));
+
+			// Create the column with the current cell name
+			_dataSet->createColumn(_currentCell);
+
+			// Repeat create column if necessary
+			for (int i = 1; i < _colRepeat; i++)
+				_dataSet->createColumn("_col" + std::to_string(_column + i + 1));
+		}
+		else
+		{
+			// Columns without a value in this row only need to exist, ODSImportDataSet::postLoadProcess pads them
+			for (int i = _lastNotEmptyColumn + 1; i < _column; i++)
+				_dataSet->getOrCreate(i);
+
+			for (int i = 0; i < _colRepeat; i++)
+				_dataSet->getOrCreate(_column + i).setValue(_row - 1, _currentCell);
+		}
+
+		_lastNotEmptyColumn = _column + _colRepeat - 1;
+	}
+
+	_column		+= _colRepeat;
+	_colRepeat	=  1;
+	_coveredCell = _textDone = false;
+	_currentCell.clear();
+}
+
+void ContentsReader::_endRow()
+{
+	if (_lastNotEmptyColumn > -1)
+	{
+		const bool header = _row == 0;
+
+		// Repeat the last row, only the columns it has values for need to be filled
+		if (!header && _rowRepeat > 1)
+			for (int j = 0; j <= _lastNotEmptyColumn && j < int(_dataSet->columnCount()); j++)
+			{
+				ODSImportColumn &	column	= (*_dataSet)[j];
+				const string		value	= column.value(_row - 1);
+
+				if (!value.empty())
+					column.setValues(_row, _rowRepeat - 1, value);
+			}
+
+		_row += header ? 1 : _rowRepeat;
+	}
+	else
+		_pendingRows += _rowRepeat;
+
+	// Starting next row.
+	_column				= 0;
+	_lastNotEmptyColumn	= -1;
+	_rowRepeat			= 1;
+}
+
+string_view ContentsReader::_localName(string_view qName)
+{
+	const size_t colon = qName.find(':');
+	return colon == string_view::npos ? qName : qName.substr(colon + 1);
+}
+
+void ContentsReader::_parseAttributes(string_view tag, Attributes & atts)
+{
+	atts.clear();
+
+	size_t pos = tag.find_first_of(" \t\r\n");
+
+	while (pos < tag.size())
+	{
+		const size_t nameStart = tag.find_first_not_of(" \t\r\n", pos);
+		if (nameStart == string_view::npos)
+			return;
+
+		const size_t equals = tag.find('=', nameStart);
+		if (equals == string_view::npos)
+			return;
+
+		const size_t quote = tag.find_first_of("\"'", equals);
+		if (quote == string_view::npos)
+			return;
+
+		const size_t close = tag.find(tag[quote], quote + 1);
+		if (close == string_view::npos)
+			return;
+
+		string_view name = tag.substr(nameStart, equals - nameStart);
+		name = name.substr(0, name.find_first_of(" \t\r\n"));
+
+		atts.emplace_back(name, tag.substr(quote + 1, close - quote - 1));
+		pos = close + 1;
+	}
+}
+
+string_view ContentsReader::_attribute(const Attributes & atts, string_view qName)
+{
+	for (const auto & att : atts)
+		if (att.first == qName)
+			return att.second;
+
+	return string_view();
+}
+
+int ContentsReader::_repeat(const Attributes & atts, string_view qName)
+{
+	const string_view value = _attribute(atts, qName);
+
+	int repeat = 0;
+	for (char c : value)
+		if (c < '0' || c > '9' || repeat > 100000000)	return 1;
+		else											repeat = repeat * 10 + (c - '0');
+
+	return repeat > 0 ? repeat : 1;
+}
+
+void ContentsReader::_appendDecoded(string & out, const char * begin, const char * end)
+{
+	while (begin < end)
+	{
+		const char * amp = static_cast<const char *>(memchr(begin, '&', end - begin));
+
+		if (!amp)
+		{
+			out.append(begin, end);
+			return;
+		}
+
+		out.append(begin, amp);
+
+		const char * semi = static_cast<const char *>(memchr(amp, ';', end - amp));
+		if (!semi)
+		{
+			out.append(amp, end);
+			return;
+		}
+
+		const string_view entity(amp + 1, semi - amp - 1);
+
+		if		(entity == "amp")	out.push_back('&');
+		else if (entity == "lt")	out.push_back('<');
+		else if (entity == "gt")	out.push_back('>');
+		else if (entity == "quot")	out.push_back('"');
+		else if (entity == "apos")	out.push_back('\'');
+		else if (entity.size() > 1 && entity[0] == '#')
+		{
+			const bool		hex			= entity[1] == 'x' || entity[1] == 'X';
+			const string	digits		(entity.substr(hex ? 2 : 1));
+			char		*	parsedTo	= nullptr;
+			unsigned long	codepoint	= strtoul(digits.c_str(), &parsedTo, hex ? 16 : 10);
+
+			if (digits.empty() || *parsedTo != '\0' || codepoint > 0x10FFFF)
+				out.append(amp, semi + 1);
+			else if (codepoint < 0x80)
+				out.push_back(char(codepoint));
+			else if (codepoint < 0x800)
+			{
+				out.push_back(char(0xC0 | (codepoint >> 6)));
+				out.push_back(char(0x80 | (codepoint & 0x3F)));
+			}
+			else if (codepoint < 0x10000)
+			{
+				out.push_back(char(0xE0 | (codepoint >> 12)));
+				out.push_back(char(0x80 | ((codepoint >> 6) & 0x3F)));
+				out.push_back(char(0x80 | (codepoint & 0x3F)));
+			}
+			else
+			{
+				out.push_back(char(0xF0 | (codepoint >> 18)));
+				out.push_back(char(0x80 | ((codepoint >> 12) & 0x3F)));
+				out.push_back(char(0x80 | ((codepoint >> 6) & 0x3F)));
+				out.push_back(char(0x80 | (codepoint & 0x3F)));
+			}
+		}
+		else
+			out.append(amp, semi + 1);
+
+		begin = semi + 1;
+	}
+}
@@ -0,0 +1,82 @@
+#ifndef ODSCONTENTSREADER_H
+#define ODSCONTENTSREADER_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "odsimportdataset.h"
+#include "odstypes.h"
+
+class ArchiveReader;
+
+namespace ods
+{
+
+/// Streams the contents file of an ODS from the archive into an ODSImportDataSet, without holding the whole xml in memory nor building any tree of it.
+///
+/// It is a small pull parser that knows just enough xml for spreadsheets: tags, attributes, text, the predefined and numeric entities, comments, CDATA and processing instructions.
+/// Only the first table is read and decompressing stops as soon as that table is closed.
+/// Repeated rows and cells (table:number-rows-repeated and table:number-columns-repeated) are only expanded when they contain a value,
+/// so the empty rows and cells spreadsheet programs like to add to the end of a sheet cost nothing.
+class ContentsReader
+{
+public:
+	ContentsReader(ODSImportDataSet * dataSet);
+
+	/// Reads the first table of contents into the dataset, progressCallback gets the percentage of the file that was read so far
+	void read(ArchiveReader & contents, std::function<void(int)> progressCallback);
+
+private:
+	typedef std::vector<std::pair<std::string_view, std::string_view>> Attributes;
+
+	// Depth in XML document.
+	typedef enum e_docDepth
+	{
+		not_in_doc = -1,
+		document_content,
+		body,
+		spreadsheet,
+		table,
+		table_row,
+		table_cell,
+		text			// Only for string cells.
+	} DocDepth;
+
+	size_t					_parse(const char * begin, const char * end, bool lastChunk);	///< Handles all complete markup and text between begin and end, returns how much of it was consumed
+	void					_startElement(std::string_view tag);
+	void					_endElement(std::string_view localName);
+	void					_characters(const char * begin, const char * end, bool decode);
+
+	void					_startCell(bool covered);
+	void					_endCell();
+	void					_endRow();
+
+	static std::string_view	_localName(std::string_view qName);
+	static void				_parseAttributes(std::string_view tag, Attributes & atts);
+	static std::string_view	_attribute(const Attributes & atts, std::string_view qName);
+	static int				_repeat(const Attributes & atts, std::string_view qName);
+	static void				_appendDecoded(std::string & out, const char * begin, const char * end);
+
+	ODSImportDataSet	*	_dataSet;
+	DocDepth				_docDepth			= not_in_doc;
+	bool					_tableRead			= false,	///< True if first table read.
+							_coveredCell		= false,	///< Merged away cells take up columns but their content is not shown
+							_textDone			= false;	///< Only the first paragraph of a cell is its value, and none is needed when the cell had a value attribute
+	int						_skipDepth			= 0,		///< Larger than 0 while inside an element of a cell that does not hold its value, like an annotation
+							_row				= 0,		///< Current row in document/table.
+							_pendingRows		= 0,		///< Empty rows since the last row with a value, only added to _row once another value follows
+							_column				= 0,		///< Current column in document/table.
+							_lastNotEmptyColumn	= -1,
+							_rowRepeat			= 1,
+							_colRepeat			= 1;		///< Number cells this XML element spans.
+	std::string				_currentCell;
+	Attributes				_attributes;
+
+	static constexpr int	_chunkSize			= 1 << 20;
+};
+
+} // end namespace ods
+
+#endif // ODSCONTENTSREADER_H
@@ -20,12 +20,11 @@
 */
 
 #include "odsimportcolumn.h"
-#include "odssheetcell.h"
 
 #include "odstypes.h"
 #include "odsimportdataset.h"
 
-#include <set>
+#include <algorithm>
 #include "log.h"
 
 using namespace std;
@@ -48,61 +47,41 @@ ODSImportColumn::~ODSImportColumn()
 size_t ODSImportColumn::size()
 const
 {
-	return _rows.size();
+	return _values.size();
 }
 
-const stringvec & ODSImportColumn::allValuesAsStrings() const
-{
-	static stringvec values;
-	values.resize(_rows.size());
-	
-	for(size_t i=0; i<_rows.size(); i++)
-		values[i] = _rows[i].valueAsString();
-
-	return values;
-}
-
-
 /**
- * @brief insert Inserts string value for cell, irrespective of type.
- * @param row
- * @param data
- */
-void insert(int row, const std::string& data);
-
-
-/**
- * @brief _createSpace Ensures that we have enough elements in _rows.
+ * @brief _createSpace Ensures that we have enough elements in _values.
  * @param row Row number to check for.
  */
 void ODSImportColumn::createSpace(size_t row)
 {
-#ifdef JASP_DEBUG
-	size_t numAdded = 0;
-#endif
-
-	while (_rows.size() <= row)
-#ifdef JASP_DEBUG
-	{
-		numAdded++;
-#endif
-		_rows.push_back(ODSSheetCell());
-#ifdef JASP_DEBUG
-	}
-
-	//if (numAdded != 0) 	Log::log() << "ODSImportColumn::_createSpace(" << row << ") - added " << numAdded << " row" <<((numAdded != 1) ? "s" : "") << "." << std::endl;
-#endif
+	if (_values.size() <= row)
+		_values.resize(row + 1);
 }
 
 void ODSImportColumn::setValue(int row, const string &data)
 {
-	//Log::log() << "Inserting " << data << ", row " << row << ", column " << _columnNumber << "." << std::endl;
-
-	// Big enough?
 	createSpace(row);
+	_values[row]	= data;
+	_fingerprint	= 0;
+}
+
+void ODSImportColumn::setValues(int row, int count, const string &data)
+{
+	if (count <= 0)
+		return;
+
+	createSpace(row + count - 1);
+	std::fill(_values.begin() + row, _values.begin() + row + count, data);
+	_fingerprint	= 0;
+}
+
+const string & ODSImportColumn::value(int row) const
+{
+	static const string empty;
 
-	ODSSheetCell & cell = _rows.at(row);
-	cell.setValue(data);	
+	return row >= 0 && size_t(row) < _values.size() ? _values[row] : empty;
 }
 
 /**
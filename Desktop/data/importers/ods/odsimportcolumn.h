@@ -24,9 +24,6 @@
 
 #include "../importcolumn.h"
 #include "odsimportdataset.h"
-#include "odssheetcell.h"
-
-#include <set>
 
 
 namespace ods
@@ -36,13 +33,6 @@ class ODSImportDataSet;
 class ODSImportColumn : public ImportColumn
 {
 public:
-
-	// The empty value for a cell.
-	static const ODSSheetCell EmptySheetCell;
-
-	// The constainer used to hold rows within the column.
-	typedef std::vector<ODSSheetCell>	Cases;
-
 	ODSImportColumn(ODSImportDataSet* importDataSet, int columnNumber, std::string name);
 	virtual ~ODSImportColumn();
 
@@ -61,20 +51,10 @@ public:
 	 */
 	size_t size() const override;
 
-	const stringvec &	allValuesAsStrings()					const	override;
-
-	/**
-	 * @brief hasCall Checks for presence of a cell at row.
-	 * @param row Row check for.
-	 * @return true if value in column.
-	 */
-	inline bool hasCell(size_t row) const
-	{
-		return (_index.find(row) != _index.end());
-	}
+	const stringvec &	allValuesAsStrings()					const	override { return _values; }
 
 	/**
-	 * @brief _createSpace Ensures that we have enough elements in _rows.
+	 * @brief _createSpace Ensures that we have enough elements in _values.
 	 * @param row Row number to check for.
 	 */
 	void createSpace(size_t row);
@@ -86,7 +66,15 @@ public:
 	 */
 	void setValue(int row, const std::string& data);
 
-	const ODSSheetCell &getCell(int row) const { return _rows.at(row); }
+	/**
+	 * @brief setValues Fills count rows starting at row with data, used for repeated rows.
+	 */
+	void setValues(int row, int count, const std::string& data);
+
+	/**
+	 * @brief value Returns the value at row or an empty string if the column does not reach that far (yet).
+	 */
+	const std::string & value(int row) const;
 
 	/**
 	 * @brief postLoadProcess Performs posy load processing.
@@ -105,11 +93,7 @@ public:
 
 private:
 
-	// The cells/rows (as read).
-	Cases	_rows;
-
-	typedef std::map< int, size_t > CellIndex;
-	CellIndex			_index;		///< cell indexes indexed by row.
+	stringvec			_values;		///< The cells/rows as read, ContentsReader already picked the office:value over the displayed text where there is one.
 	int					_columnNumber; //<- We know our own column number
 	columnType			_columnType; // Our column type.
 
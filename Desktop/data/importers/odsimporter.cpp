@@ -18,7 +18,7 @@
 #include "odsimporter.h"
 
 #include "ods/odsxmlmanifesthandler.h"
-#include "ods/odsxmlcontentshandler.h"
+#include "ods/odscontentsreader.h"
 #include "archivereader.h"
 
 #include <QXmlInputSource>
@@ -42,7 +42,7 @@ ImportDataSet* ODSImporter::loadFile(const std::string &locator, std::function<v
 
 	// Read the sheet contents.
 	progressCallback(33); // "Reading ODS contents.",
-	readContents(locator, result);
+	readContents(locator, result, [&](int progress) { progressCallback(33 + progress * 27 / 100); });
 
 	// Do post load processing:
 	progressCallback(60); //"Processing.",
@@ -80,27 +80,11 @@ void ODSImporter::readManifest(const std::string &path, ODSImportDataSet *datase
 	}
 }
 
-void ODSImporter::readContents(const std::string &path, ODSImportDataSet *dataset)
+void ODSImporter::readContents(const std::string &path, ODSImportDataSet *dataset, std::function<void(int)> progressCallback)
 {
-
 	ArchiveReader contents(path, dataset->getContentFilename());
 
-	QXmlInputSource src;
-	{
-		std::string tmp;
-		int errorCode = 0;
-		if (((tmp = contents.readAllData(4096, errorCode)).size() == 0) || (errorCode < 0))
-			throw std::runtime_error("Error reading contents in ODS.");
-		src.setData(QString::fromStdString(tmp));
-	}
-
-	{
-		XmlContentsHandler * contentsHandler = new XmlContentsHandler(dataset);
-		QXmlSimpleReader reader;
-		reader.setContentHandler(contentsHandler);
-		reader.setErrorHandler(contentsHandler);
-		reader.parse(src);
-	}
+	ContentsReader(dataset).read(contents, progressCallback);
 
 	contents.close();
 }
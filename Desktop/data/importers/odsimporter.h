@@ -56,8 +56,9 @@ private:
 	 * @brief readContents Reads contents to _dta;
 	 * @param path The file path to the archive file
 	 * @param dataset The data set to import into.
+	 * @param progressCallback Gets the percentage of the contents read so far.
 	 */
-	void readContents(const std::string &path, ODSImportDataSet *dataset);
+	void readContents(const std::string &path, ODSImportDataSet *dataset, std::function<void(int)> progressCallback);
 
 	JASPTIMER_CLASS(ODSImporter);
 
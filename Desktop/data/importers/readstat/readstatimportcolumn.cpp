@@ -2,9 +2,16 @@
 #include "utils.h"
 #include "columnutils.h"
 #include "log.h"
+#include <mutex>
 
 using namespace std;
 
+static std::mutex logMutex; ///< ReadStatImportDataSet::finishColumns works on several columns at once and Log::log() is not threadsafe
+
+template<typename T> static void releaseValues(std::vector<T> & values) { std::vector<T>().swap(values); } ///< Unlike clear() this actually gives back the memory, which matters when converting a column of a big file
+
+#define LOG_COLUMN(msg) do { std::lock_guard<std::mutex> lock(logMutex); Log::log() << msg << std::endl; } while(false)
+
 ReadStatImportColumn::ReadStatImportColumn(readstat_variable_t * readstat_var, ImportDataSet* importDataSet, string name, std::string title, std::string labelsID, columnType columnType)
 	: ImportColumn(importDataSet, name), _readstatVariable(readstat_var), _labelsID(labelsID), _title(title), _type(columnType)
 {}
@@ -49,6 +56,43 @@ const stringvec & ReadStatImportColumn::allValuesAsStrings() const
 	return strs;
 }
 
+uint64_t ReadStatImportColumn::_fingerprintValues() const
+{
+	uint64_t fingerprint = 0;
+
+	for(size_t row = 0; row<size(); row++)
+	{
+		const std::string value = valueAsString(row);
+		fingerprint += ColumnUtils::fingerprintCell(row, value.data(), value.size());
+	}
+
+	return fingerprint == 0 ? 1 : fingerprint;
+}
+
+void ReadStatImportColumn::reserve(size_t rows, readstat_type_t valueType)
+{
+	switch(_type)
+	{
+	case columnType::scale:			_doubles.reserve(rows);	return;
+	case columnType::ordinal:		[[fallthrough]];
+	case columnType::nominal:		_ints.reserve(rows);	return;
+	case columnType::nominalText:	_strings.reserve(rows);	return;
+	default:						break;
+	}
+
+	//The type is determined by the first value, which will be of valueType
+	switch(valueType)
+	{
+	case READSTAT_TYPE_STRING:		_strings.reserve(rows);	return;
+	case READSTAT_TYPE_INT8:		[[fallthrough]];
+	case READSTAT_TYPE_INT16:		[[fallthrough]];
+	case READSTAT_TYPE_INT32:		_ints.reserve(rows);	return;
+	case READSTAT_TYPE_FLOAT:		[[fallthrough]];
+	case READSTAT_TYPE_DOUBLE:		_doubles.reserve(rows);	return;
+	default:						return;
+	}
+}
+
 bool ReadStatImportColumn::canConvertToType(columnType newType)
 {
 	if(_type == newType || _type == columnType::unknown)
@@ -139,7 +183,7 @@ void ReadStatImportColumn::setType(columnType newType)
 	if(_type == newType)
 		return;
 
-	Log::log() << "Changing columntype of '" << _name << "'\tto " << columnTypeToString(newType) << "\tfrom " << columnTypeToString(_type) << std::endl;
+	LOG_COLUMN("Changing columntype of '" << _name << "'\tto " << columnTypeToString(newType) << "\tfrom " << columnTypeToString(_type));
 
 	auto conversionFailed = [&](const std::string & extraMsg){
 		throw std::runtime_error("An attempt was made to change the columntype of '" + _name + "' to "+ columnTypeToString(newType) + " from " + columnTypeToString(_type) + " but the conversion failed.\n" + extraMsg);
@@ -161,17 +205,19 @@ void ReadStatImportColumn::setType(columnType newType)
 		{
 		case columnType::ordinal:		[[fallthrough]];
 		case columnType::nominal:
+			_ints.reserve(_doubles.size());
 			for(double d : _doubles)
 				if(isMissingValue(d))			_ints.push_back(missingValueInt());
 				else if(d != double(int(d)))	conversionFailed("Double '" + ColumnUtils::doubleToString(d) + "' cannot be converted to int.");
 				else							_ints.push_back(int(d));
-
+			releaseValues(_doubles);
 			break;
 
 		case columnType::nominalText:
+			_strings.reserve(_doubles.size());
 			for(double d : _doubles)
 				_strings.push_back(isMissingValue(d) ? missingValueString() : ColumnUtils::doubleToString(d));
-			_doubles.clear();
+			releaseValues(_doubles);
 			break;
 		default: break;
 		}
@@ -191,15 +237,17 @@ void ReadStatImportColumn::setType(columnType newType)
 			if(_intLabels.size() > 0)
 				conversionFailed("Because we would have to drop labels.");
 
+			_doubles.reserve(_ints.size());
 			for(int i : _ints)
 				_doubles.push_back(isMissingValue(i) ? missingValueDouble() : i);
-			_ints.clear();
+			releaseValues(_ints);
 			break;
 
 		case columnType::nominalText:
+			_strings.reserve(_ints.size());
 			for(int i : _ints)
 				_strings.push_back(isMissingValue(i) ? missingValueString() : std::to_string(i));
-			_ints.clear();
+			releaseValues(_ints);
 
 			for(const auto & intLabel : _intLabels)
 				_strLabels[std::to_string(intLabel.first)] = intLabel.second;
@@ -218,6 +266,7 @@ void ReadStatImportColumn::setType(columnType newType)
 			if(_strLabels.size() > 0)
 				conversionFailed("Because we would have to drop some labels.");
 
+			_doubles.reserve(_strings.size());
 			for(const std::string & str : _strings)
 			{
 				double dblVal;
@@ -225,16 +274,19 @@ void ReadStatImportColumn::setType(columnType newType)
 				else if(ColumnUtils::convertValueToDoubleForImport(str, dblVal))	_doubles.push_back(dblVal);
 				else														conversionFailed("String '" + str + "' cannot be converted to double.");
 			}
+			releaseValues(_strings);
 			break;
 
 		case columnType::ordinal:	[[fallthrough]];
 		case columnType::nominal:
 		{
 			int val;
+			_ints.reserve(_strings.size());
 			for(const std::string & str : _strings)
 				if(isMissingValue(str))									_ints.push_back(missingValueInt());
 				else if(ColumnUtils::convertValueToIntForImport(str, val))	_ints.push_back(val);
 				else													conversionFailed("String '" + str + "' cannot be converted to int.");
+			releaseValues(_strings);
 
 			for(const auto & strLabel : _strLabels)
 				if(ColumnUtils::convertValueToIntForImport(strLabel.first, val))	_intLabels[val] = strLabel.second;
@@ -282,7 +334,7 @@ void ReadStatImportColumn::addValue(const string & val)
 			addValue(dblVal);
 		else
 		{
-			Log::log() << "Column '" << name() << "' being imported through readstat is of type " << _type << " but receives an string (" << val << ") as value. Converting type to nominaltext!" << std::endl;
+			LOG_COLUMN("Column '" << name() << "' being imported through readstat is of type " << _type << " but receives an string (" << val << ") as value. Converting type to nominaltext!");
 			setType(columnType::nominalText);
 			addValue(val);
 			return;
@@ -298,7 +350,7 @@ void ReadStatImportColumn::addValue(const string & val)
 			addValue(intVal);
 		else
 		{
-			Log::log() << "Column '" << name() << "' being imported through readstat is of type " << _type << " but receives an string (" << val << ") as value. Converting type to nominaltext!" << std::endl;
+			LOG_COLUMN("Column '" << name() << "' being imported through readstat is of type " << _type << " but receives an string (" << val << ") as value. Converting type to nominaltext!");
 			setType(columnType::nominalText);
 			addValue(val);
 			return;
@@ -307,7 +359,7 @@ void ReadStatImportColumn::addValue(const string & val)
 	}
 		
 	default:
-		Log::log() << "Column '" << name() << "' being imported through readstat is of type " << _type << " but receives an string (" << val << ") as value. Doing nothing..." << std::endl;
+		LOG_COLUMN("Column '" << name() << "' being imported through readstat is of type " << _type << " but receives an string (" << val << ") as value. Doing nothing...");
 		return;
 	}
 }
@@ -381,7 +433,7 @@ void ReadStatImportColumn::addLabel(const int & val, const std::string & label)
 
 	if(_type == columnType::nominalText)
 	{
-		Log::log() << "Column '" << name() << "' being imported through readstat is of type nominaltext but receives an int (" << val << ") as value for label '" << label << "'. Converting it to string!" << std::endl;
+		LOG_COLUMN("Column '" << name() << "' being imported through readstat is of type nominaltext but receives an int (" << val << ") as value for label '" << label << "'. Converting it to string!");
 		addLabel(std::to_string(val), label);
 		return;
 	}
@@ -390,13 +442,13 @@ void ReadStatImportColumn::addLabel(const int & val, const std::string & label)
 	{
 		if(!canConvertToType(columnType::ordinal)) // then there might be some doubles already and then this wont work
 		{
-			Log::log() << "Column '" << name() << "' being imported through readstat was of type scale but receives an int (" << val << ") as value for label '" << label << "'. Converting it's type to nominal text because there are some doubles which we cannot convert to int!" << std::endl;
+			LOG_COLUMN("Column '" << name() << "' being imported through readstat was of type scale but receives an int (" << val << ") as value for label '" << label << "'. Converting it's type to nominal text because there are some doubles which we cannot convert to int!");
 			addLabel(std::to_string(val), label);
 			return;
 		}
 		else
 		{
-			Log::log() << "Column '" << name() << "' being imported through readstat was of type scale but receives an int (" << val << ") as value for label '" << label << "'. Converting it's type to ordinal!" << std::endl;
+			LOG_COLUMN("Column '" << name() << "' being imported through readstat was of type scale but receives an int (" << val << ") as value for label '" << label << "'. Converting it's type to ordinal!");
 			setType(columnType::ordinal);
 		}
 	}
@@ -416,7 +468,7 @@ void ReadStatImportColumn::addLabel(const double & val, const std::string & labe
 			return;
 		}
 
-		Log::log() << "Column '" << name() << "' being imported through readstat was of type " << _type << " but receives a double (" << val << ") as value for label '" << label << "'. Converting it's type to nominalText!" << std::endl;
+		LOG_COLUMN("Column '" << name() << "' being imported through readstat was of type " << _type << " but receives a double (" << val << ") as value for label '" << label << "'. Converting it's type to nominalText!");
 		setType(columnType::nominalText); //Because we do not support having doubles as values for labels
 	}
 
@@ -498,7 +550,7 @@ void ReadStatImportColumn::addValue(const readstat_value_t & value)
 		{
 			const auto missStr = readstatValueToString(value);
 			if(!_loggedMissing.count(missStr))
-				Log::log() << "Column '" << _name << "' has non-system missing value: '" << readstatValueToString(value) << "' dropping the value." << std::endl;
+				LOG_COLUMN("Column '" << _name << "' has non-system missing value: '" << readstatValueToString(value) << "' dropping the value.");
 			_loggedMissing.insert(missStr);
 		}
 		addMissingValue();
@@ -513,7 +565,7 @@ void ReadStatImportColumn::tryNominalMinusText()
 	if(!canConvertToType(columnType::nominal))
 		return;
 
-	Log::log() << "Converting column '" << _name << "' from nominalText to nominal because all values can be converted to int without losing information." << std::endl;
+	LOG_COLUMN("Converting column '" << _name << "' from nominalText to nominal because all values can be converted to int without losing information.");
 
 	setType(columnType::nominal);
 }
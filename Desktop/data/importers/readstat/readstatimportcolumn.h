@@ -41,6 +41,7 @@ public:
 	static double						missingValueDouble()		{ return NAN; }
 	static std::string					missingValueString();
 
+	void						reserve(size_t rows, readstat_type_t valueType);	///< Reserves room for rows values in the vector that valueType will end up in, so reading a big file does not keep reallocating
 	void						addMissingValue();
 	void						addLeadingMissingValues();
 	void						setType(columnType newType);
@@ -58,6 +59,9 @@ public:
 
 	void						tryNominalMinusText();
 
+protected:
+	uint64_t					_fingerprintValues()					const	override;	///< Goes through valueAsString row by row instead of building allValuesAsStrings
+
 private:
 	readstat_variable_t		*	_readstatVariable = nullptr;
 	std::string					_labelsID,
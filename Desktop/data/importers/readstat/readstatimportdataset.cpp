@@ -19,6 +19,10 @@
 #include "log.h"
 #include "utils.h"
 #include "columnutils.h"
+#include "timers.h"
+#include <thread>
+#include <atomic>
+#include <exception>
 
 bool operator<(const readstat_value_t & l, const readstat_value_t & r)
 {
@@ -80,74 +84,106 @@ ReadStatImportColumn * ReadStatImportDataSet::column(int index)
 	else						return nullptr;
 }
 
-void ReadStatImportDataSet::setLabelsToColumns()
+void ReadStatImportDataSet::setLabelsToColumn(ReadStatImportColumn * col) const
 {
-	for(auto & colKeyVal : _cols)
+	//Log::log() << "Setting labels for column " << col->name() << std::endl;		
+
+	auto labels = _labelMap.find(col->labelsID());
+
+	if(col->hasLabels() && labels != _labelMap.end())
 	{
-		ReadStatImportColumn * col = colKeyVal.second;
-		
-		//Log::log() << "Setting labels for column " << col->name() << std::endl;		
+		//Log::log() << "It has labels" << std::endl;
+		//Log::log() << "It's labelID is " << col->labelsID() << std::endl;
+
+		const auto & valueLabelMap = labels->second;
 
-		if(col->hasLabels())
+		//Log::log() << "It has about " << valueLabelMap.size() << std::endl;
+
+		for(const auto & valueLabel : valueLabelMap)
 		{
-			//Log::log() << "It has labels" << std::endl;
-			//Log::log() << "It's labelID is " << col->labelsID() << std::endl;
+			readstat_type_t			type	= valueLabel.second.first;
+
+			/*switch(type)
+			{
+			case READSTAT_TYPE_STRING:		Log::log() << "Type is STRING" << std::endl;	break;
+			case READSTAT_TYPE_INT8:		Log::log() << "Type is INT8" << std::endl;			break;
+			case READSTAT_TYPE_INT16:		Log::log() << "Type is INT16" << std::endl;			break;
+			case READSTAT_TYPE_INT32:		Log::log() << "Type is INT32" << std::endl;			break;
+			case READSTAT_TYPE_FLOAT:		Log::log() << "Type is FLOAT" << std::endl;			break;
+			case READSTAT_TYPE_DOUBLE:		Log::log() << "Type is DOUBLE" << std::endl;		break;
+			case READSTAT_TYPE_STRING_REF:	Log::log() << "Type is STRING_REF" << std::endl;	break;
+			}*/
 
-			const auto & valueLabelMap = _labelMap[col->labelsID()];
+			const	std::string			&	key		= valueLabel.first;
+			const	std::string			&	label	= valueLabel.second.second;
 
-			//Log::log() << "It has about " << valueLabelMap.size() << std::endl;
+			//Log::log() << "label: '" << label << "'" << std::endl;
 
-			for(const auto & valueLabel : valueLabelMap)
+			switch(type)
+			{
+			default:
+			case READSTAT_TYPE_STRING_REF:	//? I guess this won't occur because we don't accept it elsewhere
+			case READSTAT_TYPE_STRING:		
+				col->addLabel(key,	label);	
+				break;
+				
+			case READSTAT_TYPE_INT8:		
+			case READSTAT_TYPE_INT16:		
+			case READSTAT_TYPE_INT32:		
 			{
-				readstat_type_t			type	= valueLabel.second.first;
+				int keyInt;
+				if(ColumnUtils::convertValueToIntForImport(key, keyInt))		col->addLabel(keyInt,		label);
+				else													col->addLabel(key,			label);
+				break;
+			}
+			case READSTAT_TYPE_FLOAT:		
+			case READSTAT_TYPE_DOUBLE:		
+			{
+				double keyDbl;
+				if(ColumnUtils::convertValueToDoubleForImport(key, keyDbl))	col->addLabel(keyDbl,		label);
+				else													col->addLabel(key,			label);
+				break;
+			}
+			}
+		}
+	}
 
-				/*switch(type)
-				{
-				case READSTAT_TYPE_STRING:		Log::log() << "Type is STRING" << std::endl;	break;
-				case READSTAT_TYPE_INT8:		Log::log() << "Type is INT8" << std::endl;			break;
-				case READSTAT_TYPE_INT16:		Log::log() << "Type is INT16" << std::endl;			break;
-				case READSTAT_TYPE_INT32:		Log::log() << "Type is INT32" << std::endl;			break;
-				case READSTAT_TYPE_FLOAT:		Log::log() << "Type is FLOAT" << std::endl;			break;
-				case READSTAT_TYPE_DOUBLE:		Log::log() << "Type is DOUBLE" << std::endl;		break;
-				case READSTAT_TYPE_STRING_REF:	Log::log() << "Type is STRING_REF" << std::endl;	break;
-				}*/
+	//Log::log() << "Done setting labels for column " << col->name() << std::endl;
+}
 
-				const	std::string			&	key		= valueLabel.first;
-				const	std::string			&	label	= valueLabel.second.second;
+void ReadStatImportDataSet::finishColumns()
+{
+	JASPTIMER_SCOPE(ReadStatImportDataSet::finishColumns);
 
-				//Log::log() << "label: '" << label << "'" << std::endl;
+	//Each column only needs the (by now complete) _labelMap and itself, so the columns are divided over some threads
+	std::vector<ReadStatImportColumn*>	cols;
+	std::atomic<size_t>					next	= 0;
+	std::vector<std::thread>			workers;
+	std::vector<std::exception_ptr>		errors(std::max(1u, std::thread::hardware_concurrency()));
 
-				switch(type)
-				{
-				default:
-				case READSTAT_TYPE_STRING_REF:	//? I guess this won't occur because we don't accept it elsewhere
-				case READSTAT_TYPE_STRING:		
-					col->addLabel(key,	label);	
-					break;
-					
-				case READSTAT_TYPE_INT8:		
-				case READSTAT_TYPE_INT16:		
-				case READSTAT_TYPE_INT32:		
-				{
-					int keyInt;
-					if(ColumnUtils::convertValueToIntForImport(key, keyInt))		col->addLabel(keyInt,		label);
-					else													col->addLabel(key,			label);
-					break;
-				}
-				case READSTAT_TYPE_FLOAT:		
-				case READSTAT_TYPE_DOUBLE:		
+	for(auto & colKeyVal : _cols)
+		cols.push_back(colKeyVal.second);
+
+	for(size_t w=0; w<errors.size(); w++)
+		workers.emplace_back([&, w]()
+		{
+			try
+			{
+				for(size_t c = next++; c < cols.size(); c = next++)
 				{
-					double keyDbl;
-					if(ColumnUtils::convertValueToDoubleForImport(key, keyDbl))	col->addLabel(keyDbl,		label);
-					else													col->addLabel(key,			label);
-					break;
-				}
+					setLabelsToColumn(cols[c]);
+					cols[c]->tryNominalMinusText(); //If we converted some doubles to strings as value because spss has weird datatypes then maybe they are ints anyway. so try to convert it back to nominal in that case.
 				}
 			}
-		}
+			catch(...) { errors[w] = std::current_exception(); }
+		});
 
-		//Log::log() << "Done setting labels for column " << col->name() << std::endl;
-	}
+	for(std::thread & worker : workers)
+		worker.join();
+
+	for(const std::exception_ptr & error : errors)
+		if(error)
+			std::rethrow_exception(error);
 }
 
 void ReadStatImportDataSet::setCurrentRow(int row)
@@ -156,5 +192,15 @@ void ReadStatImportDataSet::setCurrentRow(int row)
 
 	_currentRow = row;
 
-	_progressCallback(int(float(_currentRow) / float(_expectedRows) * 100.0));
+	if(_expectedRows <= 0)
+		return;
+
+	//Only bother the callback when the percentage changes, otherwise a big file gets a call per row
+	int progress = int(float(_currentRow) / float(_expectedRows) * 100.0);
+
+	if(progress != _progress)
+	{
+		_progress = progress;
+		_progressCallback(progress);
+	}
 }
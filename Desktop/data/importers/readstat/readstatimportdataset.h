@@ -45,22 +45,26 @@ public:
 
 	void						addLabelKeyValue(	const std::string & labelsID, const readstat_value_t & key, const std::string & label);
 	const std::string		&	getLabel(			const std::string & labelsID, const readstat_value_t & key);
-	void						setLabelsToColumns();
+	void						finishColumns();	///< Sets the labels and settles the type of each column (see ReadStatImportColumn::tryNominalMinusText), several columns at once
 
 	void						addColumn(int index, ReadStatImportColumn * col); //Calls hidden virtual function addColumn(ImportColumn*)
 	ReadStatImportColumn	*	column(int index);
 	ReadStatImportColumn	*	operator[](int index) { return column(index); };
 
 	void						setExpectedRows(int rows)	{ _expectedRows = rows; }
+	int							expectedRows()		const	{ return _expectedRows; }	///< As reported by the metadata of the file, can be -1 if it does not know
 	void						setCurrentRow(int row);
 	void						incrementRow()				{ setCurrentRow(_currentRow + 1); }
 
 private:
+	void						setLabelsToColumn(ReadStatImportColumn * col) const;
+
 	labelsMapT								_labelMap;
 	int										_var_count			= 0;
 	std::map<int,ReadStatImportColumn*>		_cols;
 	int										_expectedRows		= 0,
-											_currentRow			= 0;
+											_currentRow			= 0,
+											_progress			= -1;
 	std::function<void(int)>				_progressCallback;
 };
 
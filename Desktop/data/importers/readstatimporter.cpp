@@ -34,7 +34,13 @@ int handle_variable(int, readstat_variable_t *variable, const char *val_labels,
 	case READSTAT_MEASURE_SCALE:	colType = columnType::scale;	break;
 	}
 
-	data->addColumn(var_index, new ReadStatImportColumn(variable, data, name, title, labelsID, colType));
+	ReadStatImportColumn * col = new ReadStatImportColumn(variable, data, name, title, labelsID, colType);
+
+	//The metadata came first, so unless the file does not know how many rows it has all values fit without reallocating
+	if(data->expectedRows() > 0)
+		col->reserve(data->expectedRows(), readstat_variable_get_type(variable));
+
+	data->addColumn(var_index, col);
 
 	return READSTAT_HANDLER_OK;
 }
@@ -101,12 +107,12 @@ ImportDataSet* ReadStatImporter::loadFile(const std::string &locator, std::funct
 
 	Log::log() << "Done parsing file" << std::endl;
 
-	Log::log() << "Setting labels to columns" << std::endl;
-	data->setLabelsToColumns();
-
 	if (error != READSTAT_OK)
 		throw std::runtime_error("Error processing " + locator + " " + readstat_error_message(error));
 
+	Log::log() << "Setting labels to columns and settling their types" << std::endl;
+	data->finishColumns();
+
 	Log::log() << "Building dictionary" << std::endl;
 	data->buildDictionary(); //Not necessary for opening this file but synching will break otherwise...
 
@@ -128,8 +134,6 @@ void ReadStatImporter::initColumn(QVariant colId, ImportColumn * importColumn)
 	
 	ReadStatImportColumn * col = static_cast<ReadStatImportColumn*>(importColumn);
 
-	col->tryNominalMinusText(); //If we converted some doubles to strings as value because spss has weird datatypes then maybe they are ints anyway. so try to convert it back to nominal in that case.
-
 	switch(col->getColumnType())
 	{
 	case columnType::scale:
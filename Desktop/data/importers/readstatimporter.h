@@ -22,6 +22,7 @@ public:
 
 	static bool extSupported(const std::string & ext);
 	void initColumn(QVariant colId, ImportColumn * importColumn) override;
+	void prepareColumn(size_t, ImportColumn * importColumn) override { importColumn->fingerprint(); } ///< initColumn uses the typed values of the column directly, so there is nothing to convert beforehand. Only the fingerprint is calculated in parallel
 
 protected:
 	ImportDataSet *	loadFile(const std::string &locator, std::function<void(int)> progressCallback)	override;
@@ -0,0 +1,72 @@
+#include "engineprocess.h"
+#include "enginezygote.h"
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+EngineProcess::EngineProcess(QProcess * process, QObject * parent)
+	: QObject(parent), _process(process)
+{
+	_process->setParent(this);
+
+	connect(_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, &EngineProcess::finished);
+}
+
+EngineProcess::EngineProcess(EngineZygote * zygote, size_t channelNumber, QObject * parent)
+	: QObject(parent), _zygote(zygote)
+{
+	_zygote->requestFork(this, channelNumber);
+}
+
+EngineProcess::~EngineProcess()
+{
+	if(_zygote)
+		_zygote->forget(this);
+}
+
+QProcess::ProcessState EngineProcess::state() const
+{
+	return _process ? _process->state() : _state;
+}
+
+void EngineProcess::terminate()
+{
+	if(_process)
+		_process->terminate();
+#ifndef _WIN32
+	else if(_pid > 0 && _state == QProcess::ProcessState::Running)
+		::kill(_pid, SIGTERM);
+#endif
+	else if(_state == QProcess::ProcessState::Starting)
+		_killWhenForked = true;
+}
+
+void EngineProcess::kill()
+{
+	if(_process)
+		_process->kill();
+#ifndef _WIN32
+	else if(_pid > 0 && _state == QProcess::ProcessState::Running)
+		::kill(_pid, SIGKILL);
+#endif
+	else if(_state == QProcess::ProcessState::Starting)
+		_killWhenForked = true;
+}
+
+void EngineProcess::forkedAs(long pid)
+{
+	_pid	= pid;
+	_state	= QProcess::ProcessState::Running;
+
+	if(_killWhenForked)
+		kill();
+}
+
+void EngineProcess::forkedFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+	_state	= QProcess::ProcessState::NotRunning;
+	_zygote	= nullptr;
+
+	emit finished(exitCode, exitStatus);
+}
@@ -0,0 +1,47 @@
+#ifndef ENGINEPROCESS_H
+#define ENGINEPROCESS_H
+
+#include <QObject>
+#include <QProcess>
+#include <QPointer>
+
+class EngineZygote;
+
+///
+/// The jaspEngine process of an EngineRepresentation.
+/// Either a QProcess started by EngineSync or an engine forked by the EngineZygote, the latter is not a child of Desktop so the zygote tells us when it finishes.
+///
+class EngineProcess : public QObject
+{
+	Q_OBJECT
+
+public:
+							EngineProcess(QProcess * process,								QObject * parent = nullptr);
+							EngineProcess(EngineZygote * zygote,	size_t channelNumber,	QObject * parent = nullptr);
+							~EngineProcess();
+
+	QProcess::ProcessState	state()		const;
+	bool					forked()	const { return !_process;	}
+	long					pid()		const { return _pid;		}
+
+	void					terminate();
+	void					kill();
+
+signals:
+	void					finished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+	friend class EngineZygote;
+
+	void					forkedAs(long pid);
+	void					forkedFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+	QProcess				*	_process	= nullptr;
+	QPointer<EngineZygote>		_zygote;
+	long						_pid		= -1;
+	QProcess::ProcessState		_state		= QProcess::ProcessState::Starting;
+	bool						_killWhenForked	= false;	///< kill or terminate was called before the zygote replied
+};
+
+#endif // ENGINEPROCESS_H
@@ -2,17 +2,18 @@
 #include "gui/preferencesmodel.h"
 #include "utilities/messageforwarder.h"
 #include "utilities/qutils.h"
+#include "utilities/settings.h"
 #include "utils.h"
 #include "log.h"
 
-EngineRepresentation::EngineRepresentation(size_t channelNumber, QProcess * slaveProcess, QObject * parent)
+EngineRepresentation::EngineRepresentation(size_t channelNumber, EngineProcess * slaveProcess, QObject * parent)
 	: QObject(parent), _channelNumber(channelNumber)
 {
 	setSlaveProcess(slaveProcess);
 }
 
 
-void EngineRepresentation::setSlaveProcess(QProcess * slaveProcess)
+void EngineRepresentation::setSlaveProcess(EngineProcess * slaveProcess)
 {
 	Log::log() << "Setting new engine process to engineRepresentation Engine #" << _channelNumber << std::endl;
 
@@ -20,7 +21,7 @@ void EngineRepresentation::setSlaveProcess(QProcess * slaveProcess)
 	_slaveProcess = slaveProcess;
 	_slaveProcess->setParent(this);
 
-	_slaveFinishedConnection = connect(_slaveProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),	this, &EngineRepresentation::processFinished);
+	_slaveFinishedConnection = connect(_slaveProcess, &EngineProcess::finished,	this, &EngineRepresentation::processFinished);
 }
 
 EngineRepresentation::~EngineRepresentation()
@@ -654,7 +655,7 @@ void EngineRepresentation::killEngine()
 		//if(disconnectFinished)
 			//We must make sure we do not get a popup, and while processFinished checks for "killed" or not it doesnt help that that needs the eventloop to be processed
 			//I want pause and resume all engines to be done in a single function call without returning to the eventloop, so we just disconnect "finished" if we want to kill the engine.
-		disconnect(_slaveProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),	this, &EngineRepresentation::processFinished);
+		disconnect(_slaveProcess, &EngineProcess::finished,	this, &EngineRepresentation::processFinished);
 
 		_slaveProcess->kill();
 		_slaveProcess->deleteLater();
@@ -713,7 +714,7 @@ void EngineRepresentation::sendStopEngine()
 	sendString(json.toStyledString());
 }
 
-void EngineRepresentation::restartEngine(QProcess * jaspEngineProcess)
+void EngineRepresentation::restartEngine(EngineProcess * jaspEngineProcess)
 {
 	Log::log() << "informing engine #" << channelNumber() << " that it ought to restart" << std::endl;
 
@@ -1051,6 +1052,7 @@ void EngineRepresentation::addSettingsToJson(Json::Value & msg)
 	msg["exactPValues"]			=	 PreferencesModel::prefs()->exactPValues();
 	msg["normalizedNotation"]	=	 PreferencesModel::prefs()->normalizedNotation();
 	msg["resultFont"]			= fq(PreferencesModel::prefs()->resultFont());
+	msg["dataSetCacheMB"]		=	 Settings::value(Settings::ENGINE_DATASET_CACHE_MB).toInt();
 }
 
 void EngineRepresentation::processSettingsReply()
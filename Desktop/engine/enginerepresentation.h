@@ -14,6 +14,7 @@
 #include "enginedefinitions.h"
 #include "rscriptstore.h"
 #include "modules/dynamicmodules.h"
+#include "engineprocess.h"
 
 ///
 /// Keeps track of the state of a single Engine process (JASPEngine)
@@ -31,7 +32,7 @@ class EngineRepresentation : public QObject
 
 
 public:
-					EngineRepresentation(size_t channelNumber, QProcess * slaveProcess, QObject * parent = nullptr);
+					EngineRepresentation(size_t channelNumber, EngineProcess * slaveProcess, QObject * parent = nullptr);
 					~EngineRepresentation();
 
 	void			cleanUpAfterClose(bool forgetAnalyses = false);
@@ -39,6 +40,7 @@ public:
 	void			clearAnalysisInProgress();
 	void			setAnalysisInProgress(Analysis* analysis);
 	Analysis *		analysisInProgress() const { return _analysisInProgress; }
+	Analysis *		analysisAborted()	const { return _analysisAborted;	}
 
 	void			handleRunningAnalysisStatusChanges();
 
@@ -69,7 +71,7 @@ public:
 	void 			resumeEngine(bool setResuming = true);
 	
 	///Start engine again in jaspEngineProcess
-	void 			restartEngine(QProcess * jaspEngineProcess);
+	void 			restartEngine(EngineProcess * jaspEngineProcess);
 
 	bool			handlingModuleRequest(const std::string & moduleName) const { return _requestModName == moduleName && (installingModule() || moduleLoading()); }
 
@@ -189,7 +191,7 @@ signals:
 private:
 	void			sendPauseEngine();
 	void			sendStopEngine();
-	void			setSlaveProcess(QProcess * slaveProcess);
+	void			setSlaveProcess(EngineProcess * slaveProcess);
 	void			checkForComputedColumns(const Json::Value & results);
 	void			handleEngineCrash();
 	void			abortAnalysisInProgress(bool restartAfterwards);
@@ -203,7 +205,7 @@ private:
 
 	size_t			_channelNumber		= 0;
 	engineState		_engineState		= engineState::initializing; // The representation of whatever state the actual engine is supposed to be in.
-	QProcess	*	_slaveProcess		= nullptr;
+	EngineProcess *	_slaveProcess		= nullptr;
 	Analysis	*	_analysisInProgress = nullptr,
 				*	_analysisAborted	= nullptr;	///<To make sure we know that the response we got was from this aborted analysis or not
 	int				_idRemovedAnalysis	= -1,		///<If the analysis was deleted we should ignore its results
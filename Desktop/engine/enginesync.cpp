@@ -17,6 +17,8 @@
 //
 
 #include "enginesync.h"
+#include "ipcchannelwaiter.h"
+#include "enginezygote.h"
 
 #include <QApplication>
 #include <QFile>
@@ -103,11 +105,17 @@ EngineSync::~EngineSync()
 	_moduleEngines.clear();
 	_engines.clear();
 
+	for(auto & channelWaiter : _channelWaiters)
+	{
+		channelWaiter.second->requestInterruption(); //So they all stop at the same time instead of one after the other in destroyChannel
+		channelWaiter.first->abortGather();
+	}
+
 	for(auto* channel : _channels)
-		delete channel;
+		destroyChannel(channel);
 	_channels.clear();
 
-	delete _rCmderChannel;
+	destroyChannel(_rCmderChannel);
 	_rCmderChannel	= nullptr;
 	_rCmder			= nullptr;
 
@@ -213,7 +221,7 @@ void EngineSync::maxEngineCountChanged()
 		_channels.resize(maxEngineCount());
 
 		for(size_t c=startHere; c<_channels.size(); c++)
-			_channels[c] = new IPCChannel(_memoryName, c);
+			_channels[c] = createChannel(c);
 	}
 
 	if(_engineStopTimes.size() != maxEngineCount())
@@ -300,7 +308,7 @@ void EngineSync::start(int )
 	//Also we do not need to recreate and destroy them all the time this way.
 	_channels.resize(maxEngineCount());
 	for(size_t c=0; c<maxEngineCount(); c++)
-		_channels[c] = new IPCChannel(_memoryName, c);
+		_channels[c] = createChannel(c);
 
 	//Initialize stop times to -1, because we just started
 	_engineStopTimes.resize(maxEngineCount());
@@ -312,16 +320,67 @@ void EngineSync::start(int )
 	//Once it is assigned to a module it won't be possible to use it for another module until it is restarted.
 	createNewEngine();
 
+	//Any engine started after this one is ready is forked from it, which is much faster than starting a new one
+	startZygote();
+
 	QTimer	*timerProcess	= new QTimer(this),
 			*timerBeat		= new QTimer(this);
 
 	connect(timerProcess,	&QTimer::timeout, this, &EngineSync::process,				Qt::QueuedConnection);
 	connect(timerBeat,		&QTimer::timeout, this, &EngineSync::heartbeatTempFiles,	Qt::QueuedConnection);
 
-	timerProcess->start(50);
+	timerProcess->start(50); //Replies and new filters, computed columns and rcode are handled through processSoon, this is what picks up everything else
 	timerBeat->start(50);
 }
 
+IPCChannel * EngineSync::createChannel(size_t channelNumber)
+{
+	IPCChannel * channel = new IPCChannel(_memoryName, channelNumber);
+
+	startChannelWaiter(channel);
+
+	return channel;
+}
+
+void EngineSync::startChannelWaiter(IPCChannel * channel)
+{
+	assert(!_channelWaiters.count(channel));
+
+	IPCChannelWaiter * waiter = new IPCChannelWaiter(channel, this);
+
+	connect(waiter, &IPCChannelWaiter::messageWaiting, this, &EngineSync::processSoon, Qt::QueuedConnection);
+
+	_channelWaiters[channel] = waiter;
+	waiter->start();
+}
+
+void EngineSync::stopChannelWaiter(IPCChannel * channel)
+{
+	if(_channelWaiters.count(channel))
+	{
+		delete _channelWaiters[channel]; //Its destructor interrupts the thread, aborts the gather and waits for it to finish
+		_channelWaiters.erase(channel);
+	}
+}
+
+void EngineSync::reconstructChannel(IPCChannel * channel)
+{
+	//The waiter might be in the middle of a gather on the very objects that are about to be replaced
+	stopChannelWaiter(channel);
+	channel->findConstructAllAgain();
+	startChannelWaiter(channel);
+}
+
+void EngineSync::destroyChannel(IPCChannel * channel)
+{
+	if(!channel)
+		return;
+
+	stopChannelWaiter(channel); //First, because it waits on the channel
+
+	delete channel;
+}
+
 void EngineSync::restartEngines()
 {
 	for(auto * engine : _engines)
@@ -390,12 +449,15 @@ void EngineSync::shutdownBoredEngines()
  * Also Module load/install requests are sent to engines and of course analyses can be run.
  * 
  * Each engine can be registered for a module, which should b e combined with a module load if rscripts or analyses need to be ran on it.
- * This allows for clean separation of R-libraries per module (as they each get their own engine and thus R)
+ * This allows for clean separation of R-libraries per module (as they each get their own engines and thus R)
+ * A module can have a pool of engines, all of them take analyses of that module from the same ready queue (see processAnalysisRequests)
  * 
- * It gets runs every 50ms, if it can anyway.
+ * It gets runs every 50ms, if it can anyway, and through processSoon whenever an engine sent something or a job was added.
  */
 void EngineSync::process()
 {
+	_processScheduled = false;
+
 	if(_stopProcessing && !_dataMode)
 		return;
 		
@@ -415,6 +477,9 @@ void EngineSync::process()
 	for(auto * engine : _engines)
 		engine->processReplies();
 
+	for(auto & channelWaiter : _channelWaiters)
+		channelWaiter.second->handled();
+
 	if(moduleInstallRunning()) return; //First finish any module install running.
 
 	processReloadData();
@@ -505,6 +570,15 @@ void EngineSync::process()
 		startExtraEngines();*/
 }
 
+void EngineSync::processSoon()
+{
+	if(_processScheduled || _channels.empty()) //No channels means start wasn't called yet
+		return;
+
+	_processScheduled = true;
+	QMetaObject::invokeMethod(this, &EngineSync::process, Qt::QueuedConnection);
+}
+
 int EngineSync::sendFilter(const QString & generatedFilter, const QString & filter)
 {
 	JASPTIMER_SCOPE(EngineSync::sendFilter);
@@ -514,12 +588,15 @@ int EngineSync::sendFilter(const QString & generatedFilter, const QString & filt
 	_waitingFilter = new RFilterStore(generatedFilter, filter, ++_filterCurrentRequestID);
 	Log::log() << "waiting filter with requestid: " << _filterCurrentRequestID << " is now:\n" << generatedFilter.toStdString() << "\n" << filter.toStdString() << std::endl;
 
+	processSoon();
+
 	return _filterCurrentRequestID;
 }
 
 void EngineSync::sendRCode(const QString & rCode, int requestId, bool whiteListedVersion, QString module)
 {
 	_waitingScripts.push(new RScriptStore(requestId, rCode, module, engineState::rCode, whiteListedVersion));
+	processSoon();
 }
 
 void EngineSync::computeColumn(const QString & columnName, const QString & computeCode, columnType colType)
@@ -537,6 +614,7 @@ void EngineSync::computeColumn(const QString & columnName, const QString & compu
 	}
 
 	_waitingCompCols.push(new RComputeColumnStore(columnName, computeCode, colType));
+	processSoon();
 }
 
 void EngineSync::processFilterScript()
@@ -635,13 +713,17 @@ stringset EngineSync::processRCodeQueue()
 							
 							if(!engine->moduleLoaded() && !engine->moduleLoading())
 								engine->moduleLoad();
+
+							break;
 						}
 				}
 				else 
 				{
 					foundEngine = true;
-					if(_moduleEngines[mod]->idle())		_moduleEngines[mod]->runScriptOnProcess(waiting);
-					else								engineNotIdle = true;
+					EngineRepresentation * engine = idleModuleEngine(mod);
+
+					if(engine)	engine->runScriptOnProcess(waiting);
+					else		engineNotIdle = true;
 				}
 			
 				
@@ -726,23 +808,32 @@ stringset EngineSync::processDynamicModules()
 		{
 			if(moduleHasEngine(mod))
 			{
-				auto * engine = _moduleEngines[mod];
+				//The packages get replaced underneath every engine of the module, so none of them should be running an analysis from it
+				for(auto * engine : std::set<EngineRepresentation*>(_moduleEngines[mod]))
+					if(engine->analysisInProgress())
+						engine->killEngine();
 
-				if(engine->analysisInProgress())
-					engine->killEngine();
+				EngineRepresentation * engine = idleModuleEngine(mod);
 
-				if(engine->idle())
+				if(engine)
 					engine->runModuleInstallRequestOnProcess(DynMods::dynMods()->getJsonForPackageInstallationRequest(mod));
 			}
 			else
+			{
+				bool foundOne = false;
+
 				for(auto & engine : _engines)
 					if(engine->idle() && engine->runsUtility()) //We don't care if the engine is meant for some module or other. We restart afterwards anyway
 					{
 						registerEngineForModule(engine, mod);
 						engine->runModuleInstallRequestOnProcess(DynMods::dynMods()->getJsonForPackageInstallationRequest(mod));
+						foundOne = true;
+						break;
 					}
-					else
-						stillWantTo.insert(mod);
+
+				if(!foundOne)
+					stillWantTo.insert(mod);
+			}
 		}
 		
 		return stillWantTo;
@@ -754,71 +845,114 @@ stringset EngineSync::processDynamicModules()
 	return {};
 }
 
+std::vector<Analysis*> EngineSync::analysesReadyToRun()
+{
+	//Analyses that are running, or being aborted to be restarted, stay with the engine they are on
+	std::set<Analysis*> onAnEngine;
+	for(auto * engine : _engines)
+	{
+		if(engine->analysisInProgress())	onAnEngine.insert(engine->analysisInProgress());
+		if(engine->analysisAborted())		onAnEngine.insert(engine->analysisAborted());
+	}
+
+	std::vector<Analysis*> ready;
+
+	Analyses::analyses()->applyToAll([&](Analysis * analysis)
+	{
+		if(analysis && analysis->shouldRun() && !onAnEngine.count(analysis))
+			ready.push_back(analysis);
+	});
+
+	//The analysis the user is looking at goes first, the rest keeps the order of the results
+	Analysis * current = Analyses::analyses()->currentAnalysis();
+	std::stable_partition(ready.begin(), ready.end(), [current](Analysis * analysis) { return analysis == current; });
+
+	return ready;
+}
+
+/**
+ * @brief EngineSync::processAnalysisRequests hands out the analyses from analysesReadyToRun to the engines
+ *
+ * Any idle engine in the pool of a module, with that module loaded, takes the first waiting analysis of its module.
+ * So when several analyses of a module need to be (re)run they are spread over all engines of the module instead of waiting for a single one.
+ * If more analyses are waiting than the pool of a module can take on soon the module is returned, and process() will try to add an engine to the pool.
+ */
 std::set<std::string> EngineSync::processAnalysisRequests()
 {	
-
-	std::set<std::string> modulesNeedingEngines;
+	std::set<std::string>			modulesNeedingEngines;
+	std::map<std::string, size_t>	waitingPerModule;
 	
 	for(auto * engine : _engines)
 		engine->handleRunningAnalysisStatusChanges();
 
-	Analyses::analyses()->applyToAll([&](Analysis * analysis)
+	for(Analysis * analysis : analysesReadyToRun())
 	{
-		if(analysis && analysis->shouldRun())
+		try
 		{
-			try
-			{
-				const std::string modName = analysis->dynamicModule()->name();
-
-				//First check if we already have an engine for this module
-				if(moduleHasEngine(modName))
-				{
-					auto * engine = _moduleEngines[modName];
+			const std::string modName = analysis->dynamicModule()->name();
 
-					if(engine->willProcessAnalysis(analysis))
-						engine->runAnalysisOnProcess(analysis);
+			//See if there is an idle engine we can use, if the module doesn't have any yet
+			if(!moduleHasEngine(modName))
+				for(auto * engine : _engines)
+					if(engine->module() == "" && engine->idle() && engine->runsAnalysis())
+					{
+						registerEngineForModule(engine, modName);
+						break;
+					}
 
-					else if(engine->stopped())
-						startStoppedEngine(engine);
+			bool running = false;
 
-					else if(engine->idle())
+			if(moduleHasEngine(modName))
+				for(auto * engine : _moduleEngines[modName])
+					if(engine->willProcessAnalysis(analysis))
 					{
-						if(!engine->moduleLoaded())
-						{
-							if(!engine->moduleLoading())
-								engine->moduleLoad();
-						}
-						//else
-						// If the engine is being stopped it might be here	throw std::runtime_error("An engine is meant for module " + modName + " but won't process analysis " + analysis->name() + " and is also loaded, which does not make any sense.");
+						engine->runAnalysisOnProcess(analysis);
+						running = true;
+						break;
 					}
-				}
-				else
-				{
-					bool foundOne = false;
 
-					//See if there is an idle engine we can use
-					for(auto * engine : _engines)
-						if(engine->module() == "" && !foundOne)
-							if(engine->idle() && engine->runsAnalysis())
-							{
-								registerEngineForModule(engine, modName);
-								foundOne = true;
-							}
+			if(!running)
+				waitingPerModule[modName]++;
+		}
+		catch(std::exception & e)	{ Log::log() << "Exception " << e.what() << " thrown in ProcessAnalysisRequests" << std::endl;	}
+	}
 
+	for(const auto & modWaiting : waitingPerModule)
+	{
+		const std::string	&	modName			= modWaiting.first;
+		size_t					availableSoon	= 0;
 
-					if(!foundOne)
-						modulesNeedingEngines.insert(modName);
-						
-				}
+		if(moduleHasEngine(modName))
+			for(auto * engine : std::set<EngineRepresentation*>(_moduleEngines[modName]))
+			{
+				if(engine->stopped())
+					startStoppedEngine(engine);
+
+				else if(engine->idle() && !engine->moduleLoaded() && !engine->moduleLoading())
+					engine->moduleLoad();
 
+				if(!engine->analysisInProgress())
+					availableSoon++;
 			}
-			catch(std::exception & e)	{ Log::log() << "Exception " << e.what() << " thrown in ProcessAnalysisRequests" << std::endl;	}
-		}
-	});
+
+		//A module without engines always asks for one, but the pool of a module only grows when there is room for it. Otherwise idle engines of other modules would get killed for it.
+		if(availableSoon < modWaiting.second && (!moduleHasEngine(modName) || enginesStartableCount() > 0))
+			modulesNeedingEngines.insert(modName);
+	}
 	
 	return modulesNeedingEngines;
 }
 
+EngineRepresentation * EngineSync::idleModuleEngine(const std::string & modName)
+{
+	if(moduleHasEngine(modName))
+		for(auto * engine : _moduleEngines[modName])
+			if(engine->idle())
+				return engine;
+
+	return nullptr;
+}
+
 ///Maybe no engines are idle, but if one is initializing or setting up some stuff it'll be so soon. So tell JASP to be patient then.
 bool EngineSync::anEngineIdleSoon() const
 {
@@ -942,12 +1076,8 @@ void EngineSync::fixPATHForWindows(QProcessEnvironment & env)
 }
 #endif 
 
-//Should this function go to EngineRepresentation?
-QProcess * EngineSync::startSlaveProcess(int channel)
+QProcessEnvironment EngineSync::engineEnvironment()
 {
-	JASPTIMER_SCOPE(EngineSync::startSlaveProcess);
-	QDir programDir			= AppDirs::programDir();
-	QString engineExe		= programDir.absoluteFilePath("JASPEngine");
 	QProcessEnvironment env = ProcessHelper::getProcessEnvironmentForJaspEngine();
 
 #ifndef JASP_DEBUG
@@ -958,15 +1088,43 @@ QProcess * EngineSync::startSlaveProcess(int channel)
 	
 	env.insert("GITHUB_PAT", PreferencesModel::prefs()->githubPatResolved());
 
+	return env;
+}
+
+///The first argument is the channel of the engine or "--zygote"
+QStringList EngineSync::engineArguments(const QString & first) const
+{
 	QStringList args;
-	args << QString::number(channel) << QString::number(ProcessInfo::currentPID()) << tq(Log::logFileNameBase) << tq(Log::whereStr());
+	args << first << QString::number(ProcessInfo::currentPID()) << tq(Log::logFileNameBase) << tq(Log::whereStr());
 
 	if(Dirs::reportingDir() != "")
 		args << tq(Dirs::reportingDir());
 
+	return args;
+}
+
+void EngineSync::startZygote()
+{
+#ifdef __linux__
+	_zygote = new EngineZygote(this);
+	_zygote->start(AppDirs::programDir().absoluteFilePath("JASPEngine"), engineArguments("--zygote"), engineEnvironment(), QFileInfo( QCoreApplication::applicationFilePath() ).absoluteDir().absolutePath());
+#endif
+}
+
+//Should this function go to EngineRepresentation?
+EngineProcess * EngineSync::startSlaveProcess(int channel)
+{
+	JASPTIMER_SCOPE(EngineSync::startSlaveProcess);
+
+	if(_zygote && _zygote->ready())
+		return new EngineProcess(_zygote, channel, this);
+
+	QDir programDir			= AppDirs::programDir();
+	QString engineExe		= programDir.absoluteFilePath("JASPEngine");
+
 	QProcess *slave = new QProcess(this);
 	slave->setProcessChannelMode(QProcess::ForwardedChannels);
-	slave->setProcessEnvironment(env);
+	slave->setProcessEnvironment(engineEnvironment());
 	slave->setWorkingDirectory(QFileInfo( QCoreApplication::applicationFilePath() ).absoluteDir().absolutePath());
 
 #ifdef _WIN32
@@ -991,9 +1149,9 @@ QProcess * EngineSync::startSlaveProcess(int channel)
 	});
 #endif
 
-	slave->start(engineExe, args);
+	slave->start(engineExe, engineArguments(QString::number(channel)));
 
-	return slave;
+	return new EngineProcess(slave, this);
 }
 
 bool EngineSync::moduleInstallRunning() const
@@ -1214,41 +1372,53 @@ void EngineSync::logCfgReplyReceived(EngineRepresentation * engine)
 
 void EngineSync::registerEngineForModule(EngineRepresentation * engine, std::string modName)
 {
-	if(_moduleEngines.count(modName) > 0 && _moduleEngines[modName] != engine)
-		throw std::runtime_error("Trying to register module '" + modName + "' to engine #" +
-								 std::to_string(engine->channelNumber()) + " but it is already registered to " +
-								 std::to_string(_moduleEngines[modName]->channelNumber()));
+	if(_moduleEngines.count(modName) && _moduleEngines[modName].count(engine))
+		return;
 
-	Log::log() << "Registering engine #" << engine->channelNumber() << " for module '" << modName << "'" << std::endl;
+	Log::log() << "Registering engine #" << engine->channelNumber() << " for module '" << modName << "'" << (moduleHasEngine(modName) ? ", it now has " + std::to_string(_moduleEngines[modName].size() + 1) + " engines" : "") << std::endl;
 
-	_moduleEngines[modName] = engine;
+	leaveModulePools(engine); //An engine only ever has a single module loaded
+	_moduleEngines[modName].insert(engine);
 
 	engine->setDynamicModule(modName);
 }
 
 void EngineSync::unregisterEngineForModule(EngineRepresentation * engine, std::string modName)
 {
-	if(_moduleEngines.count(modName) > 0 && _moduleEngines[modName] != engine)
+	if(_moduleEngines.count(modName) > 0 && !_moduleEngines[modName].count(engine))
 		return;
 
 	Log::log() << "Unregistering engine #" << engine->channelNumber() << " for module '" << modName << "'" << std::endl;
-	_moduleEngines.erase(modName); //We only erase it when it is the exact same engine + modName combo
+	leaveModulePools(engine); //We only remove it when it is the exact same engine + modName combo
 	engine->setDynamicModule("");
 	//engine->shutEngineDown(); this function is triggered by closing the engine anyway
 }
 
+void EngineSync::leaveModulePools(EngineRepresentation * engine)
+{
+	for(auto it = _moduleEngines.begin(); it != _moduleEngines.end();)
+	{
+		it->second.erase(engine);
+
+		if(it->second.empty())	it = _moduleEngines.erase(it);
+		else					it++;
+	}
+}
+
 void EngineSync::stopModuleEngine(QString moduleName)
 {
 	const std::string modName = fq(moduleName);
 	if(_moduleEngines.count(modName))
-		_moduleEngines[modName]->shutEngineDown();
+		for(auto * engine : std::set<EngineRepresentation*>(_moduleEngines[modName]))
+			engine->shutEngineDown();
 }
 
 void EngineSync::moduleInstallationFailedHandler(const QString &moduleName, const QString &)
 {
 	const std::string modName = fq(moduleName);
 	if(_moduleEngines.count(modName))
-		unregisterEngineForModule(_moduleEngines[modName], modName);
+		for(auto * engine : std::set<EngineRepresentation*>(_moduleEngines[modName]))
+			unregisterEngineForModule(engine, modName);
 }
 
 void EngineSync::killModuleEngine(Modules::DynamicModule * mod)
@@ -1256,7 +1426,8 @@ void EngineSync::killModuleEngine(Modules::DynamicModule * mod)
 	if(!_moduleEngines.count(mod->name()))
 		return;
 
-	_moduleEngines[mod->name()]->shutEngineDown();
+	for(auto * engine : std::set<EngineRepresentation*>(_moduleEngines[mod->name()]))
+		engine->shutEngineDown();
 }
 
 void EngineSync::killEngine(int channelNumber)
@@ -1346,7 +1517,7 @@ EngineRepresentation *	EngineSync::createRCmdEngine()
 	{
 		const size_t rCmdChannelNumber = 12345; //Shouldnt ever crash with _channels
 
-		_rCmderChannel	= new IPCChannel(_memoryName, rCmdChannelNumber);
+		_rCmderChannel	= createChannel(rCmdChannelNumber);
 		_rCmder			= createNewEngine(false, rCmdChannelNumber);
 
 		_rCmder->setRunsAnalysis(	true);
@@ -1372,21 +1543,11 @@ void EngineSync::destroyEngine(EngineRepresentation * engine)
 		QTimer::singleShot(ENGINE_COOLDOWN / 2, [channel, this]()
 		{
 			if(_channels.size() > channel) //still there?
-				_channels[channel]->findConstructAllAgain();
+				reconstructChannel(_channels[channel]);
 		});
 	}
 
-	if(engine->module() != "")	_moduleEngines.erase(engine->module());
-	else
-	{
-		std::string modName = "";
-
-		for(const auto & nameEngine : _moduleEngines)
-			if(nameEngine.second == engine)
-				modName = nameEngine.first;
-
-		_moduleEngines.erase(modName);
-	}
+	leaveModulePools(engine);
 
 	_engines.erase(engine);
 
@@ -1396,7 +1557,7 @@ void EngineSync::destroyEngine(EngineRepresentation * engine)
 	{
 		_rCmder  = nullptr;
 
-		delete _rCmderChannel;
+		destroyChannel(_rCmderChannel);
 		_rCmderChannel = nullptr;
 	}
 
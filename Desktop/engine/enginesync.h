@@ -33,6 +33,9 @@
 
 #include "enginerepresentation.h"
 
+class IPCChannelWaiter;
+class EngineZygote;
+
 /// EngineSync is responsible for launching the background
 /// processes, scheduling analyses, and for sending and
 /// receiving communications with the running analyses.
@@ -119,6 +122,10 @@ private:
 	stringset	processDynamicModules();
 	stringset	processAnalysisRequests();	///< Returns modules that still need an engine
 	
+	std::vector<Analysis*>	analysesReadyToRun();							///< The shared ready queue of all modules, the analysis shown in the results comes first
+	EngineRepresentation *	idleModuleEngine(const std::string & modName);	///< Any idle engine in the pool of modName or nullptr
+	void					leaveModulePools(EngineRepresentation * engine);
+	
 	void		processLogCfgRequests();
 	void		processFilterScript();
 	void		processSettingsChanged();
@@ -128,7 +135,15 @@ private:
 	bool		allEnginesStopped(	std::set<EngineRepresentation *> these = {}); ///< If `these` isn't filled all engines are checked
 	bool		allEnginesPaused(	std::set<EngineRepresentation *> these = {}); ///< If `these` isn't filled all engines are checked
 	bool		allEnginesResumed(	std::set<EngineRepresentation *> these = {}); ///< If `these` isn't filled all engines are checked
-	QProcess*	startSlaveProcess(int channelNumber);
+	EngineProcess*		startSlaveProcess(int channelNumber);
+	QProcessEnvironment	engineEnvironment();
+	QStringList			engineArguments(const QString & first)	const;
+	void				startZygote();									///< Only does something on linux
+	IPCChannel*	createChannel(size_t channelNumber);	///< Also starts an IPCChannelWaiter for it
+	void		destroyChannel(IPCChannel * channel);
+	void		reconstructChannel(IPCChannel * channel);	///< Calls findConstructAllAgain while its IPCChannelWaiter is stopped
+	void		startChannelWaiter(IPCChannel * channel);
+	void		stopChannelWaiter(IPCChannel * channel);
 
 	bool		moduleInstallRunning()				const;
 	size_t		enginesStartableCount()				const;
@@ -148,6 +163,7 @@ private slots:
 	void	heartbeatTempFiles();
 
 	void	process();
+	void	processSoon();	///< Queues a call to process, unless one is queued already
 
 	void	restartEngineAfterCrash(EngineRepresentation * engine);
 
@@ -175,7 +191,8 @@ private:
 	RFilterStore					*	_waitingFilter					= nullptr;
 	bool								_stopProcessing					= false,
 										_dataMode						= false,
-										_filterRunning					= false;
+										_filterRunning					= false,
+										_processScheduled				= false;
 	int									_filterCurrentRequestID			= 0;
 	std::string							_memoryName,
 										_engineInfo;
@@ -183,10 +200,13 @@ private:
 	std::queue<RScriptStore*>			_waitingScripts;
 	std::queue<RComputeColumnStore*>	_waitingCompCols;
 	std::map<std::string,
-		EngineRepresentation * >		_moduleEngines;					///< An engine per module active. Engines will be started and closed as needed.
+		std::set<EngineRepresentation*>>_moduleEngines;					///< A pool of engines per active module, it grows up to maxEngineCount() when analyses are waiting. Engines will be started and closed as needed.
 	std::set<EngineRepresentation*>		_engines,						///< All analysis/utility/module engines, excepting _rCmder
 										_logCfgRequested;
 	std::vector<IPCChannel*>			_channels;						///< Channels are instantiated separately from the engines to avoid boost messing up
+	std::map<IPCChannel*,
+		IPCChannelWaiter*>				_channelWaiters;				///< Each channel has a thread waiting on it that calls processSoon when its engine sent something
+	EngineZygote					*	_zygote				= nullptr;	///< Forks new engines with R already initialized, when available
 	EngineRepresentation			*	_rCmder				= nullptr;	///< For those special occassions where you just want to shout at R in a more personal manner
 	IPCChannel						*	_rCmderChannel		= nullptr;	///< The channel for shouting at R in a more personal manner
 	std::vector<long>					_engineStopTimes;				///< Here we keep track of how long ago it is an engine shut down, this way we can give it a slight time between closing and starting an engine. To avoid shared memory problems on windows.
@@ -0,0 +1,222 @@
+#include "enginezygote.h"
+#include "engineprocess.h"
+#include "log.h"
+#include "timers.h"
+#include <sstream>
+
+#ifndef _WIN32
+#include <signal.h>
+#endif
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+EngineZygote::EngineZygote(QObject * parent) : QObject(parent)
+{}
+
+EngineZygote::~EngineZygote()
+{
+	_ready = false;
+
+#ifdef __linux__
+	if(_replyFd != -1)
+		::close(_replyFd);
+#endif
+
+	if(!_zygote)
+		return;
+
+	disconnect(_zygote, nullptr, this, nullptr);
+
+	//Closing stdin tells the zygote to stop, the engines it forked notice that on their own
+	_zygote->closeWriteChannel();
+
+	if(!_zygote->waitForFinished(500))
+		_zygote->kill();
+}
+
+void EngineZygote::start(const QString & engineExe, const QStringList & arguments, const QProcessEnvironment & env, const QString & workingDirectory)
+{
+	JASPTIMER_SCOPE(EngineZygote::start);
+
+#ifdef __linux__
+	//The replies get a pipe of their own, stdout is shared with every engine forked from the zygote and whatever R prints there
+	int replyPipe[2];
+	if(pipe2(replyPipe, O_CLOEXEC) != 0)
+	{
+		Log::log() << "Could not create a pipe for the engine zygote, engines will be started normally." << std::endl;
+		return;
+	}
+
+	_replyFd = replyPipe[0];
+	fcntl(_replyFd, F_SETFL, O_NONBLOCK);
+
+	const int		replyWriteFd	= replyPipe[1];
+	QProcessEnvironment	zygoteEnv	= env;
+	zygoteEnv.insert("JASP_ZYGOTE_REPLY_FD", QString::number(replyWriteFd));
+
+	_zygote = new QProcess(this);
+	_zygote->setProcessChannelMode(QProcess::ForwardedChannels);
+	_zygote->setProcessEnvironment(zygoteEnv);
+	_zygote->setWorkingDirectory(workingDirectory);
+	_zygote->setChildProcessModifier([replyWriteFd](){ fcntl(replyWriteFd, F_SETFD, 0); }); //Only the zygote should inherit the write end
+
+	_replyNotifier = new QSocketNotifier(_replyFd, QSocketNotifier::Read, this);
+
+	connect(_replyNotifier,	&QSocketNotifier::activated,											this, &EngineZygote::readReplies);
+	connect(_zygote,		QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),			this, &EngineZygote::zygoteFinished);
+
+	Log::log() << "Starting engine zygote" << std::endl;
+
+	_zygote->start(engineExe, arguments);
+
+	::close(replyWriteFd);
+#else
+	(void)engineExe; (void)arguments; (void)env; (void)workingDirectory;
+	Log::log() << "The engine zygote is only available on linux." << std::endl;
+#endif
+}
+
+void EngineZygote::requestFork(EngineProcess * engine, size_t channelNumber)
+{
+	if(!_ready)
+		throw std::runtime_error("EngineZygote::requestFork called for channel " + std::to_string(channelNumber) + " but the zygote isn't ready!");
+
+	if(_forking.count(channelNumber) && _forking[channelNumber])
+		Log::log() << "EngineZygote::requestFork called for channel " << channelNumber << " while an earlier fork for it is still pending, that one will be forgotten." << std::endl;
+
+	_forking[channelNumber] = engine;
+	_zygote->write(("fork " + std::to_string(channelNumber) + "\n").c_str());
+}
+
+void EngineZygote::forget(EngineProcess * engine)
+{
+	for(auto & channelEngine : _forking)
+		if(channelEngine.second == engine)
+			channelEngine.second = nullptr;
+
+	for(auto it = _forked.begin(); it != _forked.end(); it++)
+		if(it->second == engine)
+		{
+			_forked.erase(it);
+			break;
+		}
+}
+
+void EngineZygote::readReplies()
+{
+#ifdef __linux__
+	char	chunk[256];
+	ssize_t	got;
+
+	while((got = ::read(_replyFd, chunk, sizeof(chunk))) > 0)
+		_replies.append(chunk, got);
+
+	if(got == 0) //The zygote is gone, zygoteFinished takes care of the rest
+		_replyNotifier->setEnabled(false);
+
+	for(qsizetype newline; (newline = _replies.indexOf('\n')) != -1;)
+	{
+		const QByteArray line = _replies.left(newline);
+		_replies.remove(0, newline + 1);
+
+		handleReply(line.toStdString());
+	}
+#endif
+}
+
+void EngineZygote::handleReply(const std::string & reply)
+{
+	std::stringstream	replyStream(reply);
+	std::string			what;
+	replyStream >> what;
+
+	if(what == "ready")
+	{
+		Log::log() << "Engine zygote is ready, new engines will be forked from it." << std::endl;
+		_ready = true;
+	}
+	else if(what == "forked" || what == "failed")
+	{
+		size_t	channelNumber;
+		long	pid;
+		replyStream >> channelNumber >> pid;
+
+		auto forking = _forking.find(channelNumber);
+
+		if(forking == _forking.end())
+		{
+			Log::log() << "Engine zygote replied '" << reply << "' but no fork was requested for channel " << channelNumber << "..." << std::endl;
+#ifndef _WIN32
+			if(what == "forked")
+				::kill(pid, SIGKILL);
+#endif
+			return;
+		}
+
+		EngineProcess * engine = forking->second;
+		_forking.erase(forking);
+
+		if(what == "failed")
+		{
+			Log::log() << "Engine zygote failed to fork an engine for channel " << channelNumber << std::endl;
+			if(engine)
+				engine->forkedFinished(-1, QProcess::ExitStatus::CrashExit);
+		}
+		else if(!engine)
+		{
+#ifndef _WIN32
+			::kill(pid, SIGKILL); //Nobody wants it anymore
+#endif
+		}
+		else
+		{
+			Log::log() << "Engine zygote forked engine #" << channelNumber << " as pid " << pid << std::endl;
+			_forked[pid] = engine;
+			engine->forkedAs(pid);
+		}
+	}
+	else if(what == "exited")
+	{
+		long		pid;
+		int			exitCode;
+		std::string	how;
+		replyStream >> pid >> exitCode >> how;
+
+		if(!_forked.count(pid))
+			return;
+
+		EngineProcess * engine = _forked[pid];
+		_forked.erase(pid);
+
+		engine->forkedFinished(exitCode, how == "normal" ? QProcess::ExitStatus::NormalExit : QProcess::ExitStatus::CrashExit);
+	}
+	else
+		Log::log() << "Engine zygote sent unknown reply '" << reply << "'" << std::endl;
+}
+
+void EngineZygote::zygoteFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+	Log::log() << "Engine zygote stopped " << (exitStatus == QProcess::ExitStatus::NormalExit ? "normally" : "crashing") << " with exitCode " << exitCode << ", engines will be started normally from now on." << std::endl;
+
+	_ready = false;
+
+	//Its engines would notice it is gone themselves, but EngineSync should know right away so it can restart them
+	std::map<size_t, EngineProcess*>	forking;
+	std::map<long, EngineProcess*>		forked;
+
+	std::swap(forking,	_forking);
+	std::swap(forked,	_forked);
+
+	for(auto & pidEngine : forked)
+	{
+		pidEngine.second->kill();
+		pidEngine.second->forkedFinished(-1, QProcess::ExitStatus::CrashExit);
+	}
+
+	for(auto & channelEngine : forking)
+		if(channelEngine.second)
+			channelEngine.second->forkedFinished(-1, QProcess::ExitStatus::CrashExit);
+}
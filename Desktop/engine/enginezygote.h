@@ -0,0 +1,54 @@
+#ifndef ENGINEZYGOTE_H
+#define ENGINEZYGOTE_H
+
+#include <QObject>
+#include <QProcess>
+#include <QSocketNotifier>
+#include <map>
+
+class EngineProcess;
+
+///
+/// A jaspEngine started with "--zygote" that initializes R once and then forks a new engine for a channel whenever asked.
+/// This makes starting or restarting an engine take milliseconds instead of seconds, and the forked engines share the read-only pages of R with the zygote.
+/// Only used on Linux, EngineSync falls back to starting a normal jaspEngine when the zygote isn't (or no longer) ready.
+///
+/// Requests go as lines over stdin of the zygote, the replies come back as lines over a pipe of their own, whose write end is passed in JASP_ZYGOTE_REPLY_FD:
+///  - "ready"						once R is initialized
+///  - "forked <channel> <pid>"		or "failed <channel> <pid>" for each request
+///  - "exited <pid> <code> <how>"	when a forked engine stops, how is "normal" or "crash"
+/// The forked engines do not keep the write end, so nothing they print can get mixed up with the replies.
+/// The stdout and stderr of the zygote, and thereby of the engines, are forwarded to those of Desktop.
+///
+class EngineZygote : public QObject
+{
+	Q_OBJECT
+
+public:
+			EngineZygote(QObject * parent);
+			~EngineZygote();
+
+	void	start(const QString & engineExe, const QStringList & arguments, const QProcessEnvironment & env, const QString & workingDirectory);
+	bool	ready() const { return _ready; }
+
+private slots:
+	void	readReplies();
+	void	zygoteFinished(int exitCode, QProcess::ExitStatus exitStatus);
+
+private:
+	friend class EngineProcess;
+
+	void	requestFork(EngineProcess * engine, size_t channelNumber);
+	void	forget(		EngineProcess * engine);
+	void	handleReply(const std::string & reply);
+
+	QProcess						*	_zygote			= nullptr;
+	bool								_ready			= false;
+	int									_replyFd		= -1;		///< Read end of the pipe the zygote replies on
+	QSocketNotifier					*	_replyNotifier	= nullptr;
+	QByteArray							_replies;
+	std::map<size_t, EngineProcess*>	_forking;		///< Per channel, an entry is nullptr if the EngineProcess was deleted before its fork came back
+	std::map<long, EngineProcess*>		_forked;		///< Per pid
+};
+
+#endif // ENGINEZYGOTE_H
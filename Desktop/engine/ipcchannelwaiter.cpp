@@ -0,0 +1,64 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#include "ipcchannelwaiter.h"
+
+IPCChannelWaiter::IPCChannelWaiter(IPCChannel * channel, QObject * parent)
+	: QThread(parent), _channel(channel)
+{
+	setObjectName("IPCChannelWaiter #" + QString::number(channel->channelNumber()));
+
+	//A previous waiter on this channel might have aborted it when it was stopped
+	_channel->resumeGather();
+}
+
+IPCChannelWaiter::~IPCChannelWaiter()
+{
+	requestInterruption();
+	_channel->abortGather();
+	wait();
+}
+
+void IPCChannelWaiter::handled()
+{
+	if(_waiting.exchange(false))
+		_handled.release();
+}
+
+void IPCChannelWaiter::run()
+{
+	const int waitMs = 250; //Only determines how long it takes to notice an interruption request
+
+	while(!isInterruptionRequested())
+	{
+		if(_channel->gather())
+			msleep(_backoff = std::min(std::max(1, _backoff * 2), 50));
+
+		else if(_channel->gather(waitMs))
+			_backoff = 0;
+
+		else
+			continue;
+
+		_waiting = true;
+		emit messageWaiting();
+
+		while(_waiting && !isInterruptionRequested())
+			_handled.tryAcquire(1, waitMs);
+	}
+}
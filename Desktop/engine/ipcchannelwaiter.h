@@ -0,0 +1,54 @@
+//
+// Copyright (C) 2013-2018 University of Amsterdam
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Affero General Public License as
+// published by the Free Software Foundation, either version 3 of the
+// License, or (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Affero General Public License for more details.
+//
+// You should have received a copy of the GNU Affero General Public
+// License along with this program.  If not, see
+// <http://www.gnu.org/licenses/>.
+//
+
+#ifndef IPCCHANNELWAITER_H
+#define IPCCHANNELWAITER_H
+
+#include <QThread>
+#include <QSemaphore>
+#include <atomic>
+#include "ipcchannel.h"
+
+///
+/// Gathers the messages of an IPCChannel in its own thread and emits messageWaiting as soon as the engine sent a complete one.
+/// Waiting for the chunks of a streamed message thereby never blocks the main thread, where EngineSync::process takes the message from the channel and then calls handled.
+/// Until that happens the waiter leaves the channel alone.
+class IPCChannelWaiter : public QThread
+{
+	Q_OBJECT
+
+public:
+	IPCChannelWaiter(IPCChannel * channel, QObject * parent = nullptr);
+	~IPCChannelWaiter();
+
+	void handled(); ///< Called from the main thread once the replies were processed
+
+signals:
+	void messageWaiting();
+
+protected:
+	void run() override;
+
+private:
+	IPCChannel			*	_channel;
+	QSemaphore				_handled;
+	std::atomic<bool>		_waiting	= false;
+	int						_backoff	= 0;	///< Milliseconds to sleep when a message is still there right after the last one was handled, for instance because its engine is idle and EngineSync leaves it alone
+};
+
+#endif // IPCCHANNELWAITER_H
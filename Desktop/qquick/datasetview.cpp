@@ -3,7 +3,14 @@
 #include <QSGFlatColorMaterial>
 #include <QSGGeometry>
 #include <QSGNode>
+#include <QSGSimpleRectNode>
+#include <QSGSimpleTextureNode>
+#include <QQuickWindow>
+#include <QPainter>
+#include <QtMath>
 #include <queue>
+#include <set>
+#include <algorithm>
 #include "timers.h"
 #include "log.h"
 #include "gui/preferencesmodel.h"
@@ -50,6 +57,7 @@ DataSetView::DataSetView(QQuickItem *parent)
 
 	connect(PreferencesModel::prefs(),	&PreferencesModel::uiScaleChanged,				this, &DataSetView::resetItems,			Qt::QueuedConnection);
 	connect(PreferencesModel::prefs(),	&PreferencesModel::interfaceFontChanged,		this, &DataSetView::resetItems,			Qt::QueuedConnection);
+	connect(PreferencesModel::prefs(),	&PreferencesModel::currentThemeNameChanged,		this, &DataSetView::resetItems,			Qt::QueuedConnection); //The text tiles are painted with the colors of the theme
 
 	connect(DataSetPackage::pkg(),		&DataSetPackage::dataModeChanged,				this, &DataSetView::onDataModeChanged);
 	connect(_model,						&ExpandDataProxyModel::undoChanged,				this, &DataSetView::undoChanged);
@@ -63,6 +71,7 @@ DataSetView::DataSetView(QQuickItem *parent)
 void DataSetView::setModel(QAbstractItemModel * model)
 {
 	_model->setSourceModel(model);
+	_columnLayouts.clear();
 
 	if (model)
 	{
@@ -100,12 +109,12 @@ QSizeF DataSetView::getColumnSize(int col)
 {
 	QVariant maxColStringVar = _model->headerData(col, Qt::Orientation::Horizontal, _model->getRole("maxColString"));
 	if(!maxColStringVar.isNull())
-		return getTextSize(maxColStringVar.toString());
+		return getColumnTextSize(col, maxColStringVar.toString());
 	else
 	{
 		QVariant columnWidthFallbackVar = _model->headerData(col, Qt::Orientation::Horizontal, _model->getRole("columnWidthFallback"));
 
-		QSizeF columnSize = getTextSize("??????");
+		QSizeF columnSize = getColumnTextSize(col, "??????");
 
 		if(!columnWidthFallbackVar.isNull())
 			columnSize.setWidth(columnWidthFallbackVar.toFloat() - itemHorizontalPadding() * 2);
@@ -114,6 +123,28 @@ QSizeF DataSetView::getColumnSize(int col)
 	}
 }
 
+QSizeF DataSetView::getColumnTextSize(int col, const QString & text)
+{
+	if(col < 0 || size_t(col) >= _columnLayouts.size())
+		return getTextSize(text);
+
+	ColumnLayout & layout = _columnLayouts[col];
+
+	if(layout.measuredText != text || !layout.measuredSize.isValid())
+	{
+		layout.measuredText = text;
+		layout.measuredSize = getTextSize(text);
+	}
+
+	return layout.measuredSize;
+}
+
+void DataSetView::clearDisplayText()
+{
+	for(ColumnLayout & layout : _columnLayouts)
+		layout.displayText.clear();
+}
+
 QSizeF DataSetView::getRowHeaderSize()
 {
 	QString text = _model->headerData(0, Qt::Orientation::Vertical, _model->getRole("maxRowHeaderString")).toString();
@@ -128,6 +159,9 @@ void DataSetView::modelDataChanged(const QModelIndex &topLeft, const QModelIndex
 				rowMin = std::max(0,								topLeft.row()),
 				rowMax = std::min(_model->rowCount(),		bottomRight.row());
 
+	for(int col = colMin; col <= colMax && size_t(col) < _columnLayouts.size(); col++)
+		_columnLayouts[col].displayText.clear();
+
 	QSizeF calcSize = getColumnSize(colMin);
 
 	if (_cacheItems || int(_cellSizes[size_t(colMin)].width() * 10) != int(calcSize.width() * 10)) //If we cache items we are not expecting the user to make regular manual changes to the data, so if something changes we can do a reset. Otherwise we are in TableView and we do it only when the column size changes.
@@ -137,6 +171,9 @@ void DataSetView::modelDataChanged(const QModelIndex &topLeft, const QModelIndex
 		// This is a special case for the VariablesWindows & TableView: caching mixed up the items, so it can't be used
 		// but the selected context property must be updated for VariablesWindows
 		// and the itemText must be updated for Grid TableView (used in Plot Editor).
+		if(roles.contains(Qt::DisplayRole))
+			invalidateTextTiles(rowMin, rowMax, colMin, colMax);
+
 		for (int col = colMin; col <= colMax; col++)
 			for (int row = rowMin; row <= rowMax; row++)
 			{
@@ -168,8 +205,14 @@ void DataSetView::modelDataChanged(const QModelIndex &topLeft, const QModelIndex
 
 }
 
-void DataSetView::modelHeaderDataChanged(Qt::Orientation, int, int)
+void DataSetView::modelHeaderDataChanged(Qt::Orientation orientation, int first, int last)
 {
+	if(orientation == Qt::Horizontal)
+		for(int col = std::max(0, first); col <= last && size_t(col) < _columnLayouts.size(); col++)
+			_columnLayouts[col].displayText.clear(); //Labels might have changed
+	else
+		clearDisplayText();
+
 	calculateCellSizes();
 }
 
@@ -180,7 +223,7 @@ void DataSetView::modelAboutToBeReset()
 	delete _selectionModel;
 	_selectionModel = nullptr;
 	_storedLineFlags.clear();
-	_storedDisplayText.clear();
+	clearDisplayText();
 }
 
 void DataSetView::modelWasReset()
@@ -203,7 +246,7 @@ void DataSetView::calculateCellSizesAndClear(bool clearStorage)
 	_cellSizes.clear();
 	_dataColsMaxWidth.clear();
 	_storedLineFlags.clear();
-	_storedDisplayText.clear();
+	_textTiles.clear();
 
 	for(auto & col : _cellTextItems)
 	{
@@ -231,12 +274,14 @@ void DataSetView::calculateCellSizesAndClear(bool clearStorage)
 		_rowNumberStorage		= {};
 		_columnHeaderStorage	= {};
 		_textItemStorage		= {};
+		_columnLayouts.clear(); //The font or scaling might have changed
 	}
 
 	if(_model == nullptr) return;
 
 	_cellSizes.resize(_model->columnCount());
 	_colXPositions.resize(_model->columnCount());
+	_columnLayouts.resize(_model->columnCount());
 	_cellTextItems.clear();
 
 	for(int col=0; col<_model->columnCount(); col++)
@@ -250,10 +295,6 @@ void DataSetView::calculateCellSizesAndClear(bool clearStorage)
 	setHeaderHeight(_model->columnCount() == 0 ? 0 : _cellSizes[0].height() + _itemVerticalPadding * 2);
 	setRowNumberWidth(getRowHeaderSize().width());
 
-	float w = _rowNumberMaxWidth;
-	for(int col=0; col<_model->columnCount(); col++)
-		w += _dataColsMaxWidth[col];
-
 	float x = _rowNumberMaxWidth;
 
 	for(int col=0; col<_model->columnCount(); col++)
@@ -262,7 +303,7 @@ void DataSetView::calculateCellSizesAndClear(bool clearStorage)
 		x += _dataColsMaxWidth[col];
 	}
 
-	_dataWidth = w;
+	_dataWidth = x;
 
 	qreal	newWidth	= (_extraColumnItem != nullptr && !expandDataSet() ? _dataRowsMaxHeight + 1 : 0 ) + _dataWidth,
 			newHeight	= _dataRowsMaxHeight * (_model->rowCount() + 1);
@@ -318,22 +359,9 @@ void DataSetView::determineCurrentViewPortIndices()
 	QVector2D viewSize(_viewportW, _viewportH);
 	QVector2D rightBottom(leftTop + viewSize);
 
-	_currentViewportColMax = -1;
-	_currentViewportColMin = -1;
-
-	float cumulative = 0;
-	for(int col=0; col<_model->columnCount() && _currentViewportColMax == -1; col++)
-	{
-		if(_currentViewportColMax == -1 && cumulative > rightBottom.x())						_currentViewportColMax = col;
-
-		float prevCum = cumulative;
-		cumulative += _dataColsMaxWidth[col];
-
-		if(_currentViewportColMin == -1 && cumulative > leftTop.x() && prevCum < leftTop.x())	_currentViewportColMin = col;
-	}
-
-	if(_currentViewportColMax == -1)
-		_currentViewportColMax = _model->columnCount();
+	//_colXPositions is sorted so we can just look up the first column starting to the right of either side of the viewport
+	_currentViewportColMin = std::max(0, int(std::upper_bound(_colXPositions.begin(), _colXPositions.end(), leftTop.x())		- _colXPositions.begin()) - 1);
+	_currentViewportColMax =			 int(std::upper_bound(_colXPositions.begin(), _colXPositions.end(), rightBottom.x())	- _colXPositions.begin());
 
 	_currentViewportColMin = std::max(0, std::min(_model->columnCount(),	_currentViewportColMin							- _viewportMargin));
 	_currentViewportColMax = std::max(0, std::min(_model->columnCount(),	_currentViewportColMax							+ _viewportMargin));
@@ -450,7 +478,7 @@ void DataSetView::buildNewLinesAndCreateNewItems()
 					down	= (lineFlags & 8) > 0	&& pos1y  > _dataRowsMaxHeight + _viewportY;
 
 #ifdef SHOW_ITEMS_PLEASE
-			if(!(editing() && row == _prevEditRow && col == _prevEditCol))
+			if(!_drawCellText && !(editing() && row == _prevEditRow && col == _prevEditCol))
 				createTextItem(row, col);
 #endif
 
@@ -543,6 +571,9 @@ void DataSetView::buildNewLinesAndCreateNewItems()
 	else
 		destroyEditItem();
 
+	if(_drawCellText)
+		updateTextTiles();
+
 	JASPTIMER_STOP(DataSetView::buildNewLinesAndCreateNewItems);
 }
 
@@ -618,6 +649,133 @@ QQuickItem * DataSetView::createTextItem(int row, int col)
 	return _cellTextItems[col][row]->item;
 }
 
+void DataSetView::setDrawCellText(bool drawCellText)
+{
+	if(drawCellText == _drawCellText)
+		return;
+
+	_drawCellText = drawCellText;
+	emit drawCellTextChanged();
+
+	calculateCellSizesAndClear(true); //Gets rid of the current items or tiles
+	update();
+}
+
+QPoint DataSetView::cellAt(double x, double y)
+{
+	const int	col = int(std::upper_bound(_colXPositions.begin(), _colXPositions.end(), x) - _colXPositions.begin()) - 1,
+				row = int(y / _dataRowsMaxHeight) - 1;
+
+	if(col < 0 || row < 0 || row >= _model->rowCount() || size_t(col) >= _dataColsMaxWidth.size() || x >= _colXPositions[col] + _dataColsMaxWidth[col])
+		return QPoint(-1, -1);
+
+	return QPoint(col, row);
+}
+
+QString DataSetView::cellDisplayText(int row, int col, bool isEditable)
+{
+	std::map<size_t, QString> & displayText = _columnLayouts[col].displayText;
+
+	if(isEditable || displayText.count(row) == 0)
+		displayText[row] = _model->data(row, col, Qt::DisplayRole).toString();
+
+	return displayText[row];
+}
+
+void DataSetView::updateTextTiles()
+{
+	if(_model == nullptr || _currentViewportColMin < 0 || _currentViewportRowMin < 0 || _colXPositions.size() != size_t(_model->columnCount()) || _columnLayouts.size() != _colXPositions.size())
+		return;
+
+	JASPTIMER_RESUME(DataSetView::updateTextTiles);
+
+	const int	rowTileMin = _currentViewportRowMin / _textTileRows,
+				rowTileMax = (_currentViewportRowMax - 1) / _textTileRows,
+				colTileMin = _currentViewportColMin / _textTileCols,
+				colTileMax = (_currentViewportColMax - 1) / _textTileCols;
+
+	//Painting a tile again when it comes back into view is cheap enough and this way a large dataset does not pile up images
+	for(auto tileIt = _textTiles.begin(); tileIt != _textTiles.end();)
+		if(tileIt->first.first < rowTileMin || tileIt->first.first > rowTileMax || tileIt->first.second < colTileMin || tileIt->first.second > colTileMax)
+			tileIt = _textTiles.erase(tileIt);
+		else
+			tileIt++;
+
+	for(int rowTile = rowTileMin; rowTile <= rowTileMax; rowTile++)
+		for(int colTile = colTileMin; colTile <= colTileMax; colTile++)
+		{
+			TextTile & tile = _textTiles[TextTileKey(rowTile, colTile)];
+
+			if(tile.version == -1)
+				paintTextTile(rowTile, colTile, tile);
+		}
+
+	JASPTIMER_STOP(DataSetView::updateTextTiles);
+}
+
+void DataSetView::paintTextTile(int rowTile, int colTile, TextTile & tile)
+{
+	JASPTIMER_SCOPE(DataSetView::paintTextTile);
+
+	const int	rowMin = rowTile * _textTileRows,
+				rowMax = std::min(_model->rowCount(),		rowMin + _textTileRows),
+				colMin = colTile * _textTileCols,
+				colMax = std::min(_model->columnCount(),	colMin + _textTileCols);
+
+	tile.version = ++_textTileVersion;
+
+	if(rowMax <= rowMin || colMax <= colMin)
+	{
+		tile.image	= QImage();
+		tile.rect	= QRectF();
+		return;
+	}
+
+	tile.rect = QRectF(_colXPositions[colMin], (rowMin + 1) * _dataRowsMaxHeight, _colXPositions[colMax - 1] + _dataColsMaxWidth[colMax - 1] - _colXPositions[colMin], (rowMax - rowMin) * _dataRowsMaxHeight);
+
+	const qreal	pixelRatio = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+
+	tile.image = QImage(qCeil(tile.rect.width() * pixelRatio), qCeil(tile.rect.height() * pixelRatio), QImage::Format_ARGB32_Premultiplied);
+	tile.image.setDevicePixelRatio(pixelRatio);
+	tile.image.fill(Qt::transparent);
+
+	JaspTheme	*	theme		= JaspTheme::currentTheme();
+	QPainter		painter(&tile.image);
+
+	painter.setFont(theme ? theme->font() : QFont());
+
+	const QColor	active		= theme ? theme->textEnabled()	: QColor(Qt::black),
+					inactive	= theme ? theme->textDisabled()	: QColor(Qt::gray);
+
+	for(int row=rowMin; row<rowMax; row++)
+		for(int col=colMin; col<colMax; col++)
+		{
+			if(editing() && row == _prevEditRow && col == _prevEditCol)
+				continue; //The edit item is there
+
+			QRectF cell(	_colXPositions[col]				- tile.rect.x() + _itemHorizontalPadding,
+							(row + 1) * _dataRowsMaxHeight	- tile.rect.y() + _itemVerticalPadding,
+							_dataColsMaxWidth[col]	- 2 * _itemHorizontalPadding,
+							_dataRowsMaxHeight		- 2 * _itemVerticalPadding);
+
+			painter.setPen(_model->filtered(row, col) ? active : inactive);
+			painter.drawText(cell, Qt::AlignLeft | Qt::AlignVCenter | Qt::TextSingleLine, cellDisplayText(row, col, bool(_model->flags(row, col) & Qt::ItemIsEditable)));
+		}
+}
+
+void DataSetView::invalidateTextTiles(int rowMin, int rowMax, int colMin, int colMax)
+{
+	if(!_drawCellText || rowMax < rowMin || colMax < colMin)
+		return;
+
+	for(int rowTile = rowMin / _textTileRows; rowTile <= rowMax / _textTileRows; rowTile++)
+		for(int colTile = colMin / _textTileCols; colTile <= colMax / _textTileCols; colTile++)
+			_textTiles.erase(TextTileKey(rowTile, colTile));
+
+	updateTextTiles();
+	update();
+}
+
 void DataSetView::setTextItemInfo(int row, int col, QQuickItem * textItem)
 {
 	JASPTIMER_SCOPE(DataSetView::setTextItemInfo);
@@ -925,7 +1083,10 @@ void DataSetView::destroyEditItem(bool createItem)
 	delete _editItemContextual;
 	_editItemContextual				= nullptr;
 
-	if(createItem && !(_prevEditRow == -1 || _prevEditCol == -1))
+	const int	editRow = _prevEditRow,
+				editCol = _prevEditCol;
+
+	if(createItem && !_drawCellText && !(_prevEditRow == -1 || _prevEditCol == -1))
 	{
 		Log::log() << "Restoring text item for old edit item at " << _prevEditRow << ", " << _prevEditCol << std::endl;
 		QQuickItem * item = createTextItem(_prevEditRow, _prevEditCol);
@@ -935,7 +1096,7 @@ void DataSetView::destroyEditItem(bool createItem)
 		//A delay might help the focus problem? No it doesnt...
 		//QTimer::singleShot(10, _cellTextItems[col][row]->item, [col, row, this](){ if (_cellTextItems.contains(col) && _cellTextItems[col].contains(row) && _cellTextItems[col][row]->item) _cellTextItems[col][row]->item->forceActiveFocus(); });
 
-		//Log::log() << "Restored text item has _storedDisplayText[" << _prevEditRow << "][" << _prevEditCol << "]: '" << _storedDisplayText[_prevEditRow][_prevEditCol] << "'" << std::endl;
+		//Log::log() << "Restored text item has displayText[" << _prevEditRow << "][" << _prevEditCol << "]: '" << _columnLayouts[_prevEditCol].displayText[_prevEditRow] << "'" << std::endl;
 	}
 	else
 		Log::log() << "Not creating text item" << std::endl;
@@ -943,6 +1104,9 @@ void DataSetView::destroyEditItem(bool createItem)
 
 	_prevEditRow = -1;
 	_prevEditCol = -1;
+
+	if(editRow != -1 && editCol != -1)
+		invalidateTextTile(editRow, editCol); //The cell was left out of its tile while it was being edited
 }
 
 void DataSetView::positionEditItem(int row, int col)
@@ -972,7 +1136,7 @@ void DataSetView::positionEditItem(int row, int col)
 	if(!_editItemContextual)
 	{
 		_editItemContextual = new ItemContextualized(setStyleDataItem(nullptr, active, col, row, false));
-		//Log::log() << "Edit item has          _storedDisplayText[" << row << "][" << col << "]: '" << _storedDisplayText[row][col] << "'" << std::endl;
+		//Log::log() << "Edit item has          displayText[" << row << "][" << col << "]: '" << _columnLayouts[col].displayText[row] << "'" << std::endl;
 
 		//forceActiveFocus();
 
@@ -980,6 +1144,7 @@ void DataSetView::positionEditItem(int row, int col)
 		storeTextItem(row, col, true);
 		_prevEditRow = row; //Store info to recreate it later
 		_prevEditCol = col;
+		invalidateTextTile(row, col);
 
 		QQmlIncubator localIncubator(QQmlIncubator::Synchronous);
 		_editDelegate->create(localIncubator, _editItemContextual->context);
@@ -995,7 +1160,7 @@ void DataSetView::positionEditItem(int row, int col)
 	{
 		//Log::log() << "repositioning current edit item (row=" << row << ", col=" << col << ")" << std::endl;
 		setStyleDataItem(_editItemContextual->context, active, col, row, false);
-		//Log::log() << "Edit item has          _storedDisplayText[" << row << "][" << col << "]: '" << _storedDisplayText[row][col] << "'" << std::endl;
+		//Log::log() << "Edit item has          displayText[" << row << "][" << col << "]: '" << _columnLayouts[col].displayText[row] << "'" << std::endl;
 	}
 
 	setTextItemInfo(row, col, _editItemContextual->item); //Will set it visible
@@ -1026,6 +1191,9 @@ void DataSetView::setSelectionStart(QPoint selectionStart)
 
 	_selectionEnd = QPoint(-1, -1);
 	emit selectionEndChanged(_selectionEnd);
+
+	if(_drawCellText)
+		update(); //The selection is drawn in updatePaintNode
 }
 
 void DataSetView::setSelectionEnd(QPoint selectionEnd)
@@ -1051,6 +1219,9 @@ void DataSetView::setSelectionEnd(QPoint selectionEnd)
 		_selectionModel->select(QItemSelection(_model->index(_selectionStart.y(), _selectionStart.x()), _model->index(_selectionEnd.y(), _selectionEnd.x())), QItemSelectionModel::ClearAndSelect);
 
 	_selectScrollMs = Utils::currentMillis();
+
+	if(_drawCellText)
+		update();
 }
 
 bool DataSetView::isSelected(int row, int col)
@@ -1549,6 +1720,9 @@ void DataSetView::onDataModeChanged(bool dataMode)
 		destroyEditItem();
 		setEditing(false);
 	}
+
+	if(_drawCellText)
+		update(); //Selection is only shown in datamode
 }
 
 void DataSetView::commitLastEdit()
@@ -1565,10 +1739,7 @@ QQmlContext * DataSetView::setStyleDataItem(QQmlContext * previousContext, bool
 
 	bool isEditable(_model->flags(row, col) & Qt::ItemIsEditable);
 
-	if(isEditable || _storedDisplayText.count(row) == 0 || _storedDisplayText[row].count(col) == 0)
-		_storedDisplayText[row][col] = _model->data(row, col, Qt::DisplayRole).toString();
-
-	QString text = _storedDisplayText[row][col];
+	QString text = cellDisplayText(row, col, isEditable);
 
 	if(isEditable && text == tq(ColumnUtils::emptyValue) && !emptyValLabel)
 		text = "";
@@ -1790,6 +1961,86 @@ void DataSetView::myParentChanged(QQuickItem * newParentItem)
 }
 
 #ifdef ADD_LINES_PLEASE
+/// Shows a TextTile in the scenegraph and remembers which version of it was uploaded
+class TextTileNode : public QSGSimpleTextureNode
+{
+public:
+	TextTileNode(TextTileKey key) : key(key) { setOwnsTexture(true); }
+
+	void setTile(QQuickWindow * window, const TextTile & tile)
+	{
+		setTexture(window->createTextureFromImage(tile.image)); //Deletes the previous texture because we own it
+		setRect(tile.rect);
+		version = tile.version;
+	}
+
+	const TextTileKey	key;
+	int					version = -1;
+};
+
+void DataSetView::updateTextTileNodes(QSGNode * tilesNode)
+{
+	JASPTIMER_SCOPE(DataSetView::updateTextTileNodes);
+
+	std::set<TextTileKey> shown;
+
+	for(QSGNode * child = tilesNode->firstChild(); child;)
+	{
+		TextTileNode * tileNode = static_cast<TextTileNode*>(child);
+		child = child->nextSibling();
+
+		auto tileIt = _textTiles.find(tileNode->key);
+
+		if(tileIt == _textTiles.end() || tileIt->second.image.isNull())
+		{
+			tilesNode->removeChildNode(tileNode);
+			delete tileNode;
+			continue;
+		}
+
+		if(tileNode->version != tileIt->second.version)
+			tileNode->setTile(window(), tileIt->second);
+
+		shown.insert(tileNode->key);
+	}
+
+	for(const auto & keyTile : _textTiles)
+		if(!keyTile.second.image.isNull() && shown.count(keyTile.first) == 0)
+		{
+			TextTileNode * tileNode = new TextTileNode(keyTile.first);
+			tileNode->setTile(window(), keyTile.second);
+			tilesNode->appendChildNode(tileNode);
+		}
+}
+
+void DataSetView::updateSelectionNode(QSGNode * selectionNode)
+{
+	while(QSGNode * child = selectionNode->firstChild())
+	{
+		selectionNode->removeChildNode(child);
+		delete child;
+	}
+
+	//Without drawCellText the itemDelegate takes care of showing the selection
+	if(!_drawCellText || !_selectionModel || !JaspTheme::currentTheme() || !DataSetPackage::pkg()->dataMode())
+		return;
+
+	for(const QItemSelectionRange & range : _selectionModel->selection())
+	{
+		const int	left	= std::max(range.left(),	_currentViewportColMin),
+					right	= std::min(range.right(),	std::min(_currentViewportColMax, int(_colXPositions.size())) - 1),
+					top		= std::max(range.top(),		_currentViewportRowMin),
+					bottom	= std::min(range.bottom(),	_currentViewportRowMax - 1);
+
+		if(left > right || top > bottom)
+			continue;
+
+		QRectF rect(_colXPositions[left], (top + 1) * _dataRowsMaxHeight, _colXPositions[right] + _dataColsMaxWidth[right] - _colXPositions[left], (bottom - top + 1) * _dataRowsMaxHeight);
+
+		selectionNode->appendChildNode(new QSGSimpleRectNode(rect, JaspTheme::currentTheme()->itemHighlight()));
+	}
+}
+
 QSGNode * DataSetView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
 	//JASPTIMER_RESUME(DataSetView::updatePaintNode);
@@ -1804,19 +2055,44 @@ QSGNode * DataSetView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 
 	const int linesPerNode = 2048;
 
-	if(oldNode)
+#ifdef DATASETVIEW_DEBUG_FRAMETIME
+	static long	framesStartMs	= Utils::currentMillis();
+	static int	frames			= 0;
+
+	if(++frames == 120)
 	{
-		delete oldNode;
-		oldNode = nullptr;
+		long nowMs = Utils::currentMillis();
+		Log::log() << "DataSetView took on average " << (nowMs - framesStartMs) / 120.0 << "ms per frame over the last 120 with " << _textTiles.size() << " text tiles and " << _cellTextItems.size() << " columns of items" << std::endl;
+		framesStartMs	= nowMs;
+		frames			= 0;
+	}
+#endif
+
+	//The root has the selection, the tiles of text and the lines as children, in that order so they are drawn over each other correctly.
+	//Only the tiles are kept between updates because their textures might be expensive to upload, the rest is just rebuilt.
+	if(!oldNode)
+	{
+		oldNode = new QSGNode();
+		oldNode->appendChildNode(new QSGNode());
+		oldNode->appendChildNode(new QSGNode());
+		oldNode->appendChildNode(new QSGNode());
 	}
 
-	if(!oldNode)				oldNode = new QSGNode();
-	else if(!_linesWasChanged)	return oldNode;
+	QSGNode	*	selectionNode	= oldNode->firstChild(),
+			*	tilesNode		= selectionNode->nextSibling(),
+			*	linesNode		= tilesNode->nextSibling();
+
+	updateSelectionNode(selectionNode);
+	updateTextTileNodes(tilesNode);
 
+	oldNode->removeChildNode(linesNode);
+	delete linesNode;
+	linesNode = new QSGNode();
+	oldNode->appendChildNode(linesNode);
 
-	QSGGeometryNode * currentNode = static_cast<QSGGeometryNode*>(oldNode->firstChild());
+	QSGGeometryNode * currentNode = nullptr;
 
-	oldNode->markDirty(QSGNode::DirtyGeometry);
+	linesNode->markDirty(QSGNode::DirtyGeometry);
 
 
 	for(int lineIndex=0; lineIndex < _linesActualSize;)
@@ -1834,7 +2110,7 @@ QSGNode * DataSetView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 
 			justAdded = true;
 
-			oldNode->markDirty(QSGNode::DirtyNodeAdded);
+			linesNode->markDirty(QSGNode::DirtyNodeAdded);
 		}
 
 		int geomSize = std::min(linesPerNode, (int)(_linesActualSize - lineIndex) / 4); //_lines is floats x, y, x, y so each set of 4 is a single line.
@@ -1854,7 +2130,7 @@ QSGNode * DataSetView::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 		currentNode->setGeometry(geometry);
 
 		if(justAdded)
-			oldNode->appendChildNode(currentNode);
+			linesNode->appendChildNode(currentNode);
 
 		currentNode = static_cast<QSGGeometryNode*>(currentNode->nextSibling());
 	}
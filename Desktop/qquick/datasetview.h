@@ -7,6 +7,7 @@
 #include <vector>
 #include <stack>
 #include <QSGFlatColorMaterial>
+#include <QImage>
 
 #include <map>
 #include <QtQml>
@@ -18,6 +19,7 @@
 
 //#define DATASETVIEW_DEBUG_VIEWPORT
 //#define DATASETVIEW_DEBUG_CREATION
+//#define DATASETVIEW_DEBUG_FRAMETIME
 
 #define SHOW_ITEMS_PLEASE
 #define ADD_LINES_PLEASE
@@ -30,10 +32,29 @@ struct ItemContextualized
 	QQmlContext * context;
 };
 
+/// What DataSetView remembers per column between layouts, so that only columns whose content actually changed need to be measured or asked for their text again
+struct ColumnLayout
+{
+	QString						measuredText;	///< The text the size of the column was determined from, if it is still the same so is the size
+	QSizeF						measuredSize;
+	std::map<size_t, QString>	displayText;	///< [row]
+};
+
+/// A block of cells painted into a single image when DataSetView::drawCellText is on, the scenegraph then shows it as one texture
+struct TextTile
+{
+	QImage	image;
+	QRectF	rect;			///< Where the image goes in DataSetView
+	int		version = -1;	///< Changes every time the image is painted, so updatePaintNode knows it needs to upload it again
+};
+
+typedef std::pair<int, int> TextTileKey; ///< [rowTile, colTile]
+
 /// Custom QQuickItem to render data tables witch caching and only displaying the necessary cells and lines
 /// Supports scaling the data into millions of columns and rows without any noticable slowdowns (the model could slow it down though)
 /// Contains custom rendering code for the lines to make sure they are always a single pixel wide.
 /// Caching is a bit flawed at the moment though so when changing data in the model it is best to turn that off.
+/// With drawCellText on the cells are not items at all, their text is painted per tile and shown directly by the scenegraph. Only the cell being edited gets an actual item, from editDelegate.
 /// It also uses pools of header-, rowheader- and general-items when they go out of view to avoid the overhead of recreating them all the time.
 class DataSetView : public QQuickItem
 {
@@ -56,6 +77,7 @@ class DataSetView : public QQuickItem
 	Q_PROPERTY( double					rowNumberWidth			READ rowNumberWidth			WRITE setRowNumberWidth			NOTIFY rowNumberWidthChanged		)
 	Q_PROPERTY( bool					cacheItems				READ cacheItems				WRITE setCacheItems				NOTIFY cacheItemsChanged			)
 	Q_PROPERTY( bool					expandDataSet			READ expandDataSet			WRITE setExpandDataSet			NOTIFY expandDataSetChanged			)
+	Q_PROPERTY( bool					drawCellText			READ drawCellText			WRITE setDrawCellText			NOTIFY drawCellTextChanged			)
 	Q_PROPERTY( QQuickItem			*	tableViewItem			READ tableViewItem			WRITE setTableViewItem												)
 	Q_PROPERTY( QItemSelectionModel *	selection				READ selectionModel											NOTIFY selectionModelChanged		)
 	Q_PROPERTY(	QPoint					selectionStart			READ selectionStart			WRITE setSelectionStart			NOTIFY selectionStartChanged		)
@@ -96,6 +118,7 @@ public:
 
 	bool					cacheItems()						const	{ return _cacheItems;				}
 	bool					expandDataSet()						const	{ return _model ? _model->expandDataSet() : false;			}
+	bool					drawCellText()						const	{ return _drawCellText;				}
 	QPoint					selectionStart()					const	{ return _selectionStart;			}
 	QPoint					selectionEnd()						const	{ return _selectionEnd;				}
 	bool					editing()							const	{ return _editing;		}
@@ -121,6 +144,7 @@ public:
 	void setTableViewItem(			QQuickItem		* tableViewItem) { _tableViewItem = tableViewItem; }
 	void setCacheItems(				bool			  cacheItems);
 	void setExpandDataSet(			bool			  expandDataSet);
+	void setDrawCellText(			bool			  drawCellText);
 
 	void resetItems();
 
@@ -153,6 +177,7 @@ signals:
 
 	void		cacheItemsChanged();
 	void		expandDataSetChanged();
+	void		drawCellTextChanged();
 	
 	void		selectionStartChanged(	QPoint selectionStart);
 	void		selectionEndChanged(	QPoint selectionEnd);
@@ -192,6 +217,7 @@ public slots:
 	bool		isColumnHeader	(const QPoint& p) { return p.x() >= 0	&& p.y() == -1; }
 	bool		isRowHeader		(const QPoint& p) { return p.x() == -1	&& p.y() >= 0;	}
 	bool		isCell			(const QPoint& p) { return p.x() >= 0	&& p.y() >= 0;	}
+	QPoint		cellAt			(double x, double y); ///< Column and row of the cell at x,y, or -1,-1 if there is none. For handling the mouse when drawCellText is on and there are no items to click on
 
 
 
@@ -247,6 +273,8 @@ protected:
 
 #ifdef ADD_LINES_PLEASE
 	QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+	void	updateTextTileNodes(QSGNode * tilesNode);
+	void	updateSelectionNode(QSGNode * selectionNode);
 #endif
 	float extraColumnWidth() { return !_extraColumnItem || expandDataSet() ? 0 : 2 + _extraColumnItem->width(); }
 
@@ -265,6 +293,12 @@ protected:
 	void			updateExtraColumnItem();
 	void			positionEditItem(	int row, int col);
 
+	QString			cellDisplayText(int row, int col, bool isEditable);
+	void			updateTextTiles();															///< Paints the tiles in view that are not there yet and drops those out of view
+	void			paintTextTile(int rowTile, int colTile, TextTile & tile);
+	void			invalidateTextTiles(int rowMin, int rowMax, int colMin, int colMax);		///< Inclusive, repaints the tiles containing these cells
+	void			invalidateTextTile(int row, int col) { invalidateTextTiles(row, row, col, col); }
+
 	QQmlContext *	setStyleDataItem(			QQmlContext * previousContext, bool active, size_t col, size_t row, bool emptyValLabel = true);
 	QQmlContext *	setStyleDataRowNumber(		QQmlContext * previousContext, QString text, int row);
 	QQmlContext *	setStyleDataColumnHeader(	QQmlContext * previousContext, QString text, int column, bool isComputed, bool isInvalidated, bool isFiltered,  QString computedError, int columnType, int computedColumnType);
@@ -274,12 +308,15 @@ protected:
 
 	QSizeF			getTextSize(const QString& text)	const;
 	QSizeF			getColumnSize(int col);
+	QSizeF			getColumnTextSize(int col, const QString & text);
+	void			clearDisplayText();
 	QSizeF			getRowHeaderSize();
 
 protected:
 	QItemSelectionModel									*	_selectionModel			= nullptr;
 	ExpandDataProxyModel								*	_model					= nullptr;
 	std::vector<QSizeF>										_cellSizes;							//[col]
+	std::vector<ColumnLayout>								_columnLayouts;						//[col]
 	std::vector<double>										_colXPositions,						//[col][row]
 															_dataColsMaxWidth;
 	std::stack<ItemContextualized*>							_textItemStorage,
@@ -301,14 +338,15 @@ protected:
 	ItemContextualized									*	_editItemContextual		= nullptr;
 	QSGFlatColorMaterial									_material;
 	std::map<size_t, std::map<size_t, unsigned char>>		_storedLineFlags;
-	std::map<size_t, std::map<size_t, QString>>				_storedDisplayText;
+	std::map<TextTileKey, TextTile>							_textTiles;
 	static DataSetView									*	_lastInstancedDataSetView;
 	
 	bool		_cacheItems				= true,
 				_recalculateCellSizes	= false,
 				_ignoreViewpoint		= true,
 				_linesWasChanged		= false,
-				_editing				= false;
+				_editing				= false,
+				_drawCellText			= false;
 	double		_dataRowsMaxHeight,
 				_dataWidth				= -1,
 				_rowNumberMaxWidth		= 0,
@@ -328,7 +366,8 @@ protected:
 				_currentViewportRowMin	= -1,
 				_currentViewportRowMax	= -1,
 				_prevEditRow			= -1,
-				_prevEditCol			= -1;
+				_prevEditCol			= -1,
+				_textTileVersion		=  0;
 	size_t		_linesActualSize		= 0;
 	long		_selectScrollMs			= 0;
 	QPoint		_selectionStart			= QPoint(-1, -1),
@@ -336,6 +375,9 @@ protected:
 	std::vector<Json::Value>	_copiedColumns;
 	QString						_lastJaspCopyIntoClipboard;
 
+	static constexpr int		_textTileRows			= 16,	///< Small enough to keep the images of the tiles in view from taking up too much memory on a high dpi screen
+								_textTileCols			= 4;
+
 
 };
 
@@ -79,6 +79,7 @@ const Settings::Setting Settings::Values[] = {
 	{"dbImportPassword",			""		},
 	{"dbImportQuery",				""		},
 	{"dbImportInterval",			0		},
+	{"dbImportKeyColumn",			""		},
 	{"dbShowWarning",				true	},
 	{"dbRememberMe",				false	},
 	{"dataNALabel",					""		},
@@ -88,6 +89,8 @@ const Settings::Setting Settings::Values[] = {
 	{"showAllROptions",				false	},
 	{"showRSyntaxInResults",		false	},
 	{"ALTNavModeActive",			true	},
+	{"dataValuesMapped",			false	}, //Keeps the values of the columns in memory-mapped files in the sessiondir, shared with the engines, see MappedColumnStore
+	{"engineDataSetCacheMB",		256		}, //How much memory each engine may keep for the R vectors of previously read columns, 0 turns it off
 	{"guiQtTextRender",				true	}
 };	
 
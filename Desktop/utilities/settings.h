@@ -65,6 +65,7 @@ public:
 		DB_IMPORT_PASSWORD,
 		DB_IMPORT_QUERY,
 		DB_IMPORT_INTERVAL,
+		DB_IMPORT_KEYCOLUMN,
 		DB_SHOW_WARNING,
 		DB_REMEMBER_ME,
 		DATA_LABEL_NA,
@@ -73,7 +74,9 @@ public:
 		SHOW_RSYNTAX,
 		SHOW_ALL_R_OPTIONS,
 		SHOW_RSYNTAX_IN_RESULTS,
-		ALTNAVMODE_ACTIVE
+		ALTNAVMODE_ACTIVE,
+		DATA_VALUES_MAPPED,
+		ENGINE_DATASET_CACHE_MB
 	};
 
 	static QVariant value(Settings::Type key);
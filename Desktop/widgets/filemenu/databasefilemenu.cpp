@@ -48,6 +48,7 @@ DatabaseFileMenu::DatabaseFileMenu(FileMenu *parent)
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::queryChanged			);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::resultsOKChanged		);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::intervalChanged		);
+	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::keyColumnChanged		);
 	QObject::connect(this, &DatabaseFileMenu::allChanged, this, &DatabaseFileMenu::rememberMeChanged	);
 }
 
@@ -61,6 +62,7 @@ void DatabaseFileMenu::loadFromSettings()
 	_info._password		= decrypt(				Settings::value( Settings::DB_IMPORT_PASSWORD	).toString());
 	_info._query		=						Settings::value( Settings::DB_IMPORT_QUERY		).toString();
 	_info._interval		=						Settings::value( Settings::DB_IMPORT_INTERVAL	).toInt();
+	_info._keyColumn	=						Settings::value( Settings::DB_IMPORT_KEYCOLUMN	).toString();
 	_info._rememberMe	=						Settings::value( Settings::DB_REMEMBER_ME		).toBool();
 	
 	emit allChanged();
@@ -316,6 +318,18 @@ void DatabaseFileMenu::setQuery(const QString &newQuery)
 	emit queryChanged();
 }
 
+void DatabaseFileMenu::setKeyColumn(const QString &newKeyColumn)
+{
+	if (_info._keyColumn == newKeyColumn)
+		return;
+	
+	_info._keyColumn = newKeyColumn;
+	if(useDataSetPackage())	DataSetPackage::pkg()->setDatabaseJson(_info.toJson());
+	else					Settings::setValue(Settings::DB_IMPORT_KEYCOLUMN, _info._keyColumn);
+	
+	emit keyColumnChanged();
+}
+
 void DatabaseFileMenu::setResultsOK(bool newResultsOK)
 {
 	if (_resultsOK == newResultsOK)
@@ -19,6 +19,7 @@
 
 #include <sstream>
 #include <cstdio>
+#include <algorithm>
 
 //#include "../Common/analysisloader.h"
 #include <boost/bind.hpp>
@@ -32,6 +33,13 @@
 #include "log.h"
 #include "databaseinterface.h"
 
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#endif
+
 
 void SendFunctionForJaspresults(const char * msg) { Engine::theEngine()->sendString(msg); }
 bool PollMessagesFunctionForJaspResults()
@@ -137,6 +145,103 @@ void Engine::initialize()
 	}
 }
 
+#ifdef __linux__
+static int zygoteReplyFd = -1; ///< The write end of the pipe Desktop reads the replies of the zygote from, nobody else writes to it
+
+static void zygoteReply(const std::string & reply)
+{
+	//A single write of less than PIPE_BUF bytes keeps the line in one piece
+	const std::string line = reply + "\n";
+
+	if(::write(zygoteReplyFd, line.c_str(), line.size()) < 0)
+		Log::log() << "Zygote could not send reply '" << reply << "' to Desktop." << std::endl;
+}
+
+int Engine::runZygote(unsigned long parentPID)
+{
+	Log::log() << "jaspEngine started as zygote for parent JASP at PID " << parentPID << std::endl;
+
+	const char * replyFd = std::getenv("JASP_ZYGOTE_REPLY_FD");
+
+	if(!replyFd)
+	{
+		Log::log() << "Zygote did not get a pipe to reply on from Desktop, stopping." << std::endl;
+		exit(1);
+	}
+
+	zygoteReplyFd = std::atoi(replyFd);
+	fcntl(zygoteReplyFd, F_SETFD, FD_CLOEXEC);
+
+	TempFiles::attach(parentPID);
+
+	JASPTIMER_START(Zygote initializing R);
+	rbridge_init(SendFunctionForJaspresults, PollMessagesFunctionForJaspResults, nullptr, "");
+
+	//Every module needs these, by loading them here the forked engines share the pages with the zygote instead of each loading them separately.
+	//Modules themselves are not preloaded because they each have their own library and might need different versions of their dependencies.
+	jaspRCPP_runScript("for(ns in c('jaspBase', 'jaspGraphs')) try(loadNamespace(ns), silent=TRUE);");
+	JASPTIMER_STOP(Zygote initializing R);
+
+	zygoteReply("ready");
+
+	std::string requests;
+
+	while(ProcessInfo::isParentRunning())
+	{
+		int status;
+		for(pid_t pid; (pid = waitpid(-1, &status, WNOHANG)) > 0;)
+			zygoteReply("exited " + std::to_string(pid) + " " + std::to_string(WIFEXITED(status) ? WEXITSTATUS(status) : -1) + (WIFEXITED(status) ? " normal" : " crash"));
+
+		pollfd stdinPoll = { STDIN_FILENO, POLLIN, 0 };
+
+		if(poll(&stdinPoll, 1, 100) <= 0)
+			continue;
+
+		char	chunk[256];
+		ssize_t	got = ::read(STDIN_FILENO, chunk, sizeof(chunk));
+
+		if(got <= 0) //Desktop closed stdin, so it doesn't need us anymore
+			break;
+
+		requests.append(chunk, got);
+
+		for(size_t newline; (newline = requests.find('\n')) != std::string::npos;)
+		{
+			const std::string request = requests.substr(0, newline);
+			requests.erase(0, newline + 1);
+
+			if(request.rfind("fork ", 0) != 0)
+			{
+				Log::log() << "Zygote received unknown request '" << request << "'" << std::endl;
+				continue;
+			}
+
+			const int	channel = std::atoi(request.c_str() + 5);
+			const pid_t	pid		= fork();
+
+			if(pid == 0)
+			{
+				//The child continues as a normal engine, only the zygote should read the requests from Desktop and reply to them.
+				//Its stdout stays that of the zygote, which Desktop forwards to its own stdout.
+				int devNull = open("/dev/null", O_RDONLY);
+				dup2(devNull, STDIN_FILENO);
+				close(devNull);
+
+				close(zygoteReplyFd);
+				zygoteReplyFd = -1;
+
+				return channel;
+			}
+
+			zygoteReply((pid > 0 ? "forked " : "failed ") + std::to_string(channel) + " " + std::to_string(pid));
+		}
+	}
+
+	Log::log() << "jaspEngine zygote of " << parentPID << " stops." << std::endl;
+	exit(0);
+}
+#endif
+
 Engine::~Engine()
 {
 	delete _channel; //shared memory files will be removed in jaspDesktop
@@ -154,7 +259,9 @@ void Engine::run()
 			initDone = true;
 		}
 
-		receiveMessages(100);
+		//This blocks on the semaphore of the channel, so a request is picked up the moment it is sent. While idle or paused there is no reason to wake up often,
+		//once a second is enough to notice Desktop is gone and for beIdle to clean up after a while.
+		receiveMessages(_engineState == engineState::idle || _engineState == engineState::paused ? 1000 : 100);
 
 		switch(_engineState)
 		{
@@ -605,10 +712,49 @@ void Engine::sendString(std::string message)
 	if(Json::Reader().parse(message, msgJson)) //If everything is converted to jaspResults maybe we can do this there?
 	{
 		ColumnEncoder::columnEncoder()->decodeJson(msgJson); // decode all columnnames as far as you can
-		_channel->send(msgJson.toStyledString());
+		message = msgJson.toStyledString();
 	}
-	else
-		_channel->send(message);
+
+	//send only fails for a reply that is streamed in chunks, when Desktop did not take one of them in time
+	if(_channel->send(message))
+		return;
+
+	Log::log() << "Engine::sendString could not stream a reply of " << message.size() << " bytes to Desktop, trying once more." << std::endl;
+
+	if(_channel->send(message))
+		return;
+
+	Log::log() << "Engine::sendString failed to stream the reply again and gives up on it." << std::endl;
+
+	sendReplyLost(msgJson);
+}
+
+void Engine::sendReplyLost(const Json::Value & lostReply)
+{
+	//Desktop would otherwise keep waiting for the results of the analysis, this reply is small enough to never be streamed.
+	//Losing intermediate results is no reason for that, the final ones follow anyway.
+	if(	!lostReply.isObject()																					||
+		lostReply.get("typeRequest", "").asString()	!= engineStateToString(engineState::analysis)				||
+		lostReply.get("status", "").asString()		== analysisResultStatusToString(analysisResultStatus::running)	)
+		return;
+
+	Json::Value response			= Json::Value(Json::objectValue),
+				results				= Json::Value(Json::objectValue);
+
+	results["error"]				= true;
+	results["errorMessage"]			= "The results of this analysis were too big to be sent from the engine in time.";
+	results["title"]				= _analysisTitle;
+
+	response["typeRequest"]			= lostReply["typeRequest"];
+	response["id"]					= lostReply["id"];
+	response["name"]				= lostReply["name"];
+	response["revision"]			= lostReply["revision"];
+	response["progress"]			= Json::nullValue;
+	response["results"]				= results;
+	response["status"]				= analysisResultStatusToString(analysisResultStatus::fatalError);
+
+	if(!_channel->send(response.toStyledString()))
+		Log::log() << "Engine::sendReplyLost could not even tell Desktop about it." << std::endl;
 }
 
 
@@ -990,6 +1136,9 @@ void Engine::pauseEngine(const Json::Value & json)
 	{
 		delete _dataSet;
 		_dataSet = nullptr;
+
+		//The next dataset might reuse the same ids and revisions
+		jaspRCPP_purgeDataSetCache();
 	}
 
 	sendEnginePaused();
@@ -1093,6 +1242,7 @@ void Engine::absorbSettings(const Json::Value & jsonRequest)
 	_exactPValues		= jsonRequest.get("exactPValues",		_exactPValues		).asBool();
 	_normalizedNotation	= jsonRequest.get("normalizedNotation",	_normalizedNotation	).asBool();
 	_resultFont			= jsonRequest.get("resultFont",			_resultFont		).asString();
+	_dataSetCacheMB		= jsonRequest.get("dataSetCacheMB",		_dataSetCacheMB		).asInt();
 
 	const char	* PAT	= std::getenv("GITHUB_PAT");
 	
@@ -1104,6 +1254,7 @@ void Engine::absorbSettings(const Json::Value & jsonRequest)
 	rbridge_setLANG(_langR);
 	jaspRCPP_setDecimalSettings(_numDecimals, _fixedDecimals, _normalizedNotation, _exactPValues);
 	jaspRCPP_setFontAndPlotSettings(_resultFont.c_str(), _ppi, _imageBackground.c_str());
+	jaspRCPP_setDataSetCacheBudget(std::max(0, _dataSetCacheMB)); //A negative budget would wrap around to an unlimited cache
 }
 
 
@@ -33,6 +33,11 @@ class Engine
 public:
 	explicit Engine(int slaveNo, unsigned long parentPID);
 	static Engine * theEngine() { return _EngineInstance; } //There is only ever one engine in a process so we might as well have a static pointer to it.
+
+#ifdef __linux__
+	/// Initializes R and then waits for "fork <channel>" requests from Desktop on stdin, replying over the pipe in JASP_ZYGOTE_REPLY_FD. Only returns in the forked engines, with their channel.
+	static int runZygote(unsigned long parentPID);
+#endif
 	~Engine();
 
 	void run();
@@ -100,6 +105,7 @@ private: // Methods:
 	void removeNonKeepFiles(const Json::Value & filesToKeepValue);
 
 	void sendAnalysisResults();
+	void sendReplyLost(const Json::Value & lostReply);	///< Turns an analysis reply that could not be streamed into a small fatalError so Desktop stops waiting for it
 	void sendFilterResult(		int filterRequestId);
 	void sendFilterError(		int filterRequestId,				const std::string & errorMessage);
 	void sendRCodeResult(		const std::string & rCodeResult,	int rCodeRequestId);
@@ -128,7 +134,8 @@ private: // Data:
 							_analysisRevision,
 							_progress,
 							_ppi				= 96,
-							_numDecimals		= 3;
+							_numDecimals		= 3,
+							_dataSetCacheMB		= 256;
 
 	bool					_developerMode		= false,
 							_fixedDecimals		= false,
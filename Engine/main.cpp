@@ -83,6 +83,17 @@ int main(int argc, char *argv[])
 
 		Log::logFileNameBase = logFileBase;
 		Log::init(&nullstream);
+
+#ifdef __linux__
+		if(std::string(argv[1]) == "--zygote")
+		{
+			Log::setLogFileName(logFileBase + " Engine Zygote.log");
+			Log::setWhere(logTypeFromString(logFileWhere));
+
+			slaveNo = Engine::runZygote(parentPID); //Only returns in the engines forked from it, with the channel they should attach to
+		}
+#endif
+
 		Log::setLogFileName(logFileBase + " Engine " + std::to_string(slaveNo) + ".log");
 		Log::setWhere(logTypeFromString(logFileWhere));
 		Log::setEngineNo(slaveNo);
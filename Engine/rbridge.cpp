@@ -24,6 +24,8 @@
 #include "timers.h"
 #include "r_functionwhitelist.h"
 #include "otoolstuff.h"
+#include "processinfo.h"
+#include <ctime>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -34,6 +36,7 @@ RCallback						rbridge_callback	= NULL;
 std::set<std::string>			filterColumnsUsed;
 std::vector<std::string>		columnNamesInDataSet;
 ColumnEncoder				*	extraEncodings		= nullptr;
+bool							rbridge_rInitialized	= false;	///< Set by rbridge_init, an engine forked from the zygote has R running already
 
 
 //You cannot replace these NULL's by nullptr because then the compiler will complain about expressions that cannot be used as functions
@@ -79,6 +82,16 @@ void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMes
 	Log::log() << "Setting extraEncodings." << std::endl;
 	extraEncodings = extraEncoder;
 
+	if(rbridge_rInitialized)
+	{
+		Log::log() << "R was already initialized by the zygote this engine was forked from, giving it its own tempdir and random seed." << std::endl;
+
+		static std::string forkedTempDirStatic = TempFiles::createTmpFolder();
+		jaspRCPP_forkedFromZygote(forkedTempDirStatic.c_str(), static_cast<unsigned int>(ProcessInfo::currentPID() ^ std::time(nullptr)));
+
+		return;
+	}
+
 	Log::log() << "Collecting RBridgeCallBacks." << std::endl;
 	RBridgeCallBacks callbacks = {
 		rbridge_readDataSet,
@@ -105,7 +118,8 @@ void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMes
 		rbridge_decodeColumnName,
 		rbridge_encodeAllColumnNames,
 		rbridge_decodeAllColumnNames,
-		rbridge_allColumnNames
+		rbridge_allColumnNames,
+		rbridge_readDataSetCacheKeys
 	};
 
 	JASPTIMER_START(jaspRCPP_init);
@@ -127,6 +141,7 @@ void rbridge_init(sendFuncDef sendToDesktopFunction, pollMessagesFuncDef pollMes
 	);
 	JASPTIMER_STOP(jaspRCPP_init);
 
+	rbridge_rInitialized = true;
 }
 
 void rbridge_junctionHelper(bool collectNotRestore, const std::string & folder)
@@ -354,6 +369,56 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSetForFiltering(size_t * colMa
 static RBridgeColumn*	datasetStatic = nullptr;
 static int				datasetColMax = 0;
 
+///Translates label values into their 1-based index in R, through a dense table whenever the values are close enough together (which they practically always are) instead of looking each one up in a map
+class RBridgeLabelIndices
+{
+public:
+	RBridgeLabelIndices(const Labels & labels)
+	{
+		int i = 1; // R starts indices from 1
+
+		for(const Label * label : labels)
+			_indices[label->value()] = i++;
+
+		if(_indices.size() && int64_t(_indices.rbegin()->first) - int64_t(_indices.begin()->first) < int64_t(4 * _indices.size() + 1024))
+		{
+			_min = _indices.begin()->first;
+			_dense.assign(size_t(_indices.rbegin()->first - _min) + 1, 0);
+
+			for(const auto & valueIndex : _indices)
+				_dense[valueIndex.first - _min] = valueIndex.second;
+		}
+	}
+
+	int operator()(int value) const
+	{
+		if(value == std::numeric_limits<int>::lowest())
+			return value;
+
+		if(_dense.size())
+		{
+			const int64_t offset = int64_t(value) - _min;
+			return offset < 0 || offset >= int64_t(_dense.size()) ? 0 : _dense[offset];
+		}
+
+		auto it = _indices.find(value);
+		return it == _indices.end() ? 0 : it->second;
+	}
+
+private:
+	intintmap	_indices;
+	intvec		_dense;
+	int			_min = 0;
+};
+
+///Fills out with the rows of values selected by rowNumbers (1-based), each of them passed through convert. Written as two plain loops so the compiler can vectorize them.
+template<typename In, typename Out, typename Convert>
+static void rbridge_gatherRows(const In * values, Out * out, const int * rowNumbers, size_t rows, bool allRows, Convert convert)
+{
+	if(allRows)	for(size_t row=0; row<rows; row++)	out[row] = convert(values[row]);
+	else		for(size_t row=0; row<rows; row++)	out[row] = convert(values[rowNumbers[row] - 1]);
+}
+
 extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHeaders, size_t colMax, bool obeyFilter)
 {
 	if (colHeaders == nullptr)
@@ -364,29 +429,32 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 	if(rbridge_dataSet == nullptr)
 		return nullptr;
 
-	const Columns & columns = rbridge_dataSet->columns();
-
 	if (datasetStatic != nullptr)
 		freeRBridgeColumns();
 
 	datasetColMax = colMax;
 	datasetStatic = static_cast<RBridgeColumn*>(calloc(datasetColMax + 1, sizeof(RBridgeColumn)));
 
-	size_t filteredRowCount = obeyFilter ? rbridge_dataSet->filter()->filteredRowCount() : rbridge_dataSet->rowCount();
+	const size_t		dataSetRowCount		= rbridge_dataSet->rowCount();
+	size_t				filteredRowCount	= obeyFilter ? rbridge_dataSet->filter()->filteredRowCount() : dataSetRowCount;
+	const boolvec	&	filtered			= rbridge_dataSet->filter()->filtered();
 
 	// lets make some rownumbers/names for R that takes into account being filtered or not!
+	// They double as the selection of rows every column is gathered through, so the filter is only walked once instead of once per column.
 	datasetStatic[colMax].ints		= filteredRowCount == 0 ? nullptr : static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
 	datasetStatic[colMax].nbRows	= filteredRowCount;
-	int filteredRow					= 0;
+	size_t filteredRow				= 0;
 
 	//If you change anything here, make sure that "label outliers" in Descriptives still works properly (including with filters)
-	for(size_t i=0; i<rbridge_dataSet->rowCount() && filteredRow < datasetStatic[colMax].nbRows; i++)
-		if(
-				!obeyFilter ||
-				(rbridge_dataSet->filter()->filtered().size() > i && rbridge_dataSet->filter()->filtered()[i])
-			)
+	for(size_t i=0; i<dataSetRowCount && filteredRow < filteredRowCount; i++)
+		if(!obeyFilter || (filtered.size() > i && filtered[i]))
 			datasetStatic[colMax].ints[filteredRow++] = int(i + 1); //R needs 1-based index
 
+	datasetStatic[colMax].nbRows	= filteredRowCount = filteredRow; //Should be the same, but this way we never read garbage
+
+	const int	*	rowNumbers	= datasetStatic[colMax].ints;
+	const bool		allRows		= filteredRowCount == dataSetRowCount;
+
 	//std::cout << "reading " << colMax << " columns!\nRowCount: " << filteredRowCount << "" << std::endl;
 
 	for (int colNo = 0; colNo < colMax; colNo++)
@@ -403,59 +471,84 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 			requestedType = colType;
 
 		resultCol.nbRows = filteredRowCount;
-		int rowNo = 0, dataSetRowNo = 0;
+
+		//Gathering goes straight through the rownumbers, a column that is (somehow) shorter than the dataset is padded with missing values first
+		const bool	canBorrow	= column->rowCount() == dataSetRowCount;
+		intvec		paddedInts;
+		doublevec	paddedDbls;
+
+		auto ints = [&]() -> const int *
+		{
+			if(canBorrow)
+				return column->ints().data();
+
+			paddedInts.assign(column->ints().begin(), column->ints().end());
+			paddedInts.resize(dataSetRowCount, std::numeric_limits<int>::lowest());
+			return paddedInts.data();
+		};
+
+		auto dbls = [&]() -> const double *
+		{
+			if(canBorrow)
+				return column->dbls().data();
+
+			paddedDbls.assign(column->dbls().begin(), column->dbls().end());
+			paddedDbls.resize(dataSetRowCount, NAN);
+			return paddedDbls.data();
+		};
+
+		auto allocInts = [&]() { return filteredRowCount == 0 ? nullptr : static_cast<int*>(calloc(filteredRowCount, sizeof(int))); };
 
 		//Here a reusable block of code to set the resultCol properly for .ints being indices in R to column->labels()
 		auto setResultColIntsLabels = [&]()
 		{
 			//first map the values to indices in order to avoid any malformed factor problems
-			intintmap indices;
-			if(requestedType != columnType::scale || colType == columnType::nominalText)
-			{
-				int i = 1; // R starts indices from 1
-
-				for(const Label * label : column->labels())
-					indices[label->value()] = i++;
-			}
+			const RBridgeLabelIndices indices(column->labels());
 
 			resultCol.isScale	= false;
 			resultCol.hasLabels	= true;
-			resultCol.ints		= filteredRowCount == 0 ? nullptr : static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
+			resultCol.ints		= allocInts();
 			resultCol.isOrdinal = (requestedType == columnType::ordinal);
 
-			for(int value : column->ints())
-				if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filter()->filtered()[dataSetRowNo++]))
-				{
-					if (value == std::numeric_limits<int>::lowest())	resultCol.ints[rowNo++] = std::numeric_limits<int>::lowest();
-					else												resultCol.ints[rowNo++] = indices[value];
-				}
+			rbridge_gatherRows(ints(), resultCol.ints, rowNumbers, filteredRowCount, allRows, indices);
 
 			resultCol.labels = rbridge_getLabels(column->labels(), resultCol.nbLabels);
 		};
 
-
-
 		if (requestedType == columnType::scale)
 		{
 			if (colType == columnType::scale)
 			{
 				resultCol.isScale	= true;
 				resultCol.hasLabels	= false;
-				resultCol.doubles	= (double*)calloc(filteredRowCount, sizeof(double));
 
-				for(double value : column->dbls())
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filter()->filtered()[dataSetRowNo++]))
-						resultCol.doubles[rowNo++] = value;
+				//When the values can go to R as they are we just lend them and jaspRCPP copies the filtered rows straight into the R vector, saving a copy and a buffer of the full column
+				if(canBorrow)
+				{
+					resultCol.isBorrowed	= true;
+					resultCol.doubles		= const_cast<double*>(column->dbls().data());
+				}
+				else
+				{
+					resultCol.doubles		= (double*)calloc(filteredRowCount, sizeof(double));
+					rbridge_gatherRows(dbls(), resultCol.doubles, rowNumbers, filteredRowCount, allRows, [](double value) { return value; });
+				}
 			}
 			else if (colType == columnType::ordinal || colType == columnType::nominal)
 			{
 				resultCol.isScale	= false;
 				resultCol.hasLabels	= false;
-				resultCol.ints		= filteredRowCount == 0 ? nullptr : static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
 
-				for(int value : column->ints())
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filter()->filtered()[dataSetRowNo++]))
-						resultCol.ints[rowNo++] = value;
+				if(canBorrow)
+				{
+					resultCol.isBorrowed	= true;
+					resultCol.ints			= const_cast<int*>(column->ints().data());
+				}
+				else
+				{
+					resultCol.ints			= allocInts();
+					rbridge_gatherRows(ints(), resultCol.ints, rowNumbers, filteredRowCount, allRows, [](int value) { return value; });
+				}
 			}
 			else // columnType == ColumnType::nominalText
 			{
@@ -474,7 +567,7 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 				resultCol.isScale	= false;
 				resultCol.hasLabels = true;
 				resultCol.isOrdinal = false;
-				resultCol.ints		= filteredRowCount == 0 ? nullptr : static_cast<int*>(calloc(filteredRowCount, sizeof(int)));
+				resultCol.ints		= allocInts();
 
 				//collect values and bin all doubles per three decimals to determine the labels "required"
 				intset uniqueValues;
@@ -506,17 +599,14 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 
 				}
 
-				for(double value : column->dbls())
-					if(rowNo < filteredRowCount && (!obeyFilter || rbridge_dataSet->filter()->filtered()[dataSetRowNo++]))
-					{
-						//for the ints that need to be label indices we add 1+ to make sure R understands whats going on here
-						if (std::isnan(value))			resultCol.ints[rowNo] = std::numeric_limits<int>::lowest();
-						else if (std::isfinite(value))	resultCol.ints[rowNo] = 1 + valueToIndex[(int)(value * 1000)] ;
-						else if (value > 0)				resultCol.ints[rowNo] = 1 + valueToIndex[std::numeric_limits<int>::max()];
-						else							resultCol.ints[rowNo] = 1 + valueToIndex[std::numeric_limits<int>::lowest()];
-
-						rowNo++;
-					}
+				//for the ints that need to be label indices we add 1+ to make sure R understands whats going on here
+				rbridge_gatherRows(dbls(), resultCol.ints, rowNumbers, filteredRowCount, allRows, [&](double value)
+				{
+					if (std::isnan(value))			return std::numeric_limits<int>::lowest();
+					else if (std::isfinite(value))	return 1 + valueToIndex[(int)(value * 1000)];
+					else if (value > 0)				return 1 + valueToIndex[std::numeric_limits<int>::max()];
+					else							return 1 + valueToIndex[std::numeric_limits<int>::lowest()];
+				});
 
 				resultCol.labels = rbridge_getLabels(labels, resultCol.nbLabels);
 			}
@@ -526,6 +616,43 @@ extern "C" RBridgeColumn* STDCALL rbridge_readDataSet(RBridgeColumnType* colHead
 	return datasetStatic;
 }
 
+///Gives jaspRCPP a key for each requested column and one for the rownames, they only stay the same as long as what rbridge_readDataSet would return for them does
+extern "C" const char** STDCALL rbridge_readDataSetCacheKeys(RBridgeColumnType* colHeaders, size_t colMax, bool obeyFilter)
+{
+	static stringvec		keys;
+	static const char	**	keysC	= nullptr;
+
+	rbridge_dataSet = rbridge_dataSetSource();
+
+	if(!colHeaders || !rbridge_dataSet)
+		return nullptr;
+
+	const std::string	dataSetKey	= std::to_string(rbridge_dataSet->id()) + "_" + std::to_string(rbridge_dataSet->revision()),
+						filterKey	= obeyFilter ? std::to_string(rbridge_dataSet->filter()->revision()) : "all";
+
+	keys.clear();
+
+	for (size_t colNo = 0; colNo < colMax; colNo++)
+	{
+		Column * column = rbridge_dataSet->column(ColumnEncoder::columnEncoder()->decode(colHeaders[colNo].name));
+
+		if(!column)
+			return nullptr;
+
+		keys.push_back(dataSetKey + "_" + std::to_string(column->id()) + "_" + std::to_string(column->revision()) + "_" + filterKey + "_" + std::to_string(colHeaders[colNo].type));
+	}
+
+	keys.push_back(dataSetKey + "_rows_" + filterKey);
+
+	free(keysC);
+	keysC = static_cast<const char**>(calloc(keys.size(), sizeof(const char*)));
+
+	for(size_t i=0; i<keys.size(); i++)
+		keysC[i] = keys[i].c_str();
+
+	return keysC;
+}
+
 extern "C" char** STDCALL rbridge_readDataColumnNames(size_t * colMax)
 {
 					rbridge_dataSet = rbridge_dataSetSource();
@@ -734,8 +861,12 @@ void freeRBridgeColumns()
 	{
 		RBridgeColumn& column = datasetStatic[i];
 		free(column.name);
-		if (column.isScale)	free(column.doubles);
-		else				free(column.ints);
+
+		if (!column.isBorrowed) //Those belong to the Column
+		{
+			if (column.isScale)	free(column.doubles);
+			else				free(column.ints);
+		}
 
 		if (column.hasLabels)
 			freeLabels(column.labels, column.nbLabels);
@@ -51,6 +51,7 @@ extern "C" {
 	RBridgeColumn*				STDCALL rbridge_readFullFilteredDataSet(size_t * colMax);
 	RBridgeColumn*				STDCALL rbridge_readFullDataSetHelper(	size_t * colMax, bool obeyFilter);
 	RBridgeColumn*				STDCALL rbridge_readDataSetForFiltering(size_t * colMax);
+	const char**				STDCALL rbridge_readDataSetCacheKeys(	RBridgeColumnType* columns, size_t colMax, bool obeyFilter);
 	char**						STDCALL rbridge_readDataColumnNames(	size_t *colMax);
 	RBridgeColumnDescription*	STDCALL rbridge_readDataSetDescription(RBridgeColumnType* columns, size_t colMax);
 	bool						STDCALL rbridge_test(char** root);
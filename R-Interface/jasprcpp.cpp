@@ -17,6 +17,8 @@
 
 #include "jasprcpp.h"
 #include <fstream>
+#include <map>
+#include <limits>
 #include "tempfiles.h"
 
 static const	std::string NullString			= "null";
@@ -51,6 +53,7 @@ EnDecodeDef						encodeColumnName,
 								decodeAllColumnNames;
 
 getColNames						getAllColumnNames;
+ReadDataSetCacheKeysCB			readDataSetCacheKeysCB;
 
 static logFlushDef				_logFlushFunction		= nullptr;
 static logWriteDef				_logWriteFunction		= nullptr;
@@ -59,6 +62,20 @@ static systemDef				_systemFunc				= nullptr;
 static libraryFixerDef			_libraryFixerFunc		= nullptr;
 static std::string				_R_HOME = "";
 
+///A converted column (or the rownames) as last used by an analysis, see jaspRCPP_readDataSetCached
+struct DataSetCacheEntry
+{
+	Rcpp::RObject	value;
+	size_t			bytes,
+					lastUsed;
+};
+
+//Allocated and never deleted on purpose, the RObjects must not be released after R is gone at exit
+static std::map<std::string, DataSetCacheEntry>	*	_dataSetCache			= new std::map<std::string, DataSetCacheEntry>();
+static size_t										_dataSetCacheBytes		= 0,
+													_dataSetCacheBudget		= 256 * 1024 * 1024,
+													_dataSetCacheTick		= 0;
+
 bool shouldCrashSoon = false; //Simply here to allow a developer to force a crash
 
 //Ugly hack to work around windows messing up environment variables when local+codepage+utf8
@@ -106,6 +123,7 @@ void STDCALL jaspRCPP_init(const char* buildYear, const char* version, RBridgeCa
 	runCallbackCB								= callbacks->runCallbackCB;
 	readDataSetCB								= callbacks->readDataSetCB;
 	getAllColumnNames							= callbacks->columnNames;
+	readDataSetCacheKeysCB						= callbacks->readDataSetCacheKeysCB;
 	encodeAllColumnNames						= callbacks->encoderAll;
 	decodeAllColumnNames						= callbacks->decoderAll;
 	encodeColumnName							= callbacks->encoder;
@@ -237,6 +255,30 @@ void STDCALL jaspRCPP_purgeGlobalEnvironment()
 	jaspRCPP_parseEvalQNT("jaspBase:::.cleanEngineMemory()", false);
 }
 
+void STDCALL jaspRCPP_setDataSetCacheBudget(size_t megaBytes)
+{
+	const size_t bytesPerMB = 1024 * 1024;
+
+	_dataSetCacheBudget = megaBytes > std::numeric_limits<size_t>::max() / bytesPerMB ? std::numeric_limits<size_t>::max() : megaBytes * bytesPerMB;
+	jaspRCPP_evictDataSetCache();
+}
+
+void STDCALL jaspRCPP_purgeDataSetCache()
+{
+	_dataSetCache->clear();
+	_dataSetCacheBytes = 0;
+}
+
+void STDCALL jaspRCPP_forkedFromZygote(const char * tempDir, unsigned int seed)
+{
+	//R removes its tempdir when it stops, so each engine needs its own or it would remove the one its siblings still use
+	R_TempDir = (char*)tempDir;
+
+	//tempfile() uses rand() and R seeds .Random.seed from time and pid once it is gone, otherwise every sibling would draw the same numbers
+	srand(seed);
+	jaspRCPP_parseEvalQNT("if(exists('.Random.seed', envir=globalenv(), inherits=FALSE)) rm('.Random.seed', envir=globalenv());");
+}
+
 void _setJaspResultsInfo(int analysisID, int analysisRevision, bool developerMode)
 {
 	jaspRCPP_parseEvalQNT(
@@ -1003,11 +1045,122 @@ Rcpp::DataFrame jaspRCPP_readDataSetSEXP(SEXP columns, SEXP columnsAsNumeric, SE
 {
 	size_t				colMax				= 0;
 	RBridgeColumnType * columnsRequested	= jaspRCPP_marshallSEXPs(columns, columnsAsNumeric, columnsAsOrdinal, columnsAsNominal, allColumns, &colMax);
-	RBridgeColumn	  * colResults			= readDataSetCB(columnsRequested, colMax, true);
+	Rcpp::DataFrame		dataFrame			= jaspRCPP_readDataSetCached(columnsRequested, colMax, true);
 	
 	freeRBridgeColumnType(columnsRequested, colMax);
 
-	return jaspRCPP_convertRBridgeColumns_to_DataFrame(colResults, colMax);
+	return dataFrame;
+}
+
+void jaspRCPP_evictDataSetCache()
+{
+	while(_dataSetCacheBytes > _dataSetCacheBudget && _dataSetCache->size())
+	{
+		auto oldest = _dataSetCache->begin();
+
+		for(auto it = _dataSetCache->begin(); it != _dataSetCache->end(); it++)
+			if(it->second.lastUsed < oldest->second.lastUsed)
+				oldest = it;
+
+		_dataSetCacheBytes -= oldest->second.bytes;
+		_dataSetCache->erase(oldest);
+	}
+}
+
+Rcpp::DataFrame jaspRCPP_readDataSetCached(RBridgeColumnType * columnsRequested, size_t colMax, bool obeyFilter)
+{
+	//rbridge gives us a key per column (and one for the rownames) that changes whenever the column, its type, the filter or the dataset change
+	const char ** keysCB = colMax == 0 || _dataSetCacheBudget == 0 ? nullptr : readDataSetCacheKeysCB(columnsRequested, colMax, obeyFilter);
+
+	if(!keysCB)
+		return jaspRCPP_convertRBridgeColumns_to_DataFrame(readDataSetCB(columnsRequested, colMax, obeyFilter), colMax);
+
+	const std::vector<std::string>	keys(keysCB, keysCB + colMax + 1);
+	std::vector<RBridgeColumnType>	missing;
+	std::vector<size_t>				missingIndices;
+
+	for(size_t i=0; i<colMax; i++)
+		if(!_dataSetCache->count(keys[i]))
+		{
+			missing			.push_back(columnsRequested[i]);
+			missingIndices	.push_back(i);
+		}
+
+	//Only the columns that are not cached yet are read and converted, the rownames come along with them for free
+	if(missing.size() || !_dataSetCache->count(keys[colMax]))
+	{
+		RBridgeColumn * colResults = readDataSetCB(missing.size() ? missing.data() : columnsRequested, missing.size(), obeyFilter);
+
+		if(!colResults)
+			return Rcpp::DataFrame();
+
+		const RBridgeColumn & rowNumbers = colResults[missing.size()];
+
+		auto store = [&](const std::string & key, Rcpp::RObject value)
+		{
+			const size_t bytes = Rf_xlength(value) * (TYPEOF(value) == REALSXP ? sizeof(double) : sizeof(int));
+
+			if(_dataSetCache->count(key)) //Same column requested twice
+				_dataSetCacheBytes -= _dataSetCache->at(key).bytes;
+
+			(*_dataSetCache)[key]	 = DataSetCacheEntry{ value, bytes, 0 };
+			_dataSetCacheBytes		+= bytes;
+		};
+
+		for(size_t m=0; m<missing.size(); m++)
+			store(keys[missingIndices[m]], jaspRCPP_convertRBridgeColumn(colResults[m], rowNumbers));
+
+		if(!_dataSetCache->count(keys[colMax]))
+			store(keys[colMax], Rcpp::IntegerVector(rowNumbers.ints, rowNumbers.ints + rowNumbers.nbRows));
+	}
+
+	Rcpp::List			list(colMax);
+	Rcpp::StringVector	columnNames(colMax);
+
+	_dataSetCacheTick++;
+
+	for(size_t i=0; i<=colMax; i++)
+		_dataSetCache->at(keys[i]).lastUsed = _dataSetCacheTick;
+
+	for(size_t i=0; i<colMax; i++)
+	{
+		columnNames[i]	= columnsRequested[i].name;
+		list[i]			= _dataSetCache->at(keys[i]).value;
+	}
+
+	list.attr("names")			= columnNames;
+	Rcpp::DataFrame dataFrame	= Rcpp::DataFrame(list);
+	dataFrame.attr("row.names") = _dataSetCache->at(keys[colMax]).value;
+
+	//The dataframe keeps what it uses alive, so whatever gets evicted here does not matter for it
+	jaspRCPP_evictDataSetCache();
+
+	return dataFrame;
+}
+
+///Fills a freshly allocated R vector in a single pass from the values rbridge lent us, rowNumbers are the 1-based and increasing rows to take
+template<typename RVector, typename T>
+RVector jaspRCPP_borrowedColumnToVector(const T * values, const RBridgeColumn & rowNumbers)
+{
+	const size_t	rows	= rowNumbers.nbRows;
+	RVector			out		= Rcpp::no_init(rows);
+
+	//Because the rownumbers are increasing the last one being equal to the count means nothing was filtered out
+	if(rows == 0 || rowNumbers.ints[rows - 1] == int(rows))
+		std::copy(values, values + rows, out.begin());
+	else
+		for(size_t row=0; row<rows; row++)
+			out[row] = values[rowNumbers.ints[row] - 1];
+
+	return out;
+}
+
+Rcpp::RObject jaspRCPP_convertRBridgeColumn(const RBridgeColumn & colResult, const RBridgeColumn & rowNumbers)
+{
+	if (colResult.isBorrowed)		return colResult.isScale ? Rcpp::RObject(jaspRCPP_borrowedColumnToVector<Rcpp::NumericVector>(colResult.doubles, rowNumbers)) : Rcpp::RObject(jaspRCPP_borrowedColumnToVector<Rcpp::IntegerVector>(colResult.ints, rowNumbers));
+	else if (colResult.isScale)		return Rcpp::NumericVector(colResult.doubles, colResult.doubles + colResult.nbRows);
+	else if(!colResult.hasLabels)	return Rcpp::IntegerVector(colResult.ints, colResult.ints + colResult.nbRows);
+	else							return jaspRCPP_makeFactor(Rcpp::IntegerVector(colResult.ints, colResult.ints + colResult.nbRows), colResult.labels, colResult.nbLabels, colResult.isOrdinal);
 }
 
 Rcpp::DataFrame jaspRCPP_convertRBridgeColumns_to_DataFrame(const RBridgeColumn* colResults, size_t colMax)
@@ -1021,14 +1174,8 @@ Rcpp::DataFrame jaspRCPP_convertRBridgeColumns_to_DataFrame(const RBridgeColumn*
 
 		for (int i = 0; i < int(colMax); i++)
 		{
-			const RBridgeColumn &	colResult	= colResults[i];
-
-			columnNames[i] = colResult.name;
-
-			if (colResult.isScale)			list[i] = Rcpp::NumericVector(colResult.doubles, colResult.doubles + colResult.nbRows);
-			else if(!colResult.hasLabels)	list[i] = Rcpp::IntegerVector(colResult.ints, colResult.ints + colResult.nbRows);
-			else							list[i] = jaspRCPP_makeFactor(Rcpp::IntegerVector(colResult.ints, colResult.ints + colResult.nbRows), colResult.labels, colResult.nbLabels, colResult.isOrdinal);
-
+			columnNames[i]	= colResults[i].name;
+			list[i]			= jaspRCPP_convertRBridgeColumn(colResults[i], colResults[colMax]);
 		}
 
 		list.attr("names")			= columnNames;
@@ -33,6 +33,9 @@ Rcpp::DataFrame jaspRCPP_readFilterDataSet();
 Rcpp::DataFrame jaspRCPP_readDataSetSEXP(		SEXP columns, SEXP columnsAsNumeric, SEXP columnsAsOrdinal, SEXP columnsAsNominal, SEXP allColumns);
 Rcpp::DataFrame jaspRCPP_readDataSetHeaderSEXP(	SEXP columns, SEXP columnsAsNumeric, SEXP columnsAsOrdinal, SEXP columnsAsNominal, SEXP allColumns);
 Rcpp::DataFrame jaspRCPP_convertRBridgeColumns_to_DataFrame(const RBridgeColumn* colResults, size_t colMax);
+Rcpp::RObject	jaspRCPP_convertRBridgeColumn(const RBridgeColumn & colResult, const RBridgeColumn & rowNumbers);
+Rcpp::DataFrame jaspRCPP_readDataSetCached(RBridgeColumnType * columnsRequested, size_t colMax, bool obeyFilter); ///< Reuses the R vectors built for earlier analyses as long as rbridge reports the same keys for them, see jaspRCPP_setDataSetCacheBudget
+void			jaspRCPP_evictDataSetCache();
 
 SEXP jaspRCPP_callbackSEXP(SEXP results, SEXP progress);
 SEXP jaspRCPP_requestSpecificFileNameSEXP(SEXP extension);
@@ -47,6 +47,7 @@ struct RBridgeColumn {
   bool    isScale;
   bool    hasLabels;
   bool    isOrdinal;
+  bool    isBorrowed; ///< doubles or ints point straight at the (unfiltered) values of the column in the engine, only the rows in the rownumbers should be taken and they must not be freed or written to
   double* doubles;
   int*    ints;
   char**  labels;
@@ -90,6 +91,7 @@ typedef const char *				(STDCALL *EnDecodeDef)					(const char *);
 typedef const char *				(STDCALL *systemDef)					(const char *);
 typedef void						(STDCALL *libraryFixerDef)				(const char *);
 typedef const char **				(STDCALL *getColNames)					(size_t &  names, bool encoded);
+typedef const char **				(STDCALL *ReadDataSetCacheKeysCB)		(RBridgeColumnType* columns, size_t colMax, bool obeyFilter);
 
 struct RBridgeCallBacks {
 	ReadDataSetCB					readDataSetCB;
@@ -117,6 +119,7 @@ struct RBridgeCallBacks {
 									encoderAll,
 									decoderAll;
 	getColNames						columnNames;
+	ReadDataSetCacheKeysCB			readDataSetCacheKeysCB;
 };
 
 typedef void			(*sendFuncDef)			(const char *);
@@ -147,6 +150,9 @@ RBRIDGE_TO_JASP_INTERFACE const char*	STDCALL jaspRCPP_getLastErrorMsg();
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_resetErrorMsg();
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_setErrorMsg(const char* msg);
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_purgeGlobalEnvironment();
+RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_setDataSetCacheBudget(size_t megaBytes);
+RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_purgeDataSetCache();
+RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_forkedFromZygote(const char * tempDir, unsigned int seed); ///< Gives an engine forked from the zygote its own tempdir and random state, instead of sharing those with its siblings
 
 RBRIDGE_TO_JASP_INTERFACE void			STDCALL jaspRCPP_junctionHelper(bool collectNotRestore, const char * folder);
 